@@ -33,6 +33,7 @@ DirectGraphicsConfig::DirectGraphicsConfig() {
 	typeMultiSample = D3DMULTISAMPLE_NONE;
 	
 	bUseRef = false;
+	bUseNullDevice = false;
 	bUseTripleBuffer = true;
 	bVSync = false;
 	
@@ -40,6 +41,167 @@ DirectGraphicsConfig::DirectGraphicsConfig() {
 }
 
 #if defined(DNH_PROJ_EXECUTOR)
+//*******************************************************************
+//RenderRecorder
+//*******************************************************************
+RenderRecorder::RenderRecorder() {
+	pDevice_ = nullptr;
+
+	ZeroMemory(&countFrame_, sizeof(FrameCount));
+	ZeroMemory(&countLastFrame_, sizeof(FrameCount));
+	frame_ = 0;
+}
+RenderRecorder::~RenderRecorder() {
+	Release();
+}
+
+void RenderRecorder::Initialize(IDirect3DDevice9* device, const std::wstring& pathTrace) {
+	pDevice_ = device;
+
+	if (pathTrace.size() > 0) {
+		File::CreateFileDirectory(pathTrace);
+		fileTrace_.open(pathTrace, std::ios::trunc);
+		if (fileTrace_.is_open()) {
+			Logger::WriteTop(StringUtility::Format(L"DirectGraphics: Recording draw calls to %s", 
+				pathTrace.c_str()));
+		}
+		else {
+			Logger::WriteWarn(StringUtility::Format(L"DirectGraphics: Failed to open render trace file %s", 
+				pathTrace.c_str()));
+		}
+	}
+}
+void RenderRecorder::Release() {
+	if (fileTrace_.is_open())
+		fileTrace_.close();
+	pDevice_ = nullptr;
+}
+
+UINT RenderRecorder::GetVertexCount(D3DPRIMITIVETYPE type, UINT countPrim) {
+	switch (type) {
+	case D3DPT_POINTLIST:
+		return countPrim;
+	case D3DPT_LINELIST:
+		return countPrim * 2;
+	case D3DPT_LINESTRIP:
+		return countPrim + 1;
+	case D3DPT_TRIANGLELIST:
+		return countPrim * 3;
+	case D3DPT_TRIANGLESTRIP:
+	case D3DPT_TRIANGLEFAN:
+		return countPrim + 2;
+	}
+	return 0;
+}
+
+void RenderRecorder::RecordDraw(D3DPRIMITIVETYPE type, UINT countVertex, UINT countPrim, 
+	bool bIndexed, bool bUserPointer)
+{
+	++countFrame_.countDraw;
+	countFrame_.countPrimitive += countPrim;
+	countFrame_.countVertex += countVertex;
+
+	if (!fileTrace_.is_open() || pDevice_ == nullptr) return;
+
+	//Bound resources, as seen by the device at the time of the draw
+	IDirect3DBaseTexture9* pTexture = nullptr;
+	IDirect3DVertexBuffer9* pVertexBuffer = nullptr;
+	IDirect3DIndexBuffer9* pIndexBuffer = nullptr;
+	IDirect3DVertexShader9* pVertexShader = nullptr;
+	IDirect3DPixelShader9* pPixelShader = nullptr;
+	{
+		UINT offset = 0, stride = 0;
+		pDevice_->GetTexture(0, &pTexture);
+		if (!bUserPointer) {
+			pDevice_->GetStreamSource(0, &pVertexBuffer, &offset, &stride);
+			if (bIndexed)
+				pDevice_->GetIndices(&pIndexBuffer);
+		}
+		pDevice_->GetVertexShader(&pVertexShader);
+		pDevice_->GetPixelShader(&pPixelShader);
+	}
+
+	fileTrace_ << StringUtility::Format("%llu\tdraw%s%s\ttype=%d\tprim=%u\tvert=%u"
+		"\ttex=%p\tvb=%p\tib=%p\tvs=%p\tps=%p\n",
+		frame_, bIndexed ? "_indexed" : "", bUserPointer ? "_up" : "",
+		(int)type, countPrim, countVertex,
+		pTexture, pVertexBuffer, pIndexBuffer, pVertexShader, pPixelShader);
+
+	ptr_release(pTexture);
+	ptr_release(pVertexBuffer);
+	ptr_release(pIndexBuffer);
+	ptr_release(pVertexShader);
+	ptr_release(pPixelShader);
+}
+void RenderRecorder::NextFrame() {
+	if (fileTrace_.is_open()) {
+		fileTrace_ << StringUtility::Format("%llu\tframe\tdraw=%zu\tprim=%zu\tvert=%zu\tstate=%zu\tstate_skip=%zu\tparam_saved=%zu\n",
+			frame_, countFrame_.countDraw, countFrame_.countPrimitive, 
+			countFrame_.countVertex, countFrame_.countStateChange, countFrame_.countStateSkip,
+			countFrame_.countParamLookupSaved);
+	}
+
+	countLastFrame_ = countFrame_;
+	ZeroMemory(&countFrame_, sizeof(FrameCount));
+	++frame_;
+}
+
+//*******************************************************************
+//RenderStateCache
+//*******************************************************************
+RenderStateCache::RenderStateCache() {
+	pDevice_ = nullptr;
+	recorder_ = nullptr;
+	Invalidate();
+}
+
+void RenderStateCache::Initialize(IDirect3DDevice9* device, RenderRecorder* recorder) {
+	pDevice_ = device;
+	recorder_ = recorder;
+	Invalidate();
+}
+void RenderStateCache::Invalidate() {
+	stateRender_.bValid.reset();
+	for (auto& block : stateSampler_) block.bValid.reset();
+	for (auto& block : stateTextureStage_) block.bValid.reset();
+}
+
+template<size_t N> bool RenderStateCache::_Update(StateBlock<N>& block, size_t index, DWORD value) {
+	if (block.bValid[index] && block.value[index] == value) {
+		recorder_->RecordStateSkip();
+		return false;
+	}
+	block.value[index] = value;
+	block.bValid[index] = true;
+	return true;
+}
+HRESULT RenderStateCache::SetRenderState(D3DRENDERSTATETYPE type, DWORD value) {
+	if (type < MAX_RENDER_STATE && !_Update(stateRender_, type, value))
+		return S_FALSE;
+	recorder_->RecordStateChange();
+	return pDevice_->SetRenderState(type, value);
+}
+HRESULT RenderStateCache::SetSamplerState(DWORD stage, D3DSAMPLERSTATETYPE type, DWORD value) {
+	if (stage < MAX_STAGE && type < MAX_SAMPLER_STATE && !_Update(stateSampler_[stage], type, value))
+		return S_FALSE;
+	recorder_->RecordStateChange();
+	return pDevice_->SetSamplerState(stage, type, value);
+}
+HRESULT RenderStateCache::SetTextureStageState(DWORD stage, D3DTEXTURESTAGESTATETYPE type, DWORD value) {
+	if (stage < MAX_STAGE && type < MAX_TEXTURE_STAGE_STATE && !_Update(stateTextureStage_[stage], type, value))
+		return S_FALSE;
+	recorder_->RecordStateChange();
+	return pDevice_->SetTextureStageState(stage, type, value);
+}
+
+DWORD RenderStateCache::GetRenderState(D3DRENDERSTATETYPE type) {
+	if (type < MAX_RENDER_STATE && stateRender_.bValid[type])
+		return stateRender_.value[type];
+	DWORD res = 0;
+	pDevice_->GetRenderState(type, &res);
+	return res;
+}
+
 //*******************************************************************
 //DirectGraphics
 //*******************************************************************
@@ -94,8 +256,10 @@ bool DirectGraphics::Initialize(HWND hWnd, const DirectGraphicsConfig& config) {
 	pDirect3D->GetDeviceCaps(D3DADAPTER_DEFAULT, D3DDEVTYPE_HAL, &capsHal);
 
 	D3DDEVTYPE deviceType = config.bUseRef ? D3DDEVTYPE_REF : D3DDEVTYPE_HAL;
-	deviceCaps_ = deviceType == D3DDEVTYPE_REF ? capsRef : capsHal;
-	if (config.bCheckDeviceCaps && !config.bUseRef)
+	if (config.bUseNullDevice)
+		deviceType = D3DDEVTYPE_NULLREF;
+	deviceCaps_ = deviceType == D3DDEVTYPE_HAL ? capsHal : capsRef;
+	if (config.bCheckDeviceCaps && deviceType == D3DDEVTYPE_HAL)
 		_VerifyDeviceCaps();
 
 	bool bDeviceVSyncAvailable = (deviceCaps_.PresentationIntervals & D3DPRESENT_INTERVAL_ONE) != 0;
@@ -215,7 +379,13 @@ bool DirectGraphics::Initialize(HWND hWnd, const DirectGraphicsConfig& config) {
 				hrDevice = pDirect3D->CreateDevice(D3DADAPTER_DEFAULT, type, hWnd, 
 					addFlag | D3DCREATE_MULTITHREADED | D3DCREATE_FPU_PRESERVE, d3dpp, &pDevice_);
 			};
-			if (config.bUseRef) {
+			if (config.bUseNullDevice) {
+				//Accepts every call, renders nothing; for headless profiling
+				_TryCreateDevice(D3DDEVTYPE_NULLREF, D3DCREATE_SOFTWARE_VERTEXPROCESSING);
+				if (SUCCEEDED(hrDevice))
+					Logger::WriteTop("DirectGraphics: Created device (D3DDEVTYPE_NULLREF)");
+			}
+			else if (config.bUseRef) {
 				_TryCreateDevice(D3DDEVTYPE_REF, D3DCREATE_SOFTWARE_VERTEXPROCESSING);
 			}
 			else {
@@ -254,6 +424,9 @@ bool DirectGraphics::Initialize(HWND hWnd, const DirectGraphicsConfig& config) {
 	bufferManager_ = new VertexBufferManager();
 	bufferManager_->Initialize(this);
 
+	recorder_.Initialize(pDevice_, config.pathRenderTrace);
+	cacheState_.Initialize(pDevice_, &recorder_);
+
 	thisBase_ = this;
 
 	ResetCamera();
@@ -267,6 +440,7 @@ bool DirectGraphics::Initialize(HWND hWnd, const DirectGraphicsConfig& config) {
 	return true;
 }
 void DirectGraphics::Release() {
+	recorder_.Release();
 	DirectGraphicsBase::Release();
 }
 
@@ -485,11 +659,15 @@ void DirectGraphics::ResetCamera() {
 	}
 }
 void DirectGraphics::ResetDeviceState() {
-	pDevice_->SetRenderState(D3DRS_MULTISAMPLEANTIALIAS, false);
+	//The device may have been reset behind the cache's back, start from scratch
+	cacheState_.Invalidate();
+	previousBlendMode_ = BlendMode::RESET;
+
+	cacheState_.SetRenderState(D3DRS_MULTISAMPLEANTIALIAS, false);
 
 	SetCullingMode(D3DCULL_NONE);
-	pDevice_->SetRenderState(D3DRS_SHADEMODE, D3DSHADE_GOURAUD);
-	pDevice_->SetRenderState(D3DRS_AMBIENT, D3DCOLOR_XRGB(192, 192, 192));
+	SetShadingMode(D3DSHADE_GOURAUD);
+	cacheState_.SetRenderState(D3DRS_AMBIENT, D3DCOLOR_XRGB(192, 192, 192));
 	SetLightingEnable(true);
 	SetSpecularEnable(false);
 
@@ -546,6 +724,31 @@ void DirectGraphics::EndScene(bool bPresent) {
 		panelSystem_->EndD3DQuery();
 
 	DirectGraphicsBase::EndScene(bPresent);
+
+	if (bPresent)
+		recorder_.NextFrame();
+}
+
+HRESULT DirectGraphics::DrawPrimitive(D3DPRIMITIVETYPE type, UINT startVertex, UINT countPrim) {
+	recorder_.RecordDraw(type, RenderRecorder::GetVertexCount(type, countPrim), countPrim, false, false);
+	return pDevice_->DrawPrimitive(type, startVertex, countPrim);
+}
+HRESULT DirectGraphics::DrawPrimitiveUP(D3DPRIMITIVETYPE type, UINT countPrim, const void* pVertex, UINT stride) {
+	recorder_.RecordDraw(type, RenderRecorder::GetVertexCount(type, countPrim), countPrim, false, true);
+	return pDevice_->DrawPrimitiveUP(type, countPrim, pVertex, stride);
+}
+HRESULT DirectGraphics::DrawIndexedPrimitive(D3DPRIMITIVETYPE type, INT baseVertex, UINT minIndex,
+	UINT countVertex, UINT startIndex, UINT countPrim)
+{
+	recorder_.RecordDraw(type, countVertex, countPrim, true, false);
+	return pDevice_->DrawIndexedPrimitive(type, baseVertex, minIndex, countVertex, startIndex, countPrim);
+}
+HRESULT DirectGraphics::DrawIndexedPrimitiveUP(D3DPRIMITIVETYPE type, UINT minIndex, UINT countVertex, UINT countPrim,
+	const void* pIndex, D3DFORMAT formatIndex, const void* pVertex, UINT stride)
+{
+	recorder_.RecordDraw(type, countVertex, countPrim, true, true);
+	return pDevice_->DrawIndexedPrimitiveUP(type, minIndex, countVertex, countPrim, 
+		pIndex, formatIndex, pVertex, stride);
 }
 
 void DirectGraphics::ClearRenderTarget() {
@@ -560,6 +763,7 @@ void DirectGraphics::ClearRenderTarget(DxRect<LONG>* rect) {
 void DirectGraphics::SetRenderTarget(shared_ptr<Texture> texture) {
 	if (currentRenderTarget_ == texture) return;
 	currentRenderTarget_ = texture;
+	recorder_.RecordStateChange();
 	if (texture == nullptr) {
 		if (defaultBackBufferRenderTarget_) {
 			pDevice_->SetRenderTarget(0, defaultBackBufferRenderTarget_->GetD3DSurface());
@@ -577,57 +781,58 @@ void DirectGraphics::SetRenderTarget(shared_ptr<Texture> texture) {
 	pDevice_->SetViewport(&viewPort_);
 }
 void DirectGraphics::SetRenderTargetNull() {
+	recorder_.RecordStateChange();
 	pDevice_->SetRenderTarget(0, pBackSurf_);
 	pDevice_->SetDepthStencilSurface(pZBuffer_);
 }
 void DirectGraphics::SetLightingEnable(bool bEnable) {
-	pDevice_->SetRenderState(D3DRS_LIGHTING, bEnable);
+	cacheState_.SetRenderState(D3DRS_LIGHTING, bEnable);
 }
 void DirectGraphics::SetSpecularEnable(bool bEnable) {
-	pDevice_->SetRenderState(D3DRS_SPECULARENABLE, bEnable);
+	cacheState_.SetRenderState(D3DRS_SPECULARENABLE, bEnable);
 }
 void DirectGraphics::SetCullingMode(DWORD mode) {
-	pDevice_->SetRenderState(D3DRS_CULLMODE, mode);
+	cacheState_.SetRenderState(D3DRS_CULLMODE, mode);
 }
 void DirectGraphics::SetShadingMode(DWORD mode) {
-	pDevice_->SetRenderState(D3DRS_SHADEMODE, mode);
+	cacheState_.SetRenderState(D3DRS_SHADEMODE, mode);
 }
 void DirectGraphics::SetZBufferEnable(bool bEnable) {
-	pDevice_->SetRenderState(D3DRS_ZENABLE, bEnable);
+	cacheState_.SetRenderState(D3DRS_ZENABLE, bEnable);
 }
 void DirectGraphics::SetZWriteEnable(bool bEnable) {
-	pDevice_->SetRenderState(D3DRS_ZWRITEENABLE, bEnable);
+	cacheState_.SetRenderState(D3DRS_ZWRITEENABLE, bEnable);
 }
 void DirectGraphics::SetAlphaTest(bool bEnable, DWORD ref, D3DCMPFUNC func) {
-	pDevice_->SetRenderState(D3DRS_ALPHATESTENABLE, bEnable);
+	cacheState_.SetRenderState(D3DRS_ALPHATESTENABLE, bEnable);
 	if (bEnable) {
-		pDevice_->SetRenderState(D3DRS_ALPHAFUNC, func);
-		pDevice_->SetRenderState(D3DRS_ALPHAREF, ref);
+		cacheState_.SetRenderState(D3DRS_ALPHAFUNC, func);
+		cacheState_.SetRenderState(D3DRS_ALPHAREF, ref);
 	}
 }
 void DirectGraphics::SetBlendMode(BlendMode mode, int stage) {
 	if (mode == previousBlendMode_) return;
 	if (previousBlendMode_ == BlendMode::RESET) {
-		pDevice_->SetTextureStageState(stage, D3DTSS_COLOROP, D3DTOP_MODULATE);
-		pDevice_->SetTextureStageState(stage, D3DTSS_COLORARG2, D3DTA_DIFFUSE);
-		pDevice_->SetTextureStageState(stage, D3DTSS_ALPHAOP, D3DTOP_SELECTARG1);
-		pDevice_->SetTextureStageState(stage, D3DTSS_ALPHAARG1, D3DTA_TEXTURE);
-		pDevice_->SetTextureStageState(stage, D3DTSS_ALPHAARG2, D3DTA_CURRENT);
-		pDevice_->SetRenderState(D3DRS_SEPARATEALPHABLENDENABLE, TRUE);
+		cacheState_.SetTextureStageState(stage, D3DTSS_COLOROP, D3DTOP_MODULATE);
+		cacheState_.SetTextureStageState(stage, D3DTSS_COLORARG2, D3DTA_DIFFUSE);
+		cacheState_.SetTextureStageState(stage, D3DTSS_ALPHAOP, D3DTOP_SELECTARG1);
+		cacheState_.SetTextureStageState(stage, D3DTSS_ALPHAARG1, D3DTA_TEXTURE);
+		cacheState_.SetTextureStageState(stage, D3DTSS_ALPHAARG2, D3DTA_CURRENT);
+		cacheState_.SetRenderState(D3DRS_SEPARATEALPHABLENDENABLE, TRUE);
 	}
 	previousBlendMode_ = mode;
 
-	pDevice_->SetTextureStageState(stage, D3DTSS_ALPHAOP, D3DTOP_MODULATE);
-	pDevice_->SetTextureStageState(stage, D3DTSS_COLORARG1, D3DTA_TEXTURE);
+	cacheState_.SetTextureStageState(stage, D3DTSS_ALPHAOP, D3DTOP_MODULATE);
+	cacheState_.SetTextureStageState(stage, D3DTSS_COLORARG1, D3DTA_TEXTURE);
 
 #define SETBLENDOP(op, alp) \
-	pDevice_->SetRenderState(D3DRS_BLENDOP, op); \
-	pDevice_->SetRenderState(D3DRS_ALPHABLENDENABLE, alp);
+	cacheState_.SetRenderState(D3DRS_BLENDOP, op); \
+	cacheState_.SetRenderState(D3DRS_ALPHABLENDENABLE, alp);
 #define SETBLENDARGS(sbc, dbc, sba, dba) \
-	pDevice_->SetRenderState(D3DRS_SRCBLEND, sbc); \
-	pDevice_->SetRenderState(D3DRS_DESTBLEND, dbc); \
-	pDevice_->SetRenderState(D3DRS_SRCBLENDALPHA, sba); \
-	pDevice_->SetRenderState(D3DRS_DESTBLENDALPHA, dba);
+	cacheState_.SetRenderState(D3DRS_SRCBLEND, sbc); \
+	cacheState_.SetRenderState(D3DRS_DESTBLEND, dbc); \
+	cacheState_.SetRenderState(D3DRS_SRCBLENDALPHA, sba); \
+	cacheState_.SetRenderState(D3DRS_DESTBLENDALPHA, dba);
 
 	switch (mode) {
 	case MODE_BLEND_NONE:		//No blending
@@ -635,7 +840,7 @@ void DirectGraphics::SetBlendMode(BlendMode mode, int stage) {
 		SETBLENDARGS(D3DBLEND_ONE, D3DBLEND_ZERO, D3DBLEND_ONE, D3DBLEND_ZERO);
 		break;
 	case MODE_BLEND_ALPHA_INV:		//Alpha + Invert
-		pDevice_->SetTextureStageState(stage, D3DTSS_COLORARG1, D3DTA_TEXTURE | D3DTA_COMPLEMENT);
+		cacheState_.SetTextureStageState(stage, D3DTSS_COLORARG1, D3DTA_TEXTURE | D3DTA_COMPLEMENT);
 		__fallthrough;
 	case MODE_BLEND_ALPHA:			//Alpha
 		SETBLENDOP(D3DBLENDOP_ADD, TRUE);
@@ -678,23 +883,21 @@ void DirectGraphics::SetBlendMode(BlendMode mode, int stage) {
 	//pDevice_->SetRenderState(D3DRS_DESTBLEND, D3DBLEND_ONE); 
 }
 void DirectGraphics::SetFillMode(DWORD mode) {
-	pDevice_->SetRenderState(D3DRS_FILLMODE, mode);
+	cacheState_.SetRenderState(D3DRS_FILLMODE, mode);
 }
 void DirectGraphics::SetFogEnable(bool bEnable) {
-	pDevice_->SetRenderState(D3DRS_FOGENABLE, bEnable ? TRUE : FALSE);
+	cacheState_.SetRenderState(D3DRS_FOGENABLE, bEnable ? TRUE : FALSE);
 }
 bool DirectGraphics::IsFogEnable() {
-	DWORD fog = FALSE;
-	pDevice_->GetRenderState(D3DRS_FOGENABLE, &fog);
-	return (fog == TRUE);
+	return cacheState_.GetRenderState(D3DRS_FOGENABLE) == TRUE;
 }
 void DirectGraphics::SetVertexFog(bool bEnable, D3DCOLOR color, float start, float end) {
 	SetFogEnable(bEnable);
 
-	pDevice_->SetRenderState(D3DRS_FOGCOLOR, color);
-	pDevice_->SetRenderState(D3DRS_FOGVERTEXMODE, D3DFOG_LINEAR);
-	pDevice_->SetRenderState(D3DRS_FOGSTART, *(DWORD*)(&start));
-	pDevice_->SetRenderState(D3DRS_FOGEND, *(DWORD*)(&end));
+	cacheState_.SetRenderState(D3DRS_FOGCOLOR, color);
+	cacheState_.SetRenderState(D3DRS_FOGVERTEXMODE, D3DFOG_LINEAR);
+	cacheState_.SetRenderState(D3DRS_FOGSTART, *(DWORD*)(&start));
+	cacheState_.SetRenderState(D3DRS_FOGEND, *(DWORD*)(&end));
 
 	stateFog_.bEnable = bEnable;
 	stateFog_.color = ColorAccess::ToVec4Normalized(color, ColorAccess::PERMUTE_RGBA);
@@ -705,9 +908,9 @@ void DirectGraphics::SetPixelFog(bool bEnable, D3DCOLOR color, float start, floa
 void DirectGraphics::SetTextureFilter(D3DTEXTUREFILTERTYPE fMin, D3DTEXTUREFILTERTYPE fMag,
 	D3DTEXTUREFILTERTYPE fMip, int stage)
 {
-	if (fMin >= D3DTEXF_NONE) pDevice_->SetSamplerState(stage, D3DSAMP_MINFILTER, fMin);
-	if (fMag >= D3DTEXF_NONE) pDevice_->SetSamplerState(stage, D3DSAMP_MAGFILTER, fMag);
-	if (fMip >= D3DTEXF_NONE) pDevice_->SetSamplerState(stage, D3DSAMP_MIPFILTER, fMip);
+	if (fMin >= D3DTEXF_NONE) cacheState_.SetSamplerState(stage, D3DSAMP_MINFILTER, fMin);
+	if (fMag >= D3DTEXF_NONE) cacheState_.SetSamplerState(stage, D3DSAMP_MAGFILTER, fMag);
+	if (fMip >= D3DTEXF_NONE) cacheState_.SetSamplerState(stage, D3DSAMP_MIPFILTER, fMip);
 }
 DWORD DirectGraphics::GetTextureFilter(D3DTEXTUREFILTERTYPE* fMin, D3DTEXTUREFILTERTYPE* fMag,
 	D3DTEXTUREFILTERTYPE* fMip, int stage)
@@ -755,7 +958,7 @@ D3DMULTISAMPLE_TYPE DirectGraphics::GetMultiSampleType() {
 	return d3dppWin_.MultiSampleType;
 }
 HRESULT DirectGraphics::SetAntiAliasing(bool bEnable) {
-	return pDevice_->SetRenderState(D3DRS_MULTISAMPLEANTIALIAS, bEnable ? TRUE : FALSE);
+	return cacheState_.SetRenderState(D3DRS_MULTISAMPLEANTIALIAS, bEnable ? TRUE : FALSE);
 }
 bool DirectGraphics::IsSupportMultiSample(D3DMULTISAMPLE_TYPE type, bool bWindowed) {
 	if (type == D3DMULTISAMPLE_NONE)
@@ -788,6 +991,7 @@ void DirectGraphics::SetViewPort(int x, int y, int width, int height) {
 	viewPort_.MinZ = 0.0f;
 	viewPort_.MaxZ = 1.0f;
 	pDevice_->SetViewport(&viewPort_);
+	recorder_.RecordStateChange();
 
 	matViewPort_ = CreateOrthographicProjectionMatrix(x, y, width, height);
 }
@@ -36,10 +36,13 @@ namespace directx {
 		D3DMULTISAMPLE_TYPE typeMultiSample;
 
 		bool bUseRef;
+		bool bUseNullDevice;
 		bool bUseTripleBuffer;
 		bool bVSync;
 
 		bool bCheckDeviceCaps;
+
+		std::wstring pathRenderTrace;
 	public:
 		DirectGraphicsConfig();
 	};
@@ -50,6 +53,90 @@ namespace directx {
 		shared_ptr<Shader> shader;
 	};
 
+	//*******************************************************************
+	//RenderRecorder
+	//*******************************************************************
+	class RenderRecorder {
+	public:
+		struct FrameCount {
+			size_t countDraw;
+			size_t countPrimitive;
+			size_t countVertex;
+			size_t countStateChange;
+			size_t countStateSkip;
+			size_t countParamLookupSaved;
+			size_t countWorldMatrixBuild;
+			size_t countWorldMatrixCached;
+		};
+	private:
+		IDirect3DDevice9* pDevice_;
+
+		FrameCount countFrame_;
+		FrameCount countLastFrame_;
+		uint64_t frame_;
+
+		std::ofstream fileTrace_;
+	public:
+		RenderRecorder();
+		~RenderRecorder();
+
+		void Initialize(IDirect3DDevice9* device, const std::wstring& pathTrace);
+		void Release();
+
+		static UINT GetVertexCount(D3DPRIMITIVETYPE type, UINT countPrim);
+
+		void RecordDraw(D3DPRIMITIVETYPE type, UINT countVertex, UINT countPrim, bool bIndexed, bool bUserPointer);
+		void RecordStateChange() { ++countFrame_.countStateChange; }
+		void RecordStateSkip() { ++countFrame_.countStateSkip; }
+		void RecordParamLookupSaved() { ++countFrame_.countParamLookupSaved; }
+		void RecordWorldMatrix(bool bBuild) {
+			++(bBuild ? countFrame_.countWorldMatrixBuild : countFrame_.countWorldMatrixCached);
+		}
+		void NextFrame();
+
+		bool IsTraceEnable() { return fileTrace_.is_open(); }
+		const FrameCount& GetLastFrameCount() { return countLastFrame_; }
+	};
+
+	//*******************************************************************
+	//RenderStateCache
+	//*******************************************************************
+	class RenderStateCache {
+	public:
+		enum : size_t {
+			MAX_RENDER_STATE = D3DRS_BLENDOPALPHA + 1,
+			MAX_STAGE = 8,
+			MAX_SAMPLER_STATE = D3DSAMP_DMAPOFFSET + 1,
+			MAX_TEXTURE_STAGE_STATE = D3DTSS_CONSTANT + 1,
+		};
+	private:
+		template<size_t N> struct StateBlock {
+			std::array<DWORD, N> value;
+			std::bitset<N> bValid;
+		};
+
+		IDirect3DDevice9* pDevice_;
+		RenderRecorder* recorder_;
+
+		StateBlock<MAX_RENDER_STATE> stateRender_;
+		std::array<StateBlock<MAX_SAMPLER_STATE>, MAX_STAGE> stateSampler_;
+		std::array<StateBlock<MAX_TEXTURE_STAGE_STATE>, MAX_STAGE> stateTextureStage_;
+
+		template<size_t N> bool _Update(StateBlock<N>& block, size_t index, DWORD value);
+	public:
+		RenderStateCache();
+
+		void Initialize(IDirect3DDevice9* device, RenderRecorder* recorder);
+		void Invalidate();
+
+		//All return S_FALSE if the call was dropped as redundant, the device's result otherwise
+		HRESULT SetRenderState(D3DRENDERSTATETYPE type, DWORD value);
+		HRESULT SetSamplerState(DWORD stage, D3DSAMPLERSTATETYPE type, DWORD value);
+		HRESULT SetTextureStageState(DWORD stage, D3DTEXTURESTAGESTATETYPE type, DWORD value);
+
+		DWORD GetRenderState(D3DRENDERSTATETYPE type);
+	};
+
 	class SystemInfoPanel;
 	class DirectGraphics : public DirectGraphicsBase {
 		static DirectGraphics* thisBase_;
@@ -95,6 +182,9 @@ namespace directx {
 		VertexBufferManager* bufferManager_;
 		VertexFogState stateFog_;
 
+		RenderRecorder recorder_;
+		RenderStateCache cacheState_;
+
 		//-----------------------------------------------------------
 
 		virtual void _RestoreDxResource();
@@ -152,6 +242,20 @@ namespace directx {
 
 		//-----------------------------------------------------------
 
+		//Draw calls, counted (and traced if enabled) by the recorder
+		HRESULT DrawPrimitive(D3DPRIMITIVETYPE type, UINT startVertex, UINT countPrim);
+		HRESULT DrawPrimitiveUP(D3DPRIMITIVETYPE type, UINT countPrim, const void* pVertex, UINT stride);
+		HRESULT DrawIndexedPrimitive(D3DPRIMITIVETYPE type, INT baseVertex, UINT minIndex, 
+			UINT countVertex, UINT startIndex, UINT countPrim);
+		HRESULT DrawIndexedPrimitiveUP(D3DPRIMITIVETYPE type, UINT minIndex, UINT countVertex, UINT countPrim,
+			const void* pIndex, D3DFORMAT formatIndex, const void* pVertex, UINT stride);
+
+		RenderRecorder* GetRecorder() { return &recorder_; }
+		RenderStateCache* GetStateCache() { return &cacheState_; }
+		bool IsNullDevice() { return config_.bUseNullDevice; }
+
+		//-----------------------------------------------------------
+
 		//Render states
 		void SetLightingEnable(bool bEnable);
 		void SetSpecularEnable(bool bEnable);
@@ -275,4 +275,26 @@ void DxCamera2D::UpdateMatrix() {
 	matCamera_._22 *= ratioY_;
 	matCamera_._41 += pos.x;
 	matCamera_._42 += pos.y;
+}
+DxRect<float> DxCamera2D::GetVisibleRect() {
+	D3DXMATRIX matInv;
+	if (D3DXMatrixInverse(&matInv, nullptr, &matCamera_) == nullptr)
+		return DxRect<float>(-FLT_MAX, -FLT_MAX, FLT_MAX, FLT_MAX);
+
+	D3DXVECTOR2 listCorner[4] = {
+		D3DXVECTOR2(rcClip_.left, rcClip_.top),
+		D3DXVECTOR2(rcClip_.right, rcClip_.top),
+		D3DXVECTOR2(rcClip_.left, rcClip_.bottom),
+		D3DXVECTOR2(rcClip_.right, rcClip_.bottom),
+	};
+
+	DxRect<float> res(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX);
+	for (D3DXVECTOR2& corner : listCorner) {
+		D3DXVec2TransformCoord(&corner, &corner, &matInv);
+		res.left = std::min(res.left, corner.x);
+		res.top = std::min(res.top, corner.y);
+		res.right = std::max(res.right, corner.x);
+		res.bottom = std::max(res.bottom, corner.y);
+	}
+	return res;
 }
\ No newline at end of file
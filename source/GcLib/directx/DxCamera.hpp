@@ -167,5 +167,7 @@ namespace directx {
 
 		void UpdateMatrix();
 		const D3DXMATRIX& GetMatrix() { return bEnable_ ? matCamera_ : matIdentity_; }
+		//Bounding box of the clip rect in pre-camera coordinates, i.e. what's visible once the camera is enabled
+		DxRect<float> GetVisibleRect();
 	};
 }
\ No newline at end of file
@@ -10,6 +10,91 @@
 using namespace gstd;
 using namespace directx;
 
+//****************************************************************************
+//DxScriptValueKeyTable
+//****************************************************************************
+std::unordered_map<std::wstring, uint32_t> DxScriptValueKeyTable::mapKey_;
+std::vector<std::wstring> DxScriptValueKeyTable::listKeyName_;
+DxScriptValueKeyTable::CacheEntry DxScriptValueKeyTable::listCache_[DxScriptValueKeyTable::CACHE_SIZE];
+
+uint32_t DxScriptValueKeyTable::GetKey(const std::wstring& name, bool bCreate) {
+	auto itrFind = mapKey_.find(name);
+	if (itrFind != mapKey_.end())
+		return itrFind->second;
+	if (!bCreate)
+		return KEY_INVALID;
+
+	uint32_t key = listKeyName_.size();
+	mapKey_[name] = key;
+	listKeyName_.push_back(name);
+	return key;
+}
+uint32_t DxScriptValueKeyTable::GetKey(const gstd::value& name, bool bCreate) {
+	type_data* type = name.get_type();
+	bool bString = type && type->get_kind() == type_data::tk_array
+		&& type->get_element() && type->get_element()->get_kind() == type_data::tk_char;
+	if (!bString)
+		return GetKey(name.as_string(), bCreate);
+
+	ref_unsync_ptr<std::vector<gstd::value>> pArray = name.as_array_ptr();
+	size_t length = pArray->size();
+	CacheEntry& entry = listCache_[((size_t)pArray.get() >> 4) % CACHE_SIZE];
+
+	//The entry keeps its array alive, so the address can't be reused by another string.
+	//	Shared arrays are copied before element writes, the only in-place edit left is appending.
+	if (entry.pArray == pArray && entry.length == length)
+		return entry.key;
+
+	uint32_t key = GetKey(name.as_string(), bCreate);
+	if (key != KEY_INVALID) {
+		entry.pArray = pArray;
+		entry.length = length;
+		entry.key = key;
+	}
+	return key;
+}
+
+//****************************************************************************
+//DxScriptObjectValueMap
+//****************************************************************************
+std::vector<std::pair<uint32_t, gstd::value>>::iterator DxScriptObjectValueMap::_LowerBound(uint32_t key) {
+	return std::lower_bound(listValue_.begin(), listValue_.end(), key,
+		[](const std::pair<uint32_t, gstd::value>& a, uint32_t b) { return a.first < b; });
+}
+gstd::value* DxScriptObjectValueMap::Find(uint32_t key) {
+	auto itr = _LowerBound(key);
+	if (itr != listValue_.end() && itr->first == key)
+		return &itr->second;
+	return nullptr;
+}
+void DxScriptObjectValueMap::Set(uint32_t key, const gstd::value& val) {
+	auto itr = _LowerBound(key);
+	if (itr != listValue_.end() && itr->first == key)
+		itr->second = val;
+	else
+		listValue_.insert(itr, std::make_pair(key, val));
+}
+void DxScriptObjectValueMap::Erase(uint32_t key) {
+	auto itr = _LowerBound(key);
+	if (itr != listValue_.end() && itr->first == key)
+		listValue_.erase(itr);
+}
+void DxScriptObjectValueMap::CopyFrom(const DxScriptObjectValueMap& src, int mode) {
+	if (mode == 0) {
+		listValue_ = src.listValue_;
+		return;
+	}
+	for (auto& [key, val] : src.listValue_) {
+		auto itr = _LowerBound(key);
+		if (itr != listValue_.end() && itr->first == key) {
+			if (mode == 1)
+				itr->second = val;
+		}
+		else
+			listValue_.insert(itr, std::make_pair(key, val));
+	}
+}
+
 //****************************************************************************
 //DxScriptObjectBase
 //****************************************************************************
@@ -18,6 +103,7 @@ DxScriptObjectBase::DxScriptObjectBase() {
 
 	idObject_ = DxScript::ID_INVALID;
 	idScript_ = ScriptClientBase::ID_SCRIPT_FREE;
+	indexScriptObject_ = 0;
 	typeObject_ = TypeObject::Base;
 
 	bDelete_ = false;
@@ -32,8 +118,14 @@ DxScriptObjectBase::~DxScriptObjectBase() {
 	//	manager_->listUnusedIndex_.push_back(idObject_);
 }
 
+void DxScriptObjectBase::SetScriptID(int64_t idScript) {
+	if (manager_ && idObject_ != DxScript::ID_INVALID)
+		manager_->SetObjectScriptID(this, idScript);
+	else
+		idScript_ = idScript;
+}
 void DxScriptObjectBase::Clone(DxScriptObjectBase* src) {
-	idScript_ = src->idScript_;
+	SetScriptID(src->idScript_);
 
 	bActive_ = src->bActive_;
 	bVisible_ = src->bVisible_;
@@ -174,8 +266,7 @@ DxScriptPrimitiveObject2D::DxScriptPrimitiveObject2D() {
 void DxScriptPrimitiveObject2D::Render() {
 	if (RenderObjectTLX* obj = GetRenderObject()) {
 		DirectGraphics* graphics = DirectGraphics::GetBase();
-		DWORD bEnableFog = FALSE;
-		graphics->GetDevice()->GetRenderState(D3DRS_FOGENABLE, &bEnableFog);
+		bool bEnableFog = graphics->IsFogEnable();
 		if (bEnableFog)
 			graphics->SetFogEnable(false);
 
@@ -503,8 +594,7 @@ void DxScriptParticleListObject2D::Render() {
 
 	//Save fog state
 	DirectGraphics* graphics = DirectGraphics::GetBase();
-	DWORD bEnableFog = FALSE;
-	graphics->GetDevice()->GetRenderState(D3DRS_FOGENABLE, &bEnableFog);
+	bool bEnableFog = graphics->IsFogEnable();
 	if (bEnableFog)
 		graphics->SetFogEnable(false);
 
@@ -719,8 +809,7 @@ void DxScriptTextObject::Clone(DxScriptObjectBase* _src) {
 void DxScriptTextObject::Render() {
 	//Save fog state, text objects don't fucking get fogged
 	DirectGraphics* graphics = DirectGraphics::GetBase();
-	DWORD bEnableFog = FALSE;
-	graphics->GetDevice()->GetRenderState(D3DRS_FOGENABLE, &bEnableFog);
+	bool bEnableFog = graphics->IsFogEnable();
 	if (bEnableFog)
 		graphics->SetFogEnable(false);
 
@@ -1425,12 +1514,17 @@ DWORD DxBinaryFileObject::Write(LPVOID data, size_t size) {
 //****************************************************************************
 DxScriptObjectManager::FogData DxScriptObjectManager::fogData_ = { false, 0xffffffff, 0, 0 };
 DxScriptObjectManager::DxScriptObjectManager() {
+	posUnusedIndex_ = 0;
+	countUnusedIndex_ = 0;
+
 	SetMaxObject(DEFAULT_CONTAINER_CAPACITY);
 	SetRenderBucketCapacity(101);
 
 	totalObjectCreateCount_ = 0U;
 
 	listDeleteObject_.reserve(512U);
+
+	bParallelWork_ = false;
 }
 DxScriptObjectManager::~DxScriptObjectManager() {
 }
@@ -1447,33 +1541,80 @@ bool DxScriptObjectManager::SetMaxObject(size_t size) {
 	size = std::min(size, 131072U);
 
 	for (size_t iObj = obj_.size(); iObj < size; ++iObj)
-		listUnusedIndex_.push_back(iObj);
+		_PushUnusedIndex(iObj);
 	obj_.resize(size, nullptr);
 	return true;
 }
+void DxScriptObjectManager::_PushUnusedIndex(int index) {
+	if (countUnusedIndex_ == listUnusedIndex_.size()) {
+		//Unwrap before growing so the queue order is kept
+		std::rotate(listUnusedIndex_.begin(), listUnusedIndex_.begin() + posUnusedIndex_, listUnusedIndex_.end());
+		posUnusedIndex_ = 0;
+		listUnusedIndex_.resize(std::max<size_t>(listUnusedIndex_.size() * 2U, 256U));
+	}
+	listUnusedIndex_[(posUnusedIndex_ + countUnusedIndex_) % listUnusedIndex_.size()] = index;
+	++countUnusedIndex_;
+}
+int DxScriptObjectManager::_PopUnusedIndex() {
+	int res = listUnusedIndex_[posUnusedIndex_];
+	posUnusedIndex_ = (posUnusedIndex_ + 1) % listUnusedIndex_.size();
+	--countUnusedIndex_;
+	return res;
+}
+void DxScriptObjectManager::_LinkScriptObject(DxScriptObjectBase* obj) {
+	if (obj->idScript_ == ScriptClientBase::ID_SCRIPT_FREE) return;
+
+	std::vector<int>& listObject = mapScriptObject_[obj->idScript_];
+	obj->indexScriptObject_ = listObject.size();
+	listObject.push_back(obj->idObject_);
+}
+void DxScriptObjectManager::_UnlinkScriptObject(DxScriptObjectBase* obj) {
+	if (obj->idScript_ == ScriptClientBase::ID_SCRIPT_FREE) return;
+
+	auto itrFind = mapScriptObject_.find(obj->idScript_);
+	if (itrFind == mapScriptObject_.end()) return;
+
+	//Swap-remove, patching the index of the object moved into the hole
+	std::vector<int>& listObject = itrFind->second;
+	size_t index = obj->indexScriptObject_;
+	if (index >= listObject.size() || listObject[index] != obj->idObject_) return;
+
+	int idBack = listObject.back();
+	listObject[index] = idBack;
+	obj_[idBack]->indexScriptObject_ = index;
+	listObject.pop_back();
+
+	if (listObject.size() == 0)
+		mapScriptObject_.erase(itrFind);
+}
 void DxScriptObjectManager::SetRenderBucketCapacity(size_t capacity) {
 	listObjRender_.resize(capacity);
 	listShader_.resize(capacity);
 }
 
+bool DxScriptObjectManager::_ExpandContainerCapacity() {
+	size_t oldSize = obj_.size();
+	bool res = SetMaxObject(oldSize * 2U);
+	if (res) Logger::WriteTop(StringUtility::Format("DxScriptObjectManager: Object pool expansion. [%d->%d]",
+		oldSize, obj_.size()));
+	return res;
+}
+//Makes sure [count] IDs are free so a batch of AddObject calls doesn't expand the pool midway
+bool DxScriptObjectManager::ReserveObject(size_t count) {
+	while (countUnusedIndex_ < count) {
+		if (!_ExpandContainerCapacity()) return false;
+	}
+	return true;
+}
 int DxScriptObjectManager::AddObject(ref_unsync_ptr<DxScriptObjectBase> obj, bool bActivate) {
 	int res = DxScript::ID_INVALID;
 
-	auto ExpandContainerCapacity = [&]() -> bool {
-		size_t oldSize = obj_.size();
-		bool res = SetMaxObject(oldSize * 2U);
-		if (res) Logger::WriteTop(StringUtility::Format("DxScriptObjectManager: Object pool expansion. [%d->%d]",
-			oldSize, obj_.size()));
-		return res;
-	};
-
 	{
 		do {
-			if (listUnusedIndex_.size() == 0U) {
-				if (!ExpandContainerCapacity()) break;
+			if (countUnusedIndex_ == 0U) {
+				if (!_ExpandContainerCapacity()) break;
 			}
-			res = listUnusedIndex_.front();
-			listUnusedIndex_.pop_front();
+			res = _PopUnusedIndex();
 		} while (obj_[res]);
 
 		if (res != DxScript::ID_INVALID) {
@@ -1485,6 +1626,7 @@ int DxScriptObjectManager::AddObject(ref_unsync_ptr<DxScriptObjectBase> obj, boo
 			}
 			obj->idObject_ = res;
 			obj->manager_ = this;
+			_LinkScriptObject(obj.get());
 
 			++totalObjectCreateCount_;
 		}
@@ -1528,8 +1670,9 @@ void DxScriptObjectManager::_DeleteObject(int id) {
 	if (pObj == nullptr) return;
 
 	pObj->bDelete_ = true;
+	_UnlinkScriptObject(pObj.get());
 	if (pObj->manager_)
-		pObj->manager_->listUnusedIndex_.push_back(id);
+		pObj->manager_->_PushUnusedIndex(id);
 
 	obj_[id] = nullptr;
 	pObj->idObject_ = DxScript::ID_INVALID;
@@ -1547,47 +1690,61 @@ void DxScriptObjectManager::DeleteObject(DxScriptObjectBase* obj) {
 	if (obj == nullptr) return;
 	obj->bDelete_ = true;
 	obj->bActive_ = false;
-	listDeleteObject_.push_back(obj->idObject_);
+	if (!bParallelWork_)
+		listDeleteObject_.push_back(obj->idObject_);
 }
 
 void DxScriptObjectManager::ClearObject() {
 	std::fill(obj_.begin(), obj_.end(), nullptr);
 	listActiveObject_.clear();
+	mapScriptObject_.clear();
 
-	listUnusedIndex_.clear();
+	posUnusedIndex_ = 0;
+	countUnusedIndex_ = 0;
 	for (size_t iObj = 0; iObj < obj_.size(); ++iObj) {
-		listUnusedIndex_.push_back(iObj);
+		_PushUnusedIndex(iObj);
 	}
 }
+void DxScriptObjectManager::SetObjectScriptID(DxScriptObjectBase* obj, int64_t idScript) {
+	if (obj == nullptr || obj->idScript_ == idScript) return;
+
+	bool bOwned = obj->idObject_ >= 0 && (size_t)obj->idObject_ < obj_.size() && obj_[obj->idObject_].get() == obj;
+	if (bOwned)
+		_UnlinkScriptObject(obj);
+	obj->idScript_ = idScript;
+	if (bOwned)
+		_LinkScriptObject(obj);
+}
 void DxScriptObjectManager::DeleteObjectByScriptID(int64_t idScript) {
 	if (idScript == ScriptClientBase::ID_SCRIPT_FREE) return;
 
-	for (size_t iObj = 0; iObj < obj_.size(); ++iObj) {
-		auto& pObj = obj_[iObj];
-		if (pObj == nullptr) continue;
-		if (pObj->GetScriptID() != idScript) continue;
-		DeleteObject(pObj);
-	}
+	auto itrFind = mapScriptObject_.find(idScript);
+	if (itrFind == mapScriptObject_.end()) return;
+
+	//Same order as a scan of the pool, keeps the order IDs are freed in
+	std::vector<int> listObject = itrFind->second;
+	std::sort(listObject.begin(), listObject.end());
+	for (int id : listObject)
+		DeleteObject(obj_[id].get());
 }
 void DxScriptObjectManager::OrphanObjectByScriptID(int64_t idScript) {
 	if (idScript == ScriptClientBase::ID_SCRIPT_FREE) return;
 
-	for (size_t iObj = 0; iObj < obj_.size(); ++iObj) {
-		auto& pObj = obj_[iObj];
-		if (pObj == nullptr) continue;
-		if (pObj->GetScriptID() != idScript) continue;
-		pObj->idScript_ = ScriptClientBase::ID_SCRIPT_FREE;
-	}
+	auto itrFind = mapScriptObject_.find(idScript);
+	if (itrFind == mapScriptObject_.end()) return;
+
+	for (int id : itrFind->second)
+		obj_[id]->idScript_ = ScriptClientBase::ID_SCRIPT_FREE;
+	mapScriptObject_.erase(itrFind);
 }
 std::vector<int> DxScriptObjectManager::GetObjectByScriptID(int64_t idScript) {
 	std::vector<int> res;
 
 	if (idScript != ScriptClientBase::ID_SCRIPT_FREE) {
-		for (size_t iObj = 0; iObj < obj_.size(); ++iObj) {
-			auto& pObj = obj_[iObj];
-			if (pObj == nullptr) continue;
-			if (pObj->GetScriptID() != idScript) continue;
-			res.push_back(pObj->idObject_);
+		auto itrFind = mapScriptObject_.find(idScript);
+		if (itrFind != mapScriptObject_.end()) {
+			res = itrFind->second;
+			std::sort(res.begin(), res.end());
 		}
 	}
 	return res;
@@ -1608,16 +1765,46 @@ void DxScriptObjectManager::WorkObject() {
 	}
 	mapReservedSound_.clear();
 
+	//Ordered pass over the serial objects, the thread-safe ones are gathered and worked afterwards in one batch
+	listParallelWorkObject_.clear();
 	for (auto itr = listActiveObject_.begin(); itr != listActiveObject_.end();) {
 		DxScriptObjectBase* obj = itr->get();
 		if (obj == nullptr || obj->IsDeleted()) {
 			itr = listActiveObject_.erase(itr);
 			continue;
 		}
-		obj->Work();
-		++(obj->frameExist_);
+		if (obj->IsWorkThreadSafe())
+			listParallelWorkObject_.push_back(obj);
+		else {
+			obj->Work();
+			++(obj->frameExist_);
+		}
 		++itr;
 	}
+
+	size_t countParallel = listParallelWorkObject_.size();
+	if (countParallel > 0) {
+		listParallelDelete_.resize(countParallel);
+
+		bParallelWork_ = true;
+		ParallelFor(countParallel, [&](size_t i) {
+			DxScriptObjectBase* obj = listParallelWorkObject_[i];
+			//Already deleted by a serial object this frame, its ID may have been reused since
+			listParallelDelete_[i] = false;
+			if (obj->IsDeleted()) return;
+
+			obj->Work();
+			++(obj->frameExist_);
+			listParallelDelete_[i] = obj->IsDeleted();
+		});
+		bParallelWork_ = false;
+
+		for (size_t i = 0; i < countParallel; ++i) {
+			if (listParallelDelete_[i])
+				listDeleteObject_.push_back(listParallelWorkObject_[i]->idObject_);
+		}
+		listParallelWorkObject_.clear();
+	}
 }
 void DxScriptObjectManager::RenderObject() {
 	PrepareRenderObject();
@@ -1646,10 +1833,11 @@ void DxScriptObjectManager::RenderObject() {
 			}
 			if (effect) effect->EndPass();
 		}
-		renderList.Clear();
 
 		if (effect) effect->End();
 	}
+
+	ClearRenderObject();
 }
 void DxScriptObjectManager::CleanupObject() {
 	for (auto& obj : listActiveObject_) {
@@ -1662,38 +1850,43 @@ void DxScriptObjectManager::CleanupObject() {
 	listDeleteObject_.clear();
 }
 
-void DxScriptObjectManager::RenderList::Add(ref_unsync_ptr<DxScriptObjectBase>& ptr) {
-	if (size >= list.size())
-		list.push_back(ptr);
-	else
-		list[size++] = ptr;
-}
-void DxScriptObjectManager::RenderList::Clear() {
-	size = 0U;
-	std::fill(list.begin(), list.end(), nullptr);
-}
 void DxScriptObjectManager::PrepareRenderObject() {
+	size_t renderSize = listObjRender_.size();
+	if (renderSize == 0) return;
+
+	listRenderCandidate_.clear();
 	for (auto& obj : listActiveObject_) {
-		if (obj == nullptr || obj->IsDeleted()) continue;
+		if (obj) listRenderCandidate_.push_back(&obj);
+	}
+
+	listRenderIndex_.Build(listRenderCandidate_.size(), renderSize, [&](size_t i) -> uint32_t {
+		DxScriptObjectBase* obj = listRenderCandidate_[i]->get();
+		if (obj->IsDeleted()) return BucketIndexList::KEY_SKIP;
 		//Some render objects don't use normal rendering, thus sorting isn't required for them
-		if (!obj->HasNormalRendering()) continue;
-		if (!obj->IsVisible()) continue;
+		if (!obj->HasNormalRendering()) return BucketIndexList::KEY_SKIP;
+		if (!obj->IsVisible()) return BucketIndexList::KEY_SKIP;
 
-		AddRenderObject(obj);
-	}
-}
-void DxScriptObjectManager::AddRenderObject(ref_unsync_ptr<DxScriptObjectBase> obj) {
-	size_t renderSize = listObjRender_.size();
+		return std::clamp<int>(obj->priRender_, 0, (int)renderSize - 1);
+	});
+
+	listRenderSorted_.resize(listRenderIndex_.GetSize());
+	size_t pos = 0;
+	for (size_t iPri = 0; iPri < renderSize; ++iPri) {
+		RenderList& renderList = listObjRender_[iPri];
+		renderList.list = listRenderSorted_.data() + pos;
+		renderList.size = listRenderIndex_.GetBucketSize(iPri);
 
-	int tPri = obj->priRender_;
-	if (tPri < 0) tPri = 0;
-	else if (tPri > renderSize - 1) tPri = renderSize - 1;
-	listObjRender_[tPri].Add(obj);
+		const uint32_t* pEnd = listRenderIndex_.GetBucketEnd(iPri);
+		for (const uint32_t* pItr = listRenderIndex_.GetBucketBegin(iPri); pItr != pEnd; ++pItr)
+			listRenderSorted_[pos++] = *listRenderCandidate_[*pItr];
+	}
 }
 void DxScriptObjectManager::ClearRenderObject() {
 	for (size_t iPri = 0; iPri < listObjRender_.size(); ++iPri) {
 		listObjRender_[iPri].Clear();
 	}
+	listRenderCandidate_.clear();
+	listRenderSorted_.clear();
 }
 
 void DxScriptObjectManager::SetShader(shared_ptr<Shader> shader, int min, int max) {
@@ -15,6 +15,55 @@ namespace directx {
 	class DxScriptObjectManager;
 	class DxScriptObjectBase;
 
+	//****************************************************************************
+	//DxScriptValueKeyTable
+	//****************************************************************************
+	//Interns the string keys of Obj_SetValue and friends into small integer IDs
+	class DxScriptValueKeyTable {
+	public:
+		enum : uint32_t {
+			KEY_INVALID = 0xffffffff,
+
+			CACHE_SIZE = 256,
+		};
+	private:
+		struct CacheEntry {
+			ref_unsync_ptr<std::vector<gstd::value>> pArray;	//Held so the address can't be freed and reused
+			size_t length;
+			uint32_t key;
+		};
+
+		static std::unordered_map<std::wstring, uint32_t> mapKey_;
+		static std::vector<std::wstring> listKeyName_;
+
+		//Script string literals keep their array alive, so lookups by the array's address mostly hit here
+		static CacheEntry listCache_[CACHE_SIZE];
+	public:
+		static uint32_t GetKey(const std::wstring& name, bool bCreate);
+		static uint32_t GetKey(const gstd::value& name, bool bCreate);
+		static const std::wstring& GetKeyName(uint32_t key) { return listKeyName_[key]; }
+	};
+
+	//****************************************************************************
+	//DxScriptObjectValueMap
+	//****************************************************************************
+	//Flat map sorted by interned key, objects rarely carry more than a handful of values
+	class DxScriptObjectValueMap {
+		std::vector<std::pair<uint32_t, gstd::value>> listValue_;
+
+		std::vector<std::pair<uint32_t, gstd::value>>::iterator _LowerBound(uint32_t key);
+	public:
+		gstd::value* Find(uint32_t key);
+		void Set(uint32_t key, const gstd::value& val);
+		void Erase(uint32_t key);
+		void Clear() { listValue_.clear(); }
+
+		size_t size() const { return listValue_.size(); }
+
+		//Mode 0 - Clear and copy, 1 - Source overwrites, 2 - Existing values are kept
+		void CopyFrom(const DxScriptObjectValueMap& src, int mode);
+	};
+
 	//****************************************************************************
 	//DxScriptObjectBase
 	//****************************************************************************
@@ -27,6 +76,7 @@ namespace directx {
 		int idObject_;
 		TypeObject typeObject_;
 		int64_t idScript_;
+		size_t indexScriptObject_;		//Position in the manager's object list of idScript_
 
 		bool bDelete_;
 		bool bActive_;
@@ -35,7 +85,7 @@ namespace directx {
 
 		uint32_t frameExist_;
 
-		std::unordered_map<std::wstring, gstd::value> mapObjectValue_;
+		DxScriptObjectValueMap mapObjectValue_;
 		std::unordered_map<int64_t, gstd::value> mapObjectValueI_;
 	public:
 		DxScriptObjectBase();
@@ -52,10 +102,13 @@ namespace directx {
 		virtual void CleanUp() {}
 
 		virtual bool HasNormalRendering() { return false; }
+		//True if Work neither runs scripts nor touches state shared with other objects, allows it to run on worker threads
+		virtual bool IsWorkThreadSafe() { return false; }
 
 		int GetObjectID() { return idObject_; }
 		TypeObject GetObjectType() { return typeObject_; }
 		int64_t GetScriptID() { return idScript_; }
+		void SetScriptID(int64_t idScript);
 
 		bool IsDeleted() { return bDelete_; }
 		bool IsActive() { return bActive_; }
@@ -69,7 +122,7 @@ namespace directx {
 
 		uint32_t GetExistFrame() { return frameExist_; }
 
-		std::unordered_map<std::wstring, gstd::value>& GetValueMap() { return mapObjectValue_; }
+		DxScriptObjectValueMap& GetValueMap() { return mapObjectValue_; }
 		std::unordered_map<int64_t, gstd::value>& GetValueMapI() { return mapObjectValueI_; }
 	};
 
@@ -662,15 +715,15 @@ namespace directx {
 	class DxScriptObjectManager {
 		friend DxScriptObjectBase;
 	public:
+		//A view of one render priority's range in the sorted render queue
 		struct RenderList {
-			std::vector<ref_unsync_ptr<DxScriptObjectBase>> list;
+			const ref_unsync_ptr<DxScriptObjectBase>* list = nullptr;
 			size_t size = 0;
 
-			void Add(ref_unsync_ptr<DxScriptObjectBase>& ptr);
-			void Clear();
+			void Clear() { list = nullptr; size = 0; }
 
-			std::vector<ref_unsync_ptr<DxScriptObjectBase>>::const_iterator begin() { return list.cbegin(); }
-			std::vector<ref_unsync_ptr<DxScriptObjectBase>>::const_iterator end() { return begin() + size; }
+			const ref_unsync_ptr<DxScriptObjectBase>* begin() { return list; }
+			const ref_unsync_ptr<DxScriptObjectBase>* end() { return list + size; }
 		};
 		struct FogData {
 			bool enable;
@@ -686,26 +739,49 @@ namespace directx {
 		static FogData fogData_;
 	protected:
 		size_t totalObjectCreateCount_;
-		std::list<int> listUnusedIndex_;
+
+		//Ring buffer of free object IDs, reused oldest first so stale IDs in scripts stay invalid for a while
+		std::vector<int> listUnusedIndex_;
+		size_t posUnusedIndex_;
+		size_t countUnusedIndex_;
+
+		//Object IDs owned by each script, so closing a script doesn't scan the whole pool
+		std::unordered_map<int64_t, std::vector<int>> mapScriptObject_;
 
 		std::vector<ref_unsync_ptr<DxScriptObjectBase>> obj_;
 		std::list<ref_unsync_ptr<DxScriptObjectBase>> listActiveObject_;
 		std::vector<int> listDeleteObject_;
 
+		//Thread-safe objects are worked in parallel after the others, deletions during that pass are deferred
+		bool bParallelWork_;
+		std::vector<DxScriptObjectBase*> listParallelWorkObject_;
+		std::vector<uint8_t> listParallelDelete_;
+
 		std::unordered_map<std::wstring, shared_ptr<SoundPlayer>> mapReservedSound_;
 
+		//Render queue, visible objects counting-sorted by render priority into one contiguous list
 		std::vector<RenderList> listObjRender_;
+		std::vector<const ref_unsync_ptr<DxScriptObjectBase>*> listRenderCandidate_;
+		gstd::BucketIndexList listRenderIndex_;
+		std::vector<ref_unsync_ptr<DxScriptObjectBase>> listRenderSorted_;
 		std::vector<shared_ptr<Shader>> listShader_;
 
 		void _SetObjectID(DxScriptObjectBase* obj, int index) { obj->idObject_ = index; obj->manager_ = this; }
 
 		void _DeleteObject(int id);
+
+		bool _ExpandContainerCapacity();
+		void _PushUnusedIndex(int index);
+		int _PopUnusedIndex();
+		void _LinkScriptObject(DxScriptObjectBase* obj);
+		void _UnlinkScriptObject(DxScriptObjectBase* obj);
 	public:
 		DxScriptObjectManager();
 		virtual ~DxScriptObjectManager();
 
 		size_t GetMaxObject() { return obj_.size(); }
 		bool SetMaxObject(size_t size);
+		bool ReserveObject(size_t count);
 		size_t GetAliveObjectCount() { return listActiveObject_.size(); }
 		size_t GetRenderBucketCapacity() { return listObjRender_.size(); }
 		void SetRenderBucketCapacity(size_t capacity);
@@ -727,11 +803,11 @@ namespace directx {
 		virtual void DeleteObject(DxScriptObjectBase* obj);
 
 		void ClearObject();
+		void SetObjectScriptID(DxScriptObjectBase* obj, int64_t idScript);
 		void DeleteObjectByScriptID(int64_t idScript);
 		void OrphanObjectByScriptID(int64_t idScript);
 		std::vector<int> GetObjectByScriptID(int64_t idScript);
 
-		void AddRenderObject(ref_unsync_ptr<DxScriptObjectBase> obj);
 		void WorkObject();
 		virtual void RenderObject();
 		void CleanupObject();
@@ -2553,12 +2553,11 @@ gstd::value DxScript::Func_Obj_GetValue(gstd::script_machine* machine, int argc,
 	DxScriptObjectBase* obj = script->GetObjectPointer(id);
 	if (obj) {
 		if constexpr (!INTEGER) {
-			std::wstring key = argv[1].as_string();
-
-			auto& pValueMap = obj->GetValueMap();
-			auto itr = pValueMap.find(key);
-			if (itr != pValueMap.end())
-				return itr->second;
+			uint32_t key = DxScriptValueKeyTable::GetKey(argv[1], false);
+			if (key != DxScriptValueKeyTable::KEY_INVALID) {
+				if (gstd::value* pValue = obj->GetValueMap().Find(key))
+					return *pValue;
+			}
 		}
 		else {
 			int64_t key = argv[1].as_int();
@@ -2582,10 +2581,8 @@ gstd::value DxScript::Func_Obj_SetValue(gstd::script_machine* machine, int argc,
 	DxScriptObjectBase* obj = script->GetObjectPointer(id);
 	if (obj) {
 		if constexpr (!INTEGER) {
-			std::wstring key = argv[1].as_string();
-
-			auto& pValueMap = obj->GetValueMap();
-			pValueMap[key] = val;
+			uint32_t key = DxScriptValueKeyTable::GetKey(argv[1], true);
+			obj->GetValueMap().Set(key, val);
 		}
 		else {
 			int64_t key = argv[1].as_int();
@@ -2605,10 +2602,9 @@ gstd::value DxScript::Func_Obj_DeleteValue(gstd::script_machine* machine, int ar
 	DxScriptObjectBase* obj = script->GetObjectPointer(id);
 	if (obj) {
 		if constexpr (!INTEGER) {
-			std::wstring key = argv[1].as_string();
-
-			auto& pValueMap = obj->GetValueMap();
-			pValueMap.erase(key);
+			uint32_t key = DxScriptValueKeyTable::GetKey(argv[1], false);
+			if (key != DxScriptValueKeyTable::KEY_INVALID)
+				obj->GetValueMap().Erase(key);
 		}
 		else {
 			int64_t key = argv[1].as_int();
@@ -2630,10 +2626,8 @@ gstd::value DxScript::Func_Obj_IsValueExists(gstd::script_machine* machine, int
 	DxScriptObjectBase* obj = script->GetObjectPointer(id);
 	if (obj) {
 		if constexpr (!INTEGER) {
-			std::wstring key = argv[1].as_string();
-
-			auto& pValueMap = obj->GetValueMap();
-			res = pValueMap.find(key) != pValueMap.end();
+			uint32_t key = DxScriptValueKeyTable::GetKey(argv[1], false);
+			res = key != DxScriptValueKeyTable::KEY_INVALID && obj->GetValueMap().Find(key) != nullptr;
 		}
 		else {
 			int64_t key = argv[1].as_int();
@@ -2673,8 +2667,8 @@ static void _CopyValueTable(std::unordered_map<T, gstd::value>& srcMap, std::uno
 	//Mode 1 - Source takes priority (Always overwrite)
 	else if (mode == 1) {
 		for (auto itr = srcMap.begin(); itr != srcMap.end(); ++itr) {
-			auto itrDst = srcMap.find(itr->first);
-			if (itrDst != srcMap.end())
+			auto itrDst = dstMap.find(itr->first);
+			if (itrDst != dstMap.end())
 				itrDst->second = itr->second;
 			else
 				dstMap.insert(*itr);
@@ -2683,8 +2677,8 @@ static void _CopyValueTable(std::unordered_map<T, gstd::value>& srcMap, std::uno
 	//Mode 2 - Dest takes priority (No overwrite)
 	else if (mode == 2) {
 		for (auto itr = srcMap.begin(); itr != srcMap.end(); ++itr) {
-			auto itrDst = srcMap.find(itr->first);
-			if (itrDst == srcMap.end())
+			auto itrDst = dstMap.find(itr->first);
+			if (itrDst == dstMap.end())
 				dstMap.insert(*itr);
 		}
 	}
@@ -2706,9 +2700,8 @@ gstd::value DxScript::Func_Obj_CopyValueTable(gstd::script_machine* machine, int
 
 			if constexpr (!INTEGER) {
 				auto& srcMap = objSrc->GetValueMap();
-				auto& dstMap = objDst->GetValueMap();
 				countValue = srcMap.size();
-				_CopyValueTable(srcMap, dstMap, copyMode);
+				objDst->GetValueMap().CopyFrom(srcMap, copyMode);
 			}
 			else {
 				auto& srcMap = objSrc->GetValueMapI();
@@ -2758,7 +2751,7 @@ value DxScript::Func_Obj_SetParentScriptID(script_machine* machine, int argc, co
 	int64_t idScript = argc == 2 ? argv[1].as_int() : script->GetScriptID();
 
 	DxScriptObjectBase* obj = script->GetObjectPointerAs<DxScriptObjectBase>(id);
-	if (obj) obj->idScript_ = idScript;
+	if (obj) obj->SetScriptID(idScript);
 
 	return value();
 }
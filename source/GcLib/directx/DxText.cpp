@@ -733,8 +733,10 @@ void DxTextRenderObject::Render(const D3DXVECTOR2& angX, const D3DXVECTOR2& angY
 		sprite->SetColorRGB(color_);
 		sprite->SetAlpha(ColorAccess::GetColorA(color_));
 
+		//Differs per glyph sprite and follows the 2D camera, so it is always rebuilt
 		D3DXMATRIX matWorld = RenderObject::CreateWorldMatrixText2D(center, scale_, angX, angY, angZ,
 			position, bias, bCamera ? &DirectGraphics::GetBase()->GetCamera2D()->GetMatrix() : nullptr);
+		DirectGraphics::GetBase()->GetRecorder()->RecordWorldMatrix(true);
 
 		sprite->SetPermitCamera(false);
 		sprite->SetShader(shader_);
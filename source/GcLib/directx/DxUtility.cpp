@@ -329,4 +329,255 @@ void DxMath::TransformVertex2D(VERTEX_TLX(&vert)[4], D3DXVECTOR2* scale, D3DXVEC
 #endif
 }
 
+//*******************************************************************
+//RectPacker
+//*******************************************************************
+RectPacker::RectPacker() : RectPacker(0, 0) {
+}
+RectPacker::RectPacker(LONG width, LONG height) {
+	Initialize(width, height);
+}
+void RectPacker::Initialize(LONG width, LONG height) {
+	width_ = width;
+	height_ = height;
+
+	listNode_.clear();
+	listNode_.push_back(Node{ 0, 0, width });
+	listFree_.clear();
+}
+LONG RectPacker::_GetFitY(size_t index, LONG width, LONG height) const {
+	LONG x = listNode_[index].x;
+	if (x + width > width_) return -1;
+
+	//The rect rests on the highest segment it spans
+	LONG y = 0;
+	for (LONG remain = width; remain > 0; ++index) {
+		const Node& node = listNode_[index];
+		y = std::max(y, node.y);
+		if (y + height > height_) return -1;
+		remain -= node.width;
+	}
+	return y;
+}
+bool RectPacker::_InsertFree(LONG width, LONG height, POINT* pos) {
+	size_t indexBest = SIZE_MAX;
+	LONG areaBest = LONG_MAX;
+	for (size_t i = 0; i < listFree_.size(); ++i) {
+		const DxRect<LONG>& rc = listFree_[i];
+		LONG area = rc.GetWidth() * rc.GetHeight();
+		if (rc.GetWidth() >= width && rc.GetHeight() >= height && area < areaBest) {
+			indexBest = i;
+			areaBest = area;
+		}
+	}
+	if (indexBest == SIZE_MAX) return false;
+
+	DxRect<LONG> rc = listFree_[indexBest];
+	listFree_.erase(listFree_.begin() + indexBest);
+	pos->x = rc.left;
+	pos->y = rc.top;
+
+	//Guillotine split of what's left, along the longer leftover
+	LONG remainW = rc.GetWidth() - width;
+	LONG remainH = rc.GetHeight() - height;
+	DxRect<LONG> rcRight, rcBottom;
+	if (remainW > remainH) {
+		rcRight = DxRect<LONG>(rc.left + width, rc.top, rc.right, rc.bottom);
+		rcBottom = DxRect<LONG>(rc.left, rc.top + height, rc.left + width, rc.bottom);
+	}
+	else {
+		rcRight = DxRect<LONG>(rc.left + width, rc.top, rc.right, rc.top + height);
+		rcBottom = DxRect<LONG>(rc.left, rc.top + height, rc.right, rc.bottom);
+	}
+	if (rcRight.GetWidth() > 0 && rcRight.GetHeight() > 0)
+		listFree_.push_back(rcRight);
+	if (rcBottom.GetWidth() > 0 && rcBottom.GetHeight() > 0)
+		listFree_.push_back(rcBottom);
+
+	return true;
+}
+bool RectPacker::Insert(LONG width, LONG height, POINT* pos) {
+	if (width <= 0 || height <= 0) return false;
+	if (_InsertFree(width, height, pos)) return true;
+
+	size_t indexBest = SIZE_MAX;
+	LONG yBest = 0;
+	LONG topBest = LONG_MAX;
+	for (size_t i = 0; i < listNode_.size(); ++i) {
+		LONG y = _GetFitY(i, width, height);
+		if (y >= 0 && y + height < topBest) {
+			indexBest = i;
+			yBest = y;
+			topBest = y + height;
+		}
+	}
+	if (indexBest == SIZE_MAX) return false;
+
+	pos->x = listNode_[indexBest].x;
+	pos->y = yBest;
+
+	//New segment on top of the rect, then trim the ones underneath it
+	listNode_.insert(listNode_.begin() + indexBest, Node{ pos->x, topBest, width });
+	for (size_t i = indexBest + 1; i < listNode_.size();) {
+		LONG rightPrev = listNode_[i - 1].x + listNode_[i - 1].width;
+		Node& node = listNode_[i];
+		if (node.x >= rightPrev) break;
+
+		LONG shrink = rightPrev - node.x;
+		node.x += shrink;
+		node.width -= shrink;
+		if (node.width > 0) break;
+		listNode_.erase(listNode_.begin() + i);
+	}
+
+	//Merge neighbouring segments of the same height
+	for (size_t i = 0; i + 1 < listNode_.size();) {
+		if (listNode_[i].y == listNode_[i + 1].y) {
+			listNode_[i].width += listNode_[i + 1].width;
+			listNode_.erase(listNode_.begin() + i + 1);
+		}
+		else ++i;
+	}
+
+	return true;
+}
+void RectPacker::Free(const DxRect<LONG>& rect) {
+	if (rect.GetWidth() <= 0 || rect.GetHeight() <= 0) return;
+	listFree_.push_back(rect);
+}
+size_t RectPacker::GetUsedArea() const {
+	size_t res = 0;
+	for (const Node& node : listNode_)
+		res += (size_t)node.width * node.y;
+	return res;
+}
+bool RectPacker::SetNodeList(const std::vector<Node>& list) {
+	//Must be a valid skyline for this size
+	LONG x = 0;
+	for (const Node& node : list) {
+		if (node.x != x || node.width <= 0 || node.y < 0 || node.y > height_) return false;
+		x += node.width;
+	}
+	if (x != width_) return false;
+
+	listNode_ = list;
+	listFree_.clear();
+	return true;
+}
+bool RectPacker::SelfCheck(std::wstring* err) {
+	auto _Fail = [&](const wchar_t* what) {
+		if (err) *err = std::wstring(L"RectPacker: ") + what;
+		return false;
+	};
+	auto _IsOverlapped = [](const DxRect<LONG>& a, const DxRect<LONG>& b) {
+		return a.left < b.right && b.left < a.right && a.top < b.bottom && b.top < a.bottom;
+	};
+
+	constexpr LONG SIZE = 64;
+	constexpr LONG PAD = 2;
+
+	//Padded inserts until the page is full: every rect in bounds, no two overlapping,
+	//	so the unpadded contents stay at least two paddings apart
+	{
+		RectPacker packer(SIZE, SIZE);
+		std::vector<DxRect<LONG>> listRect;
+		for (LONG i = 0; ; ++i) {
+			LONG wd = 4 + (i * 7) % 13 + PAD * 2;
+			LONG ht = 4 + (i * 5) % 11 + PAD * 2;
+			POINT pos;
+			if (!packer.Insert(wd, ht, &pos)) break;
+			listRect.push_back(DxRect<LONG>(pos.x, pos.y, pos.x + wd, pos.y + ht));
+		}
+		if (listRect.size() < 4) return _Fail(L"Too few rects fit an empty page");
+
+		for (size_t i = 0; i < listRect.size(); ++i) {
+			const DxRect<LONG>& rc = listRect[i];
+			if (rc.left < 0 || rc.top < 0 || rc.right > SIZE || rc.bottom > SIZE)
+				return _Fail(L"Rect outside the page");
+			for (size_t j = i + 1; j < listRect.size(); ++j) {
+				if (_IsOverlapped(rc, listRect[j]))
+					return _Fail(L"Overlapping rects");
+				const DxRect<LONG>& rcB = listRect[j];
+				DxRect<LONG> rcInnerA(rc.left + PAD, rc.top + PAD, rc.right - PAD, rc.bottom - PAD);
+				DxRect<LONG> rcReachB(rcB.left - PAD, rcB.top - PAD, rcB.right + PAD, rcB.bottom + PAD);
+				if (_IsOverlapped(rcInnerA, rcReachB))
+					return _Fail(L"Padding between rects lost");
+			}
+		}
+		if (packer.GetUsedArea() > (size_t)(SIZE * SIZE))
+			return _Fail(L"Used area larger than the page");
+	}
+
+	//Rects that can never fit are rejected
+	{
+		RectPacker packer(SIZE, SIZE);
+		POINT pos;
+		if (packer.Insert(SIZE + 1, 1, &pos) || packer.Insert(1, SIZE + 1, &pos))
+			return _Fail(L"Oversized rect accepted");
+		if (packer.Insert(0, 4, &pos) || packer.Insert(4, -1, &pos))
+			return _Fail(L"Empty rect accepted");
+		if (!packer.Insert(SIZE, SIZE, &pos) || pos.x != 0 || pos.y != 0)
+			return _Fail(L"Page-sized rect rejected");
+		if (packer.Insert(1, 1, &pos))
+			return _Fail(L"Insert into a full page accepted");
+	}
+
+	//Freed rects are filled again, and their leftovers stay usable
+	{
+		RectPacker packer(SIZE, SIZE);
+		POINT posA, posB, pos;
+		if (!packer.Insert(32, 32, &posA) || !packer.Insert(32, 32, &posB))
+			return _Fail(L"Insert before free failed");
+		DxRect<LONG> rcA(posA.x, posA.y, posA.x + 32, posA.y + 32);
+
+		packer.Free(rcA);
+		if (packer.GetFreeCount() != 1)
+			return _Fail(L"Freed rect not kept");
+		if (!packer.Insert(16, 16, &pos) || !_IsOverlapped(rcA, DxRect<LONG>(pos.x, pos.y, pos.x + 16, pos.y + 16)))
+			return _Fail(L"Freed rect not reused");
+		if (pos.x != rcA.left || pos.y != rcA.top)
+			return _Fail(L"Freed rect reused at the wrong spot");
+		if (packer.GetFreeCount() != 2)
+			return _Fail(L"Leftovers of a freed rect lost");
+		if (!packer.Insert(16, 16, &pos) || !_IsOverlapped(rcA, DxRect<LONG>(pos.x, pos.y, pos.x + 16, pos.y + 16)))
+			return _Fail(L"Leftover of a freed rect not reused");
+
+		packer.Free(DxRect<LONG>(0, 0, 0, 8));
+		if (packer.GetFreeCount() != 1)
+			return _Fail(L"Empty freed rect kept");
+	}
+
+	//Only a gapless skyline that spans the page is accepted
+	{
+		RectPacker packer(SIZE, SIZE);
+		packer.Free(DxRect<LONG>(0, 0, 8, 8));
+		if (!packer.SetNodeList({ { 0, 10, 32 }, { 32, 0, 32 } }))
+			return _Fail(L"Valid skyline rejected");
+		if (packer.GetFreeCount() != 0)
+			return _Fail(L"Freed rects kept over a new skyline");
+
+		POINT pos;
+		if (!packer.Insert(32, 8, &pos) || pos.x != 32 || pos.y != 0)
+			return _Fail(L"Insert ignores the loaded skyline");
+
+		const std::vector<Node> listInvalid[] = {
+			{},
+			{ { 0, 0, 32 } },					//Too narrow
+			{ { 0, 0, 32 }, { 40, 0, 24 } },	//Gap
+			{ { 0, 0, 40 }, { 32, 0, 32 } },	//Overlap
+			{ { 0, 0, 0 }, { 0, 0, SIZE } },	//Empty segment
+			{ { 0, SIZE + 1, SIZE } },			//Above the page
+			{ { 0, -1, SIZE } },
+		};
+		for (const std::vector<Node>& list : listInvalid) {
+			if (packer.SetNodeList(list))
+				return _Fail(L"Invalid skyline accepted");
+		}
+		if (packer.GetNodeList().size() != 2 || packer.GetNodeList()[0].y != 10)
+			return _Fail(L"Rejected skyline replaced the old one");
+	}
+
+	return true;
+}
+
 #endif
\ No newline at end of file
@@ -181,5 +181,50 @@ namespace directx {
 		static bool Polygon_LineW(const std::vector<DxPoint>* verts, const DxWidthLine* line);
 		static bool Polygon_RegularPolygon(const std::vector<DxPoint>* verts, const DxRegularPolygon* polygon);
 	};
+
+	//*******************************************************************
+	//RectPacker
+	//*******************************************************************
+	//Skyline bottom-left packer for atlas pages, CPU only.
+	//	Freed rects can't lower the skyline, they're kept aside and filled first.
+	class RectPacker {
+	public:
+		struct Node {
+			LONG x;
+			LONG y;
+			LONG width;
+		};
+	private:
+		LONG width_;
+		LONG height_;
+		std::vector<Node> listNode_;	//Skyline segments, left to right, covering the whole width
+		std::vector<DxRect<LONG>> listFree_;
+
+		LONG _GetFitY(size_t index, LONG width, LONG height) const;
+		bool _InsertFree(LONG width, LONG height, POINT* pos);
+	public:
+		RectPacker();
+		RectPacker(LONG width, LONG height);
+
+		void Initialize(LONG width, LONG height);
+
+		//Occupies the smallest freed rect or the lowest spot that fits [width]x[height], returns false if there's none
+		bool Insert(LONG width, LONG height, POINT* pos);
+		//Gives back a rect returned by Insert
+		void Free(const DxRect<LONG>& rect);
+
+		LONG GetWidth() const { return width_; }
+		LONG GetHeight() const { return height_; }
+		//Area below the skyline, used or wasted
+		size_t GetUsedArea() const;
+
+		//The skyline only, freed rects aren't part of it
+		const std::vector<Node>& GetNodeList() const { return listNode_; }
+		bool SetNodeList(const std::vector<Node>& list);
+		size_t GetFreeCount() const { return listFree_.size(); }
+
+		//Runs the packer through insert, overlap, free and skyline validation cases, [err] names the first failure
+		static bool SelfCheck(std::wstring* err);
+	};
 #endif
 }
\ No newline at end of file
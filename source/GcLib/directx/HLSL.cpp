@@ -325,6 +325,64 @@ namespace directx {
 			"}"
 		"}";
 
+	const std::string ShaderSource::nameHwInstanceSprite_ = "_HLSL_INTERNAL_HW_INST_SPRITE";
+	const std::string ShaderSource::sourceHwInstanceSprite_ =
+		"sampler samp0_ : register(s0);"
+		"float4x4 g_mViewProj : VIEWPROJECTION : register(c0);"
+
+		"struct VS_INPUT {"
+			"float4 position : POSITION;"
+			"float4 diffuse : COLOR0;"
+			"float2 texCoord : TEXCOORD0;"
+			
+			"float4 i_color : COLOR1;"
+			"float4 i_edge_xy : TEXCOORD1;"
+			"float4 i_pos_usdat : TEXCOORD2;"
+			"float4 i_rect_uv : TEXCOORD3;"
+		"};"
+		"struct VS_OUTPUT {"
+			"float4 position : POSITION;"
+			"float4 diffuse : COLOR0;"
+			"float2 texCoord : TEXCOORD0;"
+		"};"
+
+		"VS_OUTPUT mainVS(VS_INPUT inVs) {"
+			"VS_OUTPUT outVs;"
+
+			"float2 corner = inVs.position.xy;"
+			"float2 pos = inVs.i_pos_usdat.xy + corner.x * inVs.i_edge_xy.xy + corner.y * inVs.i_edge_xy.zw;"
+
+			"outVs.diffuse = inVs.diffuse * inVs.i_color;"
+			"outVs.texCoord = lerp(inVs.i_rect_uv.xy, inVs.i_rect_uv.zw, inVs.texCoord);"
+			"outVs.position = mul(float4(pos, 0, 1), g_mViewProj);"
+			"outVs.position.z = 1.0f;"
+
+			"return outVs;"
+		"}"
+
+		"float4 mainPS(VS_OUTPUT inPs) : COLOR0 {"
+			"return tex2D(samp0_, inPs.texCoord) * inPs.diffuse;"
+		"}"
+		"float4 mainPS_inv(VS_OUTPUT inPs) : COLOR0 {"
+			"float4 color = tex2D(samp0_, inPs.texCoord);"
+			"color.rgb = 1.0f - color.rgb;"
+
+			"return color * inPs.diffuse;"
+		"}"
+
+		"technique Render {"
+			"pass P0 {"
+				"VertexShader = compile vs_2_0 mainVS();"
+				"PixelShader = compile ps_2_0 mainPS();"
+			"}"
+		"}"
+		"technique RenderInv {"
+			"pass P0 {"
+				"VertexShader = compile vs_2_0 mainVS();"
+				"PixelShader = compile ps_2_0 mainPS_inv();"
+			"}"
+		"}";
+
 	const std::string ShaderSource::nameIntersectVisual1_ = "_HLSL_INTERNAL_INTVISUAL_A";
 	const std::string ShaderSource::sourceIntersectVisual1_ = 
 		"sampler samp0_ : register(s0);"
@@ -414,6 +472,35 @@ namespace directx {
 			"}"
 		"}";
 
+	//*******************************************************************
+	//ShaderSemanticTable
+	//*******************************************************************
+	const char* const ShaderSemanticTable::NAME[SEMANTIC_COUNT] = {
+		"WORLD",
+		"VIEW",
+		"PROJECTION",
+		"VIEWPROJECTION",
+		"WORLDVIEWPROJ",
+		"ICOLOR",
+		"TEXTURE",
+		"FOGENABLE",
+		"FOGCOLOR",
+		"FOGDIST",
+	};
+
+	ShaderSemanticTable::ShaderSemanticTable() {
+		handle_.fill(nullptr);
+		recorder_ = nullptr;
+	}
+
+	void ShaderSemanticTable::Resolve(ID3DXEffect* effect) {
+		for (size_t i = 0; i < SEMANTIC_COUNT; ++i)
+			handle_[i] = effect ? effect->GetParameterBySemantic(nullptr, NAME[i]) : nullptr;
+
+		DirectGraphics* graphics = DirectGraphics::GetBase();
+		recorder_ = graphics ? graphics->GetRecorder() : nullptr;
+	}
+
 	//*******************************************************************
 	//RenderShaderLibrary
 	//*******************************************************************
@@ -439,7 +526,8 @@ namespace directx {
 				std::make_pair(&ShaderSource::sourceHwInstance2D_, &ShaderSource::nameHwInstance2D_),
 				std::make_pair(&ShaderSource::sourceHwInstance3D_, &ShaderSource::nameHwInstance3D_),
 				std::make_pair(&ShaderSource::sourceIntersectVisual1_, &ShaderSource::nameIntersectVisual1_),
-				std::make_pair(&ShaderSource::sourceIntersectVisual2_, &ShaderSource::nameIntersectVisual2_)
+				std::make_pair(&ShaderSource::sourceIntersectVisual2_, &ShaderSource::nameIntersectVisual2_),
+				std::make_pair(&ShaderSource::sourceHwInstanceSprite_, &ShaderSource::nameHwInstanceSprite_)
 			};
 			listEffect_.resize(listCreate.size(), nullptr);
 			for (size_t iEff = 0U; iEff < listCreate.size(); ++iEff) {
@@ -462,13 +550,18 @@ namespace directx {
 		if (listEffect_[0])
 			listEffect_[0]->SetTechnique("Render");
 
+		listSemantic_.resize(listEffect_.size());
+		for (size_t iEff = 0U; iEff < listEffect_.size(); ++iEff)
+			listSemantic_[iEff].Resolve(listEffect_[iEff]);
+
 		{
 			std::vector<std::pair<const D3DVERTEXELEMENT9*, std::string>> listCreate = {
 				std::make_pair(ELEMENTS_TLX, "ELEMENTS_TLX"),
 				std::make_pair(ELEMENTS_LX, "ELEMENTS_LX"),
 				std::make_pair(ELEMENTS_NX, "ELEMENTS_NX"),
 				std::make_pair(ELEMENTS_TLX_INSTANCED, "ELEMENTS_TLX_INSTANCED"),
-				std::make_pair(ELEMENTS_LX_INSTANCED, "ELEMENTS_LX_INSTANCED")
+				std::make_pair(ELEMENTS_LX_INSTANCED, "ELEMENTS_LX_INSTANCED"),
+				std::make_pair(ELEMENTS_TLX_INSTANCED_SPRITE, "ELEMENTS_TLX_INSTANCED_SPRITE")
 			};
 			listDeclaration_.resize(listCreate.size(), nullptr);
 			for (size_t iDecl = 0U; iDecl < listCreate.size(); ++iDecl) {
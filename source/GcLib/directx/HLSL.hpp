@@ -3,6 +3,7 @@
 #include "../pch.h"
 
 #include "DxConstant.hpp"
+#include "DirectGraphics.hpp"
 
 namespace directx {
 	class ShaderSource {
@@ -19,13 +20,49 @@ namespace directx {
 		static const std::string nameHwInstance3D_;
 		static const std::string sourceHwInstance3D_;
 
+		static const std::string nameHwInstanceSprite_;
+		static const std::string sourceHwInstanceSprite_;
+
 		static const std::string nameIntersectVisual1_;
 		static const std::string sourceIntersectVisual1_;
 
 		static const std::string nameIntersectVisual2_;
 		static const std::string sourceIntersectVisual2_;
 	};
-	
+
+	//Handles to the semantics the engine feeds every draw, looked up once per effect
+	class ShaderSemanticTable {
+	public:
+		enum Semantic : uint8_t {
+			WORLD,
+			VIEW,
+			PROJECTION,
+			VIEWPROJECTION,
+			WORLDVIEWPROJ,
+			ICOLOR,
+			TEXTURE,
+			FOGENABLE,
+			FOGCOLOR,
+			FOGDIST,
+
+			SEMANTIC_COUNT,
+		};
+	private:
+		static const char* const NAME[SEMANTIC_COUNT];
+
+		std::array<D3DXHANDLE, SEMANTIC_COUNT> handle_;
+		RenderRecorder* recorder_;
+	public:
+		ShaderSemanticTable();
+
+		void Resolve(ID3DXEffect* effect);
+		//Every handle found here is a GetParameterBySemantic call not made
+		D3DXHANDLE Get(Semantic semantic) const {
+			if (handle_[semantic] && recorder_) recorder_->RecordParamLookupSaved();
+			return handle_[semantic];
+		}
+	};
+
 	class RenderShaderLibrary {
 	public:
 		enum {
@@ -46,6 +83,7 @@ namespace directx {
 		ID3DXEffect* GetInstancing3DShader() { return listEffect_[2]; }
 		ID3DXEffect* GetIntersectVisualShader1() { return listEffect_[3]; }
 		ID3DXEffect* GetIntersectVisualShader2() { return listEffect_[4]; }
+		ID3DXEffect* GetInstancingSpriteShader() { return listEffect_[5]; }
 		size_t GetShaderCount() const { return listEffect_.size(); }
 
 		IDirect3DVertexDeclaration9* GetVertexDeclarationTLX() { return listDeclaration_[0]; }
@@ -53,6 +91,12 @@ namespace directx {
 		IDirect3DVertexDeclaration9* GetVertexDeclarationNX() { return listDeclaration_[2]; }
 		IDirect3DVertexDeclaration9* GetVertexDeclarationInstancedTLX() { return listDeclaration_[3]; }
 		IDirect3DVertexDeclaration9* GetVertexDeclarationInstancedLX() { return listDeclaration_[4]; }
+		IDirect3DVertexDeclaration9* GetVertexDeclarationInstancedSprite() { return listDeclaration_[5]; }
+
+		const ShaderSemanticTable* GetRender2DSemantic() { return &listSemantic_[0]; }
+		const ShaderSemanticTable* GetInstancing2DSemantic() { return &listSemantic_[1]; }
+		const ShaderSemanticTable* GetInstancing3DSemantic() { return &listSemantic_[2]; }
+		const ShaderSemanticTable* GetInstancingSpriteSemantic() { return &listSemantic_[5]; }
 
 		D3DXMATRIX* GetArrayMatrix() { return arrayMatrix; }
 	private:
@@ -62,8 +106,10 @@ namespace directx {
 		 * 2 -> 3D Hardware Instancing
 		 * 3 -> Intersection visualizer (circle)
 		 * 4 -> Intersection visualizer (line)
+		 * 5 -> 2D Hardware Instancing (sprites)
 		 */
 		std::vector<ID3DXEffect*> listEffect_;
+		std::vector<ShaderSemanticTable> listSemantic_;
 
 		/*
 		 * 0 -> TLX
@@ -71,6 +117,7 @@ namespace directx {
 		 * 2 -> NX
 		 * 3 -> Instanced TLX
 		 * 4 -> Instanced LX
+		 * 5 -> Instanced sprite
 		 */
 		std::vector<IDirect3DVertexDeclaration9*> listDeclaration_/*of Independence*/;
 
@@ -18,13 +18,33 @@ MetasequoiaMeshData::~MetasequoiaMeshData() {
 	for (auto& obj : materialList_) ptr_delete(obj);
 }
 bool MetasequoiaMeshData::CreateFromFileReader(shared_ptr<gstd::FileReader> reader) {
-	bool res = false;
 	path_ = reader->GetOriginalPath();
+	uint64_t timeStart = SystemUtility::GetCpuTime2();
 	std::string text;
 	size_t size = reader->GetFileSize();
 	text.resize(size);
 	reader->Read(&text[0], size);
 
+	//Skip the parse if the text matches the one the cache was built from
+	std::wstring pathCache = _GetCachePath();
+	uint64_t hashSource = _HashSource(text);
+	if (_LoadCache(pathCache, size, hashSource)) {
+		_CreateDeviceResource();
+		Logger::WriteTop(StringUtility::Format(L"MetasequoiaMeshData: Read from cache in %llu ms. [%s]",
+			SystemUtility::GetCpuTime2() - timeStart, PathProperty::ReduceModuleDirectory(path_).c_str()));
+		return true;
+	}
+
+	if (!_Parse(text)) return false;
+	_CreateDeviceResource();
+
+	Logger::WriteTop(StringUtility::Format(L"MetasequoiaMeshData: Parsed in %llu ms. [%s]",
+		SystemUtility::GetCpuTime2() - timeStart, PathProperty::ReduceModuleDirectory(path_).c_str()));
+	if (pathCache.size() > 0)
+		_SaveCache(pathCache, size, hashSource);
+	return true;
+}
+bool MetasequoiaMeshData::_Parse(const std::string& text) {
 	gstd::Scanner scanner(text);
 	try {
 		while (scanner.HasNext()) {
@@ -36,15 +56,21 @@ bool MetasequoiaMeshData::CreateFromFileReader(shared_ptr<gstd::FileReader> read
 				_ReadObject(scanner);
 			}
 		}
-
-		res = true;
 	}
 	catch (gstd::wexception& e) {
 		Logger::WriteTop(StringUtility::Format(L"MetasequoiaMeshData parsing error. [line %d-> %s]", 
 			scanner.GetCurrentLine(), e.what()));
-		res = false;
+		return false;
 	}
-	return res;
+	return true;
+}
+void MetasequoiaMeshData::_CreateDeviceResource() {
+	for (Material* mat : materialList_) {
+		if (mat->pathTexture_.size() > 0)
+			_LoadMaterialTexture(mat);
+	}
+	for (RenderObject* render : renderList_)
+		_CreateVertexBuffer(render);
 }
 void MetasequoiaMeshData::_ReadMaterial(gstd::Scanner& scanner) {
 	size_t countMaterial = scanner.Next().GetInteger();
@@ -111,10 +137,7 @@ void MetasequoiaMeshData::_ReadMaterial(gstd::Scanner& scanner) {
 			scanner.CheckType(scanner.Next(), Token::Type::TK_OPENP);
 			tok = scanner.Next();
 
-			std::wstring wPathTexture = tok.GetString();
-			std::wstring path = PathProperty::GetFileDirectory(path_) + wPathTexture;
-			mat->texture_ = std::make_shared<Texture>();
-			mat->texture_->CreateFromFile(PathProperty::GetUnique(path), false, false);
+			mat->pathTexture_ = tok.GetString();
 			scanner.CheckType(scanner.Next(), Token::Type::TK_CLOSEP);
 		}
 	}
@@ -419,25 +442,305 @@ void MetasequoiaMeshData::_ReadObject(gstd::Scanner& scanner) {
 				}
 			}
 		}
+	}
+}
+void MetasequoiaMeshData::_LoadMaterialTexture(Material* mat) {
+	std::wstring path = PathProperty::GetFileDirectory(path_) + mat->pathTexture_;
+	mat->texture_ = std::make_shared<Texture>();
+	mat->texture_->CreateFromFile(PathProperty::GetUnique(path), false, false);
+}
+void MetasequoiaMeshData::_CreateVertexBuffer(RenderObject* render) {
+	size_t countVert = render->GetVertexCount();
+	if (countVert == 0) return;
+
+	IDirect3DDevice9* device = DirectGraphics::GetBase()->GetDevice();
+	IDirect3DVertexBuffer9*& vertexBuf = render->pVertexBuffer_;
+
+	size_t vertexBufSize = std::min(countVert, 65536U) * sizeof(VERTEX_NX);
+	render->vertexBufferSize_ = vertexBufSize;
+
+	void* pVoid;
+	VERTEX_NX* pVertData = render->GetVertex(0);
+
+	device->CreateVertexBuffer(vertexBufSize, 0, VERTEX_NX::fvf, D3DPOOL_MANAGED, &vertexBuf, nullptr);
+
+	vertexBuf->Lock(0, vertexBufSize, &pVoid, D3DLOCK_DISCARD);
+	memcpy(pVoid, pVertData, vertexBufSize);
+	vertexBuf->Unlock();
+}
+
+uint64_t MetasequoiaMeshData::_HashSource(const std::string& text) {
+	return std::_Hash_array_representation(text.data(), text.size());
+}
+bool MetasequoiaMeshData::_ReadSourceFile(const std::wstring& path, std::string* dst) {
+	std::ifstream stream(path, std::ios::binary);
+	if (!stream.is_open()) return false;
+	dst->assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+	return true;
+}
+std::vector<std::wstring> MetasequoiaMeshData::_GetSourceList(const std::wstring& path) {
+	std::vector<std::wstring> res;
+	if (!stdfs::is_directory(path)) {
+		res.push_back(path);
+		return res;
+	}
+	for (auto& entry : stdfs::recursive_directory_iterator(path)) {
+		std::wstring ext = entry.path().extension().wstring();
+		std::transform(ext.begin(), ext.end(), ext.begin(), ::towlower);
+		if (entry.is_regular_file() && ext == L".mqo")
+			res.push_back(entry.path().wstring());
+	}
+	return res;
+}
+
+std::wstring MetasequoiaMeshData::GetPrebuiltPath(const std::wstring& pathSource) {
+	return PathProperty::GetFileDirectory(pathSource) 
+		+ PathProperty::GetFileNameWithoutExtension(pathSource) + L".mqc";
+}
+std::wstring MetasequoiaMeshData::ConvertPath(const std::wstring& path) {
+	size_t countConvert = 0;
+	std::wstring listFailed;
+	for (const std::wstring& pathSource : _GetSourceList(path)) {
+		std::string text;
+		MetasequoiaMeshData data;
+		data.path_ = pathSource;
+
+		if (_ReadSourceFile(pathSource, &text) && data._Parse(text)
+			&& data._SaveCache(GetPrebuiltPath(pathSource), text.size(), _HashSource(text)))
+			++countConvert;
+		else
+			listFailed += L"\r\n    Failed: " + pathSource;
+	}
+	return StringUtility::Format(L"Converted %u files", countConvert) + listFailed;
+}
+std::wstring MetasequoiaMeshData::BenchmarkPath(const std::wstring& path) {
+	using ms = std::chrono::duration<double, std::milli>;
+
+	std::wstring res;
+	double totalParse = 0, totalLoad = 0;
+	for (const std::wstring& pathSource : _GetSourceList(path)) {
+		std::string text;
+		if (!_ReadSourceFile(pathSource, &text)) continue;
+		uint64_t hashSource = _HashSource(text);
+
+		MetasequoiaMeshData dataParse;
+		auto timeStart = std::chrono::steady_clock::now();
+		bool bParse = dataParse._Parse(text);
+		double timeParse = ms(std::chrono::steady_clock::now() - timeStart).count();
+		if (!bParse) {
+			res += L"\r\n    Failed: " + pathSource;
+			continue;
+		}
+
+		ByteBuffer buffer;
+		dataParse._WriteCache(buffer, text.size(), hashSource);
+
+		MetasequoiaMeshData dataLoad;
+		timeStart = std::chrono::steady_clock::now();
+		dataLoad._ReadCache(buffer.GetPointer(), buffer.GetSize(), text.size(), hashSource);
+		double timeLoad = ms(std::chrono::steady_clock::now() - timeStart).count();
+
+		totalParse += timeParse;
+		totalLoad += timeLoad;
+		res += StringUtility::Format(L"\r\n    %s: parse %.2f ms, load %.2f ms (%u KB -> %u KB)",
+			PathProperty::GetFileName(pathSource).c_str(), timeParse, timeLoad,
+			text.size() / 1024U, buffer.GetSize() / 1024U);
+	}
+	return StringUtility::Format(L"Total: parse %.2f ms, load %.2f ms", totalParse, totalLoad) + res;
+}
+
+std::wstring MetasequoiaMeshData::_GetCachePath() {
+	DxMeshManager* manager = DxMeshManager::GetBase();
+	if (manager == nullptr || manager->GetCacheDirectory().size() == 0) return L"";
+
+	//One cache file per source path, a changed source overwrites it
+	std::wstring pathUnique = PathProperty::GetUnique(path_);
+	uint64_t hashPath = std::_Hash_array_representation(pathUnique.data(), pathUnique.size());
+	return manager->GetCacheDirectory() + StringUtility::FormatToWide("%016llx.mqc", hashPath);
+}
+bool MetasequoiaMeshData::_LoadCache(const std::wstring& path, uint64_t sizeSource, uint64_t hashSource) {
+	//Prebuilt files can be inside an archive, read those whole
+	if (shared_ptr<FileReader> reader = FileManager::GetBase()->GetFileReader(GetPrebuiltPath(path_))) {
+		if (reader->Open()) {
+			std::string data = reader->ReadAllString();
+			if (_ReadCache(data.data(), data.size(), sizeSource, hashSource)) return true;
+		}
+	}
+
+	if (path.size() > 0) {
+		MappedFile file;
+		if (file.Open(path) && _ReadCache(file.GetPointer(), file.GetSize(), sizeSource, hashSource))
+			return true;
+	}
+	return false;
+}
+bool MetasequoiaMeshData::_ReadCache(const void* data, size_t size, uint64_t sizeSource, uint64_t hashSource) {
+	const byte* pos = (const byte*)data;
+	const byte* end = pos + size;
+
+	auto _Read = [&](void* dst, size_t sizeRead) -> bool {
+		if (sizeRead > (size_t)(end - pos)) return false;
+		memcpy(dst, pos, sizeRead);
+		pos += sizeRead;
+		return true;
+	};
+	auto _ReadStringW = [&](std::wstring& dst) -> bool {
+		uint32_t length = 0;
+		if (!_Read(&length, sizeof(uint32_t)) || length > (size_t)(end - pos) / sizeof(wchar_t))
+			return false;
+		dst.resize(length);
+		return _Read(dst.data(), length * sizeof(wchar_t));
+	};
+	//Arrays are left in place and gathered from directly
+	auto _SkipArray = [&](const byte*& dst, uint32_t& count, size_t stride) -> bool {
+		if (!_Read(&count, sizeof(uint32_t)) || count > (size_t)(end - pos) / stride)
+			return false;
+		dst = pos;
+		pos += count * stride;
+		return true;
+	};
 
-		if (countVert > 0) {
-			IDirect3DDevice9* device = DirectGraphics::GetBase()->GetDevice();
-			IDirect3DVertexBuffer9*& vertexBuf = render->pVertexBuffer_;
+	{
+		char header[sizeof(CACHE_HEADER)];
+		uint32_t version = 0;
+		uint64_t sizeCache = 0, hashCache = 0;
+		if (!_Read(header, sizeof(header)) || memcmp(header, CACHE_HEADER, sizeof(CACHE_HEADER)) != 0) return false;
+		if (!_Read(&version, sizeof(uint32_t)) || version != CACHE_VERSION) return false;
+		if (!_Read(&sizeCache, sizeof(uint64_t)) || !_Read(&hashCache, sizeof(uint64_t))) return false;
+		if (sizeCache != sizeSource || hashCache != hashSource) return false;
+	}
 
-			size_t vertexBufSize = std::min(countVert, 65536U) * sizeof(VERTEX_NX);
-			render->vertexBufferSize_ = vertexBufSize;
+	std::vector<Material*> listMaterial;
+	std::vector<RenderObject*> listRender;
+	auto _Discard = [&]() {
+		for (auto& obj : listRender) ptr_delete(obj);
+		for (auto& obj : listMaterial) ptr_delete(obj);
+		return false;
+	};
+
+	uint32_t countMaterial = 0;
+	if (!_Read(&countMaterial, sizeof(uint32_t))) return false;
+	for (uint32_t iMat = 0; iMat < countMaterial; ++iMat) {
+		Material* mat = new Material();
+		listMaterial.push_back(mat);
+		if (!_ReadStringW(mat->name_) || !_Read(&mat->mat_, sizeof(D3DMATERIAL9)) || !_ReadStringW(mat->pathTexture_))
+			return _Discard();
+	}
 
-			void* pVoid;
-			VERTEX_NX* pVertData = render->GetVertex(0);
+	const byte* pVertex = nullptr;
+	const byte* pIndex = nullptr;
+	uint32_t countVertex = 0, countIndex = 0;
+	if (!_SkipArray(pVertex, countVertex, sizeof(VERTEX_NX)) || !_SkipArray(pIndex, countIndex, sizeof(uint32_t)))
+		return _Discard();
+
+	uint32_t countRender = 0;
+	if (!_Read(&countRender, sizeof(uint32_t))) return _Discard();
+	for (uint32_t iRender = 0; iRender < countRender; ++iRender) {
+		RenderObject* render = new RenderObject();
+		listRender.push_back(render);
+
+		int32_t indexMaterial = -1;
+		uint32_t indexFirst = 0, count = 0;
+		if (!_Read(&indexMaterial, sizeof(int32_t)) || !_Read(&render->objectColor_, sizeof(D3DXVECTOR3))
+			|| !_Read(&indexFirst, sizeof(uint32_t)) || !_Read(&count, sizeof(uint32_t)))
+			return _Discard();
+		if (indexFirst > countIndex || count > countIndex - indexFirst)
+			return _Discard();
+
+		if (indexMaterial >= 0 && (size_t)indexMaterial < listMaterial.size())
+			render->material_ = listMaterial[indexMaterial];
+
+		//Expanded again, the vertex buffers are drawn without indices
+		render->SetVertexCount(count);
+		for (size_t iVert = 0; iVert < render->GetVertexCount(); ++iVert) {
+			uint32_t index = 0;
+			memcpy(&index, pIndex + (indexFirst + iVert) * sizeof(uint32_t), sizeof(uint32_t));
+			if (index >= countVertex) return _Discard();
+			memcpy(render->GetVertex(iVert), pVertex + index * sizeof(VERTEX_NX), sizeof(VERTEX_NX));
+		}
+	}
 
-			device->CreateVertexBuffer(vertexBufSize, 0, VERTEX_NX::fvf, D3DPOOL_MANAGED, &vertexBuf, nullptr);
+	materialList_ = MOVE(listMaterial);
+	renderList_ = MOVE(listRender);
+	return true;
+}
+void MetasequoiaMeshData::_WriteCache(ByteBuffer& dst, uint64_t sizeSource, uint64_t hashSource) {
+	auto _WriteStringW = [&](const std::wstring& str) {
+		dst.WriteValue<uint32_t>(str.size());
+		dst.Write((LPVOID)str.data(), str.size() * sizeof(wchar_t));
+	};
+
+	dst.Write((LPVOID)CACHE_HEADER, sizeof(CACHE_HEADER));
+	dst.WriteValue<uint32_t>(CACHE_VERSION);
+	dst.WriteValue<uint64_t>(sizeSource);
+	dst.WriteValue<uint64_t>(hashSource);
+
+	dst.WriteValue<uint32_t>(materialList_.size());
+	for (Material* mat : materialList_) {
+		_WriteStringW(mat->name_);
+		dst.Write(mat->mat_);
+		_WriteStringW(mat->pathTexture_);
+	}
 
-			vertexBuf->Lock(0, vertexBufSize, &pVoid, D3DLOCK_DISCARD);
-			memcpy(pVoid, pVertData, vertexBufSize);
-			vertexBuf->Unlock();
+	//Faces that share an edge and a plane share vertices
+	struct VertexHash {
+		size_t operator()(const VERTEX_NX& v) const {
+			return std::_Hash_array_representation((const byte*)&v, sizeof(VERTEX_NX));
+		}
+	};
+	struct VertexEqual {
+		bool operator()(const VERTEX_NX& a, const VERTEX_NX& b) const {
+			return memcmp(&a, &b, sizeof(VERTEX_NX)) == 0;
 		}
+	};
+	std::unordered_map<VERTEX_NX, uint32_t, VertexHash, VertexEqual> mapVertex;
+	std::vector<VERTEX_NX> listVertex;
+	std::vector<uint32_t> listIndex;
+	for (RenderObject* render : renderList_) {
+		for (size_t iVert = 0; iVert < render->GetVertexCount(); ++iVert) {
+			const VERTEX_NX& vert = *render->GetVertex(iVert);
+			auto itr = mapVertex.try_emplace(vert, (uint32_t)listVertex.size());
+			if (itr.second)
+				listVertex.push_back(vert);
+			listIndex.push_back(itr.first->second);
+		}
+	}
+
+	dst.WriteValue<uint32_t>(listVertex.size());
+	if (listVertex.size() > 0)
+		dst.Write(listVertex.data(), listVertex.size() * sizeof(VERTEX_NX));
+	dst.WriteValue<uint32_t>(listIndex.size());
+	if (listIndex.size() > 0)
+		dst.Write(listIndex.data(), listIndex.size() * sizeof(uint32_t));
+
+	dst.WriteValue<uint32_t>(renderList_.size());
+	uint32_t indexFirst = 0;
+	for (RenderObject* render : renderList_) {
+		auto itrMat = std::find(materialList_.begin(), materialList_.end(), render->material_);
+		int32_t indexMaterial = itrMat != materialList_.end() ? (int32_t)(itrMat - materialList_.begin()) : -1;
+
+		uint32_t count = render->GetVertexCount();
+		dst.WriteValue<int32_t>(indexMaterial);
+		dst.Write(render->objectColor_);
+		dst.WriteValue<uint32_t>(indexFirst);
+		dst.WriteValue<uint32_t>(count);
+		indexFirst += count;
 	}
 }
+bool MetasequoiaMeshData::_SaveCache(const std::wstring& path, uint64_t sizeSource, uint64_t hashSource) {
+	ByteBuffer buffer;
+	_WriteCache(buffer, sizeSource, hashSource);
+
+	File::CreateFileDirectory(path);
+	File file(path);
+	if (!file.Open(File::AccessType::WRITEONLY)) {
+		Logger::WriteTop(L"MetasequoiaMeshData: Failed to write mesh cache. [" 
+			+ PathProperty::ReduceModuleDirectory(path) + L"]");
+		return false;
+	}
+	file.Write(buffer.GetPointer(), buffer.GetSize());
+	return true;
+}
 
 //This causes a memory leak but who cares, it's only once and will get deleted once the game closes anyway
 MetasequoiaMeshData::Material* MetasequoiaMeshData::RenderObject::nullMaterial_ = new Material();
@@ -512,16 +815,25 @@ void MetasequoiaMesh::Render(const D3DXVECTOR2& angX, const D3DXVECTOR2& angY, c
 		IDirect3DDevice9* device = graphics->GetDevice();
 		auto& camera = graphics->GetCamera();
 
-		DWORD bFogEnable = FALSE;
+		bool bFogEnable = false;
 		if (bCoordinate2D_) {
 			device->SetTransform(D3DTS_VIEW, &camera->GetIdentity());
-			device->GetRenderState(D3DRS_FOGENABLE, &bFogEnable);
-			device->SetRenderState(D3DRS_FOGENABLE, FALSE);
+			bFogEnable = graphics->IsFogEnable();
+			graphics->SetFogEnable(false);
 			RenderObject::SetCoordinate2dDeviceMatrix();
 		}
 
-		D3DXMATRIX mat = RenderObject::CreateWorldMatrix(position_, scale_,
-			angX, angY, angZ, &camera->GetIdentity(), bCoordinate2D_);
+		auto _Build = [&]() {
+			return RenderObject::CreateWorldMatrix(position_, scale_,
+				angX, angY, angZ, &camera->GetIdentity(), bCoordinate2D_);
+		};
+		D3DXMATRIX mat;
+		if (bCoordinate2D_) {
+			//Follows the 3D camera and the viewport, can't be cached
+			mat = _Build();
+			_CountWorldMatrix(true);
+		}
+		else mat = _GetWorldMatrix(angX, angY, angZ, _Build);
 		device->SetTransform(D3DTS_WORLD, &mat);
 
 		{
@@ -537,7 +849,7 @@ void MetasequoiaMesh::Render(const D3DXVECTOR2& angX, const D3DXVECTOR2& angY, c
 
 		if (bCoordinate2D_) {
 			device->SetTransform(D3DTS_VIEW, &camera->GetViewProjectionMatrix());
-			device->SetRenderState(D3DRS_FOGENABLE, bFogEnable);
+			graphics->SetFogEnable(bFogEnable);
 		}
 	}
 }
@@ -15,6 +15,14 @@ namespace directx {
 		class Object;
 		class RenderObject;
 
+		//Binary cache of the parsed mesh, validated against the source text.
+		//Holds the materials, a deduplicated vertex pool, the indices, and an index range per render object.
+		//Read from a prebuilt file next to the source first (see ConvertPath), then from the cache directory.
+		enum : uint32_t {
+			CACHE_VERSION = 2,
+		};
+		static constexpr const char CACHE_HEADER[] = "MQOCACHE";
+
 		struct NormalData {
 			std::vector<uint16_t> listIndex_;
 			D3DXVECTOR3 normal_;
@@ -27,11 +35,35 @@ namespace directx {
 
 		void _ReadMaterial(gstd::Scanner& scanner);
 		void _ReadObject(gstd::Scanner& scanner);
+
+		void _LoadMaterialTexture(Material* mat);
+		static void _CreateVertexBuffer(RenderObject* render);
+
+		bool _Parse(const std::string& text);
+		void _CreateDeviceResource();
+
+		static uint64_t _HashSource(const std::string& text);
+		static bool _ReadSourceFile(const std::wstring& path, std::string* dst);
+		static std::vector<std::wstring> _GetSourceList(const std::wstring& path);
+
+		std::wstring _GetCachePath();
+		bool _LoadCache(const std::wstring& path, uint64_t sizeSource, uint64_t hashSource);
+		bool _ReadCache(const void* data, size_t size, uint64_t sizeSource, uint64_t hashSource);
+		void _WriteCache(gstd::ByteBuffer& dst, uint64_t sizeSource, uint64_t hashSource);
+		bool _SaveCache(const std::wstring& path, uint64_t sizeSource, uint64_t hashSource);
 	public:
 		MetasequoiaMeshData();
 		~MetasequoiaMeshData();
 
 		bool CreateFromFileReader(shared_ptr<gstd::FileReader> reader);
+
+		static std::wstring GetPrebuiltPath(const std::wstring& pathSource);
+
+		//Tools, neither touches the device. path is an .mqo file or a directory of them.
+		//Writes a prebuilt cache next to every source, for shipping in archives
+		static std::wstring ConvertPath(const std::wstring& path);
+		//Times the text parse against a load from the cache format
+		static std::wstring BenchmarkPath(const std::wstring& path);
 	};
 
 	class MetasequoiaMeshData::Material {
@@ -41,6 +73,7 @@ namespace directx {
 	protected:
 		std::wstring name_;
 		D3DMATERIAL9 mat_;
+		std::wstring pathTexture_;	//As written in the file
 		shared_ptr<Texture> texture_;
 		std::string pathTextureAlpha_;
 		std::string pathTextureBump_;
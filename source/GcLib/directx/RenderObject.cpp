@@ -30,9 +30,10 @@ DirectionalLightingState::DirectionalLightingState() {
 	light_.Direction = D3DXVECTOR3(-1, -1, -1);
 }
 void DirectionalLightingState::Apply() {
-	IDirect3DDevice9* device = DirectGraphics::GetBase()->GetDevice();
-	device->SetRenderState(D3DRS_LIGHTING, bLightEnable_);
-	device->SetRenderState(D3DRS_SPECULARENABLE, bLightEnable_ ? bSpecularEnable_ : false);
+	DirectGraphics* graphics = DirectGraphics::GetBase();
+	IDirect3DDevice9* device = graphics->GetDevice();
+	graphics->SetLightingEnable(bLightEnable_);
+	graphics->SetSpecularEnable(bLightEnable_ ? bSpecularEnable_ : false);
 	device->LightEnable(0, bLightEnable_);
 	if (bLightEnable_) device->SetLight(0, &light_);
 }
@@ -50,6 +51,9 @@ RenderObject::RenderObject() {
 	disableMatrixTransform_ = false;
 	bVertexShaderMode_ = false;
 	flgUseVertexBufferMode_ = true;
+
+	bWorldDirty_ = true;
+	D3DXMatrixIdentity(&matWorld_);
 }
 RenderObject::~RenderObject() {
 }
@@ -80,24 +84,61 @@ void RenderObject::Copy(RenderObject* src) {
 	disableMatrixTransform_ = src->disableMatrixTransform_;
 	bVertexShaderMode_ = src->bVertexShaderMode_;
 	flgUseVertexBufferMode_ = src->flgUseVertexBufferMode_;
+
+	bWorldDirty_ = true;
+}
+
+void RenderObject::_CountWorldMatrix(bool bBuild) {
+	DirectGraphics::GetBase()->GetRecorder()->RecordWorldMatrix(bBuild);
 }
 
 void RenderObject::SetPosition(float x, float y, float z) {
-	position_ = D3DXVECTOR3(x, y, z);
-	D3DXVec3Scale(&position_, &position_, DirectGraphics::g_dxCoordsMul_);
+	D3DXVECTOR3 pos = D3DXVECTOR3(x, y, z) * DirectGraphics::g_dxCoordsMul_;
+	if (pos != position_) {
+		position_ = pos;
+		_SetWorldDirty();
+	}
 }
 void RenderObject::SetX(float x) {
-	position_.x = x * DirectGraphics::g_dxCoordsMul_;
+	x *= DirectGraphics::g_dxCoordsMul_;
+	if (x != position_.x) {
+		position_.x = x;
+		_SetWorldDirty();
+	}
 }
 void RenderObject::SetY(float y) {
-	position_.y = y * DirectGraphics::g_dxCoordsMul_;
+	y *= DirectGraphics::g_dxCoordsMul_;
+	if (y != position_.y) {
+		position_.y = y;
+		_SetWorldDirty();
+	}
 }
 void RenderObject::SetZ(float z) {
-	position_.z = z * DirectGraphics::g_dxCoordsMul_;
+	z *= DirectGraphics::g_dxCoordsMul_;
+	if (z != position_.z) {
+		position_.z = z;
+		_SetWorldDirty();
+	}
+}
+void RenderObject::SetAngleXYZ(float angx, float angy, float angz) {
+	D3DXVECTOR3 angle(angx, angy, angz);
+	if (angle != angle_) {
+		angle_ = angle;
+		_SetWorldDirty();
+	}
 }
 void RenderObject::SetScaleXYZ(float sx, float sy, float sz) {
-	scale_ = D3DXVECTOR3(sx, sy, sz);
-	D3DXVec3Scale(&scale_, &scale_, DirectGraphics::g_dxCoordsMul_);
+	D3DXVECTOR3 scale = D3DXVECTOR3(sx, sy, sz) * DirectGraphics::g_dxCoordsMul_;
+	if (scale != scale_) {
+		scale_ = scale;
+		_SetWorldDirty();
+	}
+}
+void RenderObject::SetRelativeMatrix(shared_ptr<D3DXMATRIX>& mat) {
+	//Parents hand in a fresh matrix every frame, only a different value invalidates the cache
+	bool bSame = (mat == matRelative_) || (mat && matRelative_ && *mat == *matRelative_);
+	matRelative_ = mat;
+	if (!bSame) _SetWorldDirty();
 }
 
 //---------------------------------------------------------------------
@@ -412,8 +453,11 @@ void RenderObjectTLX::Render(const D3DXVECTOR2& angX, const D3DXVECTOR2& angY, c
 
 	D3DXMATRIX matWorld;
 	if (!disableMatrixTransform_) {
-		matWorld = RenderObject::CreateWorldMatrix2D(position_, scale_,
-			angX, angY, angZ, bCamera ? &camera->GetMatrix() : nullptr);
+		matWorld = _GetWorldMatrix(angX, angY, angZ, [&]() {
+			return RenderObject::CreateWorldMatrix2D(position_, scale_, angX, angY, angZ, nullptr);
+		});
+		if (bCamera)
+			D3DXMatrixMultiply(&matWorld, &matWorld, &camera->GetMatrix());
 	}
 	else {
 		matWorld = camera->GetMatrix();
@@ -476,8 +520,10 @@ void RenderObjectTLX::Render(const D3DXMATRIX& matTransform) {
 		{
 			UINT countPass = 1;
 			ID3DXEffect* effect = nullptr;
+			const ShaderSemanticTable* semantic = nullptr;
 			if (shader_) {
 				effect = shader_->GetEffect();
+				semantic = shader_->GetSemanticTable();
 
 				if (shader_->LoadTechnique()) {
 					shader_->LoadParameter();
@@ -486,9 +532,9 @@ void RenderObjectTLX::Render(const D3DXMATRIX& matTransform) {
 						device->SetVertexDeclaration(shaderLib->GetVertexDeclarationTLX());
 
 						D3DXHANDLE handle = nullptr;
-						if (handle = effect->GetParameterBySemantic(nullptr, "WORLD"))
+						if (handle = semantic->Get(ShaderSemanticTable::WORLD))
 							effect->SetMatrix(handle, &matTransform);
-						if (handle = effect->GetParameterBySemantic(nullptr, "VIEWPROJECTION")) {
+						if (handle = semantic->Get(ShaderSemanticTable::VIEWPROJECTION)) {
 							effect->SetMatrix(handle, &graphics->GetViewPortMatrix());
 						}
 					}
@@ -500,15 +546,15 @@ void RenderObjectTLX::Render(const D3DXMATRIX& matTransform) {
 				if (effect) effect->BeginPass(iPass);
 
 				if (flgUseVertexBufferMode_ || bVertexShaderMode_) {
-					if (bUseIndex) device->DrawIndexedPrimitive(typePrimitive_, 0, 0, countVertex, 0, countPrim);
-					else device->DrawPrimitive(typePrimitive_, 0, countPrim);
+					if (bUseIndex) graphics->DrawIndexedPrimitive(typePrimitive_, 0, 0, countVertex, 0, countPrim);
+					else graphics->DrawPrimitive(typePrimitive_, 0, countPrim);
 				}
 				else {
 					if (bUseIndex)
-						device->DrawIndexedPrimitiveUP(typePrimitive_, 0, countVertex, countPrim,
+						graphics->DrawIndexedPrimitiveUP(typePrimitive_, 0, countVertex, countPrim,
 							vertexIndices_.data(), D3DFMT_INDEX16, vertCopy_.data(), strideVertexStreamZero_);
 					else
-						device->DrawPrimitiveUP(typePrimitive_, countPrim, vertCopy_.data(), strideVertexStreamZero_);
+						graphics->DrawPrimitiveUP(typePrimitive_, countPrim, vertCopy_.data(), strideVertexStreamZero_);
 				}
 
 				if (effect) effect->EndPass();
@@ -623,8 +669,10 @@ void RenderObjectLX::Render() {
 void RenderObjectLX::Render(const D3DXVECTOR2& angX, const D3DXVECTOR2& angY, const D3DXVECTOR2& angZ) {
 	D3DXMATRIX matWorld;
 	if (!disableMatrixTransform_) {
-		matWorld = RenderObject::CreateWorldMatrix(position_, scale_,
-			angX, angY, angZ, matRelative_.get(), false);
+		matWorld = _GetWorldMatrix(angX, angY, angZ, [&]() {
+			return RenderObject::CreateWorldMatrix(position_, scale_,
+				angX, angY, angZ, matRelative_.get(), false);
+		});
 	}
 	else {
 		if (matRelative_ == nullptr)
@@ -678,8 +726,10 @@ void RenderObjectLX::Render(const D3DXMATRIX& matTransform) {
 
 		UINT countPass = 1;
 		ID3DXEffect* effect = nullptr;
+		const ShaderSemanticTable* semantic = nullptr;
 		if (shader_ != nullptr) {
 			effect = shader_->GetEffect();
+			semantic = shader_->GetSemanticTable();
 
 			if (shader_->LoadTechnique()) {
 				shader_->LoadParameter();
@@ -694,20 +744,20 @@ void RenderObjectLX::Render(const D3DXMATRIX& matTransform) {
 					device->SetVertexDeclaration(shaderLib->GetVertexDeclarationLX());
 
 					D3DXHANDLE handle = nullptr;
-					if (handle = effect->GetParameterBySemantic(nullptr, "WORLD"))
+					if (handle = semantic->Get(ShaderSemanticTable::WORLD))
 						effect->SetMatrix(handle, &matTransform);
-					if (handle = effect->GetParameterBySemantic(nullptr, "VIEW"))
+					if (handle = semantic->Get(ShaderSemanticTable::VIEW))
 						effect->SetMatrix(handle, &camera->GetViewMatrix());
-					if (handle = effect->GetParameterBySemantic(nullptr, "PROJECTION"))
+					if (handle = semantic->Get(ShaderSemanticTable::PROJECTION))
 						effect->SetMatrix(handle, &camera->GetProjectionMatrix());
-					if (handle = effect->GetParameterBySemantic(nullptr, "VIEWPROJECTION"))
+					if (handle = semantic->Get(ShaderSemanticTable::VIEWPROJECTION))
 						effect->SetMatrix(handle, &camera->GetViewProjectionMatrix());
-					if (handle = effect->GetParameterBySemantic(nullptr, "FOGENABLE"))
+					if (handle = semantic->Get(ShaderSemanticTable::FOGENABLE))
 						effect->SetBool(handle, bFog);
 					if (bFog) {
-						if (handle = effect->GetParameterBySemantic(nullptr, "FOGCOLOR"))
+						if (handle = semantic->Get(ShaderSemanticTable::FOGCOLOR))
 							effect->SetFloatArray(handle, (FLOAT*)(&(fogParam->color)), 3);
-						if (handle = effect->GetParameterBySemantic(nullptr, "FOGDIST"))
+						if (handle = semantic->Get(ShaderSemanticTable::FOGDIST))
 							effect->SetFloatArray(handle, (FLOAT*)(&(fogParam->fogDist)), 2);
 					}
 				}
@@ -719,15 +769,15 @@ void RenderObjectLX::Render(const D3DXMATRIX& matTransform) {
 			if (effect) effect->BeginPass(iPass);
 
 			if (flgUseVertexBufferMode_ || bVertexShaderMode_) {
-				if (bUseIndex) device->DrawIndexedPrimitive(typePrimitive_, 0, 0, countVertex, 0, countPrim);
-				else device->DrawPrimitive(typePrimitive_, 0, countPrim);
+				if (bUseIndex) graphics->DrawIndexedPrimitive(typePrimitive_, 0, 0, countVertex, 0, countPrim);
+				else graphics->DrawPrimitive(typePrimitive_, 0, countPrim);
 			}
 			else {
 				if (bUseIndex)
-					device->DrawIndexedPrimitiveUP(typePrimitive_, 0, countVertex, countPrim,
+					graphics->DrawIndexedPrimitiveUP(typePrimitive_, 0, countVertex, countPrim,
 						vertexIndices_.data(), D3DFMT_INDEX16, vertex_.data(), strideVertexStreamZero_);
 				else
-					device->DrawPrimitiveUP(typePrimitive_, countPrim, vertex_.data(), strideVertexStreamZero_);
+					graphics->DrawPrimitiveUP(typePrimitive_, countPrim, vertex_.data(), strideVertexStreamZero_);
 			}
 
 			if (effect) effect->EndPass();
@@ -874,8 +924,10 @@ void RenderObjectNX::Render(D3DXMATRIX* matTransform) {
 
 		UINT countPass = 1;
 		ID3DXEffect* effect = nullptr;
+		const ShaderSemanticTable* semantic = nullptr;
 		if (shader_ != nullptr) {
 			effect = shader_->GetEffect();
+			semantic = shader_->GetSemanticTable();
 
 			if (shader_->LoadTechnique()) {
 				shader_->LoadParameter();
@@ -890,20 +942,20 @@ void RenderObjectNX::Render(D3DXMATRIX* matTransform) {
 					device->SetVertexDeclaration(shaderLib->GetVertexDeclarationNX());
 
 					D3DXHANDLE handle = nullptr;
-					if (handle = effect->GetParameterBySemantic(nullptr, "WORLD"))
+					if (handle = semantic->Get(ShaderSemanticTable::WORLD))
 						effect->SetMatrix(handle, matTransform ? matTransform : &graphics->GetCamera()->GetIdentity());
-					if (handle = effect->GetParameterBySemantic(nullptr, "VIEW"))
+					if (handle = semantic->Get(ShaderSemanticTable::VIEW))
 						effect->SetMatrix(handle, &camera->GetViewMatrix());
-					if (handle = effect->GetParameterBySemantic(nullptr, "PROJECTION"))
+					if (handle = semantic->Get(ShaderSemanticTable::PROJECTION))
 						effect->SetMatrix(handle, &camera->GetProjectionMatrix());
-					if (handle = effect->GetParameterBySemantic(nullptr, "VIEWPROJECTION"))
+					if (handle = semantic->Get(ShaderSemanticTable::VIEWPROJECTION))
 						effect->SetMatrix(handle, &camera->GetViewProjectionMatrix());
-					if (handle = effect->GetParameterBySemantic(nullptr, "FOGENABLE"))
+					if (handle = semantic->Get(ShaderSemanticTable::FOGENABLE))
 						effect->SetBool(handle, bFog);
 					if (bFog) {
-						if (handle = effect->GetParameterBySemantic(nullptr, "FOGCOLOR"))
+						if (handle = semantic->Get(ShaderSemanticTable::FOGCOLOR))
 							effect->SetFloatArray(handle, (FLOAT*)(&(fogParam->color)), 3);
-						if (handle = effect->GetParameterBySemantic(nullptr, "FOGDIST"))
+						if (handle = semantic->Get(ShaderSemanticTable::FOGDIST))
 							effect->SetFloatArray(handle, (FLOAT*)(&(fogParam->fogDist)), 2);
 					}
 				}
@@ -914,10 +966,10 @@ void RenderObjectNX::Render(D3DXMATRIX* matTransform) {
 		for (UINT iPass = 0; iPass < countPass; ++iPass) {
 			if (effect) effect->BeginPass(iPass);
 			if (bUseIndex) {
-				device->DrawIndexedPrimitive(typePrimitive_, 0, 0, countVertex, 0, countPrim);
+				graphics->DrawIndexedPrimitive(typePrimitive_, 0, 0, countVertex, 0, countPrim);
 			}
 			else {
-				device->DrawPrimitive(typePrimitive_, 0, countPrim);
+				graphics->DrawPrimitive(typePrimitive_, 0, countPrim);
 			}
 			if (effect) effect->EndPass();
 		}
@@ -1104,9 +1156,13 @@ void SpriteList2D::Render(const D3DXVECTOR2& angX, const D3DXVECTOR2& angY, cons
 		size_t countPrim = GetPrimitiveCount(countIndex);			//Max = 10922 quads
 
 		D3DXMATRIX matWorld;
-		if (bCloseVertexList_)
-			matWorld = RenderObject::CreateWorldMatrix2D(position_, scale_,
-				angX, angY, angZ, bCamera ? &camera->GetMatrix() : nullptr);
+		if (bCloseVertexList_) {
+			matWorld = _GetWorldMatrix(angX, angY, angZ, [&]() {
+				return RenderObject::CreateWorldMatrix2D(position_, scale_, angX, angY, angZ, nullptr);
+			});
+			if (bCamera)
+				D3DXMatrixMultiply(&matWorld, &matWorld, &camera->GetMatrix());
+		}
 
 		vertCopy_ = vertex_;
 		{
@@ -1157,8 +1213,10 @@ void SpriteList2D::Render(const D3DXVECTOR2& angX, const D3DXVECTOR2& angY, cons
 
 			UINT countPass = 1;
 			ID3DXEffect* effect = nullptr;
+			const ShaderSemanticTable* semantic = nullptr;
 			if (shader_ != nullptr) {
 				effect = shader_->GetEffect();
+				semantic = shader_->GetSemanticTable();
 
 				if (shader_->LoadTechnique()) {
 					shader_->LoadParameter();
@@ -1167,7 +1225,7 @@ void SpriteList2D::Render(const D3DXVECTOR2& angX, const D3DXVECTOR2& angY, cons
 						device->SetVertexDeclaration(shaderLib->GetVertexDeclarationTLX());
 
 						D3DXHANDLE handle = nullptr;
-						if (handle = effect->GetParameterBySemantic(nullptr, "WORLD")) {
+						if (handle = semantic->Get(ShaderSemanticTable::WORLD)) {
 							if (bCloseVertexList_)
 								effect->SetMatrix(handle, &matWorld);
 							else if (bCamera)
@@ -1175,7 +1233,7 @@ void SpriteList2D::Render(const D3DXVECTOR2& angX, const D3DXVECTOR2& angY, cons
 							else
 								effect->SetMatrix(handle, &camera3D->GetIdentity());
 						}
-						if (handle = effect->GetParameterBySemantic(nullptr, "VIEWPROJECTION")) {
+						if (handle = semantic->Get(ShaderSemanticTable::VIEWPROJECTION)) {
 							effect->SetMatrix(handle, &graphics->GetViewPortMatrix());
 						}
 					}
@@ -1185,7 +1243,7 @@ void SpriteList2D::Render(const D3DXVECTOR2& angX, const D3DXVECTOR2& angY, cons
 			}
 			for (UINT iPass = 0; iPass < countPass; ++iPass) {
 				if (effect) effect->BeginPass(iPass);
-				device->DrawIndexedPrimitive(typePrimitive_, 0, 0, countVertex, 0, countPrim);
+				graphics->DrawIndexedPrimitive(typePrimitive_, 0, 0, countVertex, 0, countPrim);
 				if (effect) effect->EndPass();
 			}
 			if (effect) effect->End();
@@ -1233,8 +1291,10 @@ void SpriteList2D::AddVertex(const D3DXVECTOR2& angX, const D3DXVECTOR2& angY, c
 	float width = texture_->GetWidth();
 	float height = texture_->GetHeight();
 
-	D3DXMATRIX matWorld = RenderObject::CreateWorldMatrix2D(position_, scale_,
-		angX, angY, angZ, nullptr);
+	//Same matrix as Render uses for a closed list
+	const D3DXMATRIX& matWorld = _GetWorldMatrix(angX, angY, angZ, [&]() {
+		return RenderObject::CreateWorldMatrix2D(position_, scale_, angX, angY, angZ, nullptr);
+	});
 
 	int* ptrSrc = reinterpret_cast<int*>(&rcSrc_);
 	double* ptrDst = reinterpret_cast<double*>(&rcDest_);
@@ -1319,8 +1379,16 @@ void Sprite3D::Render() {
 void Sprite3D::Render(const D3DXVECTOR2& angX, const D3DXVECTOR2& angY, const D3DXVECTOR2& angZ) {
 	D3DXMATRIX matWorld;
 	if (!disableMatrixTransform_) {
-		matWorld = RenderObject::CreateWorldMatrixSprite3D(position_, scale_,
-			angX, angY, angZ, matRelative_.get(), bBillboard_);
+		auto _Build = [&]() {
+			return RenderObject::CreateWorldMatrixSprite3D(position_, scale_,
+				angX, angY, angZ, matRelative_.get(), bBillboard_);
+		};
+		if (bBillboard_) {
+			//Follows the camera, can't be cached
+			matWorld = _Build();
+			_CountWorldMatrix(true);
+		}
+		else matWorld = _GetWorldMatrix(angX, angY, angZ, _Build);
 	}
 
 	RenderObjectLX::Render(matWorld);
@@ -1638,12 +1706,15 @@ void ParticleRenderer2D::Render() {
 		{
 			UINT countPass = 1;
 			ID3DXEffect* effect = nullptr;
+			const ShaderSemanticTable* semantic = nullptr;
 
 			if (shader_) {
 				effect = shader_->GetEffect();
+				semantic = shader_->GetSemanticTable();
 			}
 			else {
 				effect = shaderManager->GetInstancing2DShader();
+				semantic = shaderManager->GetInstancing2DSemantic();
 				effect->SetTechnique(texture_ ? (dxObjParent_->GetBlendType() == MODE_BLEND_ALPHA_INV ?
 					"RenderInv" : "Render") : "RenderNoTexture");
 			}
@@ -1652,7 +1723,7 @@ void ParticleRenderer2D::Render() {
 
 			auto _SetParam = [&]() {
 				D3DXHANDLE handle = nullptr;
-				if (handle = effect->GetParameterBySemantic(nullptr, "WORLDVIEWPROJ")) {
+				if (handle = semantic->Get(ShaderSemanticTable::WORLDVIEWPROJ)) {
 					D3DXMATRIX mat;
 					D3DXMatrixMultiply(&mat, &camera->GetMatrix(), &graphics->GetViewPortMatrix());
 					effect->SetMatrix(handle, &mat);
@@ -1674,12 +1745,12 @@ void ParticleRenderer2D::Render() {
 				effect->BeginPass(iPass);
 
 #ifdef __L_USE_HWINSTANCING
-				device->DrawIndexedPrimitive(typePrimitive_, 0, 0, countVertex, 0, countPrim);
+				graphics->DrawIndexedPrimitive(typePrimitive_, 0, 0, countVertex, 0, countPrim);
 #else
 				for (UINT nInst = 0; nInst < countRenderInstance; ++nInst) {
 					device->SetStreamSource(1, instanceBuffer->GetBuffer(), 
 						nInst * sizeof(VERTEX_INSTANCE), 0);
-					device->DrawIndexedPrimitive(typePrimitive_, 0, 0, countVertex, 0, countPrim);
+					graphics->DrawIndexedPrimitive(typePrimitive_, 0, 0, countVertex, 0, countPrim);
 				}
 #endif
 
@@ -1764,12 +1835,15 @@ void ParticleRenderer3D::Render() {
 		{
 			UINT countPass = 1;
 			ID3DXEffect* effect = nullptr;
+			const ShaderSemanticTable* semantic = nullptr;
 
 			if (shader_) {
 				effect = shader_->GetEffect();
+				semantic = shader_->GetSemanticTable();
 			}
 			else {
 				effect = shaderManager->GetInstancing3DShader();
+				semantic = shaderManager->GetInstancing3DSemantic();
 				effect->SetTechnique(texture_ ? (dxObjParent_->GetBlendType() == MODE_BLEND_ALPHA_INV ?
 					"RenderInv" : "Render") : "RenderNoTexture");
 			}
@@ -1783,23 +1857,23 @@ void ParticleRenderer3D::Render() {
 				graphics->SetFogEnable(false);
 
 				D3DXHANDLE handle = nullptr;
-				if (handle = effect->GetParameterBySemantic(nullptr, "WORLD")) {
+				if (handle = semantic->Get(ShaderSemanticTable::WORLD)) {
 					if (bBillboard_)
 						effect->SetMatrix(handle, &camera->GetViewTransposedMatrix());
 					else effect->SetMatrix(handle, &camera->GetIdentity());
 				}
-				if (handle = effect->GetParameterBySemantic(nullptr, "VIEW"))
+				if (handle = semantic->Get(ShaderSemanticTable::VIEW))
 					effect->SetMatrix(handle, &camera->GetViewMatrix());
-				if (handle = effect->GetParameterBySemantic(nullptr, "PROJECTION"))
+				if (handle = semantic->Get(ShaderSemanticTable::PROJECTION))
 					effect->SetMatrix(handle, &camera->GetProjectionMatrix());
-				if (handle = effect->GetParameterBySemantic(nullptr, "VIEWPROJECTION"))
+				if (handle = semantic->Get(ShaderSemanticTable::VIEWPROJECTION))
 					effect->SetMatrix(handle, &camera->GetViewProjectionMatrix());
-				if (handle = effect->GetParameterBySemantic(nullptr, "FOGENABLE"))
+				if (handle = semantic->Get(ShaderSemanticTable::FOGENABLE))
 					effect->SetBool(handle, bFog);
 				if (bFog) {
-					if (handle = effect->GetParameterBySemantic(nullptr, "FOGCOLOR"))
+					if (handle = semantic->Get(ShaderSemanticTable::FOGCOLOR))
 						effect->SetFloatArray(handle, (FLOAT*)(&(fogParam->color)), 3);
-					if (handle = effect->GetParameterBySemantic(nullptr, "FOGDIST"))
+					if (handle = semantic->Get(ShaderSemanticTable::FOGDIST))
 						effect->SetFloatArray(handle, (FLOAT*)(&(fogParam->fogDist)), 2);
 				}
 			};
@@ -1819,12 +1893,12 @@ void ParticleRenderer3D::Render() {
 				effect->BeginPass(iPass);
 
 #ifdef __L_USE_HWINSTANCING
-				device->DrawIndexedPrimitive(typePrimitive_, 0, 0, countVertex, 0, countPrim);
+				graphics->DrawIndexedPrimitive(typePrimitive_, 0, 0, countVertex, 0, countPrim);
 #else
 				for (UINT nInst = 0; nInst < countRenderInstance; ++nInst) {
 					device->SetStreamSource(1, instanceBuffer->GetBuffer(),
 						nInst * sizeof(VERTEX_INSTANCE), 0);
-					device->DrawIndexedPrimitive(typePrimitive_, 0, 0, countVertex, 0, countPrim);
+					graphics->DrawIndexedPrimitive(typePrimitive_, 0, 0, countVertex, 0, countPrim);
 				}
 #endif
 
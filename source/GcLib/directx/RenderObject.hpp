@@ -59,6 +59,17 @@ namespace directx {
 		bool disableMatrixTransform_;
 		bool bVertexShaderMode_;
 		bool flgUseVertexBufferMode_;
+
+		//World matrix (without the 2D camera), rebuilt only when one of its inputs changes
+		bool bWorldDirty_;
+		D3DXVECTOR2 angWorld_[3];
+		D3DXMATRIX matWorld_;
+
+		void _SetWorldDirty() { bWorldDirty_ = true; }
+		static void _CountWorldMatrix(bool bBuild);
+		template<class FBuild>
+		const D3DXMATRIX& _GetWorldMatrix(const D3DXVECTOR2& angX, const D3DXVECTOR2& angY, 
+			const D3DXVECTOR2& angZ, FBuild&& funcBuild);
 	public:
 		RenderObject();
 		virtual ~RenderObject();
@@ -74,7 +85,7 @@ namespace directx {
 		shared_ptr<Texture> GetTexture() { return texture_; }
 		void SetRenderTarget(shared_ptr<Texture> texture) { renderTarget_ = texture; }
 
-		void SetRelativeMatrix(shared_ptr<D3DXMATRIX>& mat) { matRelative_ = mat; }
+		void SetRelativeMatrix(shared_ptr<D3DXMATRIX>& mat);
 
 		static D3DXMATRIX CreateWorldMatrix(const D3DXVECTOR3& position, const D3DXVECTOR3& scale,
 			const D3DXVECTOR2& angleX, const D3DXVECTOR2& angleY, const D3DXVECTOR2& angleZ,
@@ -99,8 +110,8 @@ namespace directx {
 		void SetY(float y);
 		void SetZ(float z);
 
-		void SetAngle(const D3DXVECTOR3& angle) { angle_ = angle; }
-		void SetAngleXYZ(float angx = 0.0f, float angy = 0.0f, float angz = 0.0f) { angle_.x = angx; angle_.y = angy; angle_.z = angz; }
+		void SetAngle(const D3DXVECTOR3& angle) { SetAngleXYZ(angle.x, angle.y, angle.z); }
+		void SetAngleXYZ(float angx = 0.0f, float angy = 0.0f, float angz = 0.0f);
 
 		void SetScale(const D3DXVECTOR3& scale) { SetScaleXYZ(scale.x, scale.y, scale.z); }
 		void SetScaleXYZ(float sx = 1.0f, float sy = 1.0f, float sz = 1.0f);
@@ -108,7 +119,10 @@ namespace directx {
 		bool IsCoordinate2D() { return bCoordinate2D_; }
 		void SetCoordinate2D(bool b) { bCoordinate2D_ = b; }
 
-		void SetDisableMatrixTransformation(bool b) { disableMatrixTransform_ = b; }
+		void SetDisableMatrixTransformation(bool b) {
+			if (disableMatrixTransform_ != b) _SetWorldDirty();
+			disableMatrixTransform_ = b;
+		}
 		void SetVertexShaderRendering(bool b) { bVertexShaderMode_ = b; }
 
 		DirectionalLightingState* GetLighting() { return &lightParameter_; }
@@ -117,6 +131,23 @@ namespace directx {
 		void SetShader(shared_ptr<Shader> shader) { shader_ = shader; }
 	};
 
+	template<class FBuild>
+	const D3DXMATRIX& RenderObject::_GetWorldMatrix(const D3DXVECTOR2& angX, const D3DXVECTOR2& angY,
+		const D3DXVECTOR2& angZ, FBuild&& funcBuild)
+	{
+		//Angles are compared directly since callers pass them in precomputed
+		bool bBuild = bWorldDirty_ || angX != angWorld_[0] || angY != angWorld_[1] || angZ != angWorld_[2];
+		if (bBuild) {
+			matWorld_ = funcBuild();
+			angWorld_[0] = angX;
+			angWorld_[1] = angY;
+			angWorld_[2] = angZ;
+			bWorldDirty_ = false;
+		}
+		_CountWorldMatrix(bBuild);
+		return matWorld_;
+	}
+
 	//****************************************************************************
 	//RenderObjectPrimitive
 	//	ObjRender with vertices
@@ -336,7 +367,10 @@ namespace directx {
 		void SetVertex(const DxRect<int>& rcSrc, const DxRect<double>& rcDest, D3DCOLOR color = D3DCOLOR_ARGB(255, 255, 255, 255));
 		void SetSourceDestRect(const DxRect<double>& rcSrc);
 		void SetVertex(const DxRect<double>& rcSrcDst, D3DCOLOR color = D3DCOLOR_ARGB(255, 255, 255, 255));
-		void SetBillboardEnable(bool bEnable) { bBillboard_ = bEnable; }
+		void SetBillboardEnable(bool bEnable) {
+			if (bBillboard_ != bEnable) _SetWorldDirty();
+			bBillboard_ = bEnable;
+		}
 	};
 
 	//****************************************************************************
@@ -535,6 +569,8 @@ namespace directx {
 
 		shared_ptr<DxMeshInfoPanel> panelInfo_;
 
+		std::wstring pathCache_;
+
 		void _AddMeshData(const std::wstring& name, shared_ptr<DxMeshData> data);
 		shared_ptr<DxMeshData> _GetMeshData(const std::wstring& name);
 		void _ReleaseMeshData(const std::wstring& name);
@@ -556,6 +592,10 @@ namespace directx {
 		virtual void CallFromLoadThread(shared_ptr<gstd::FileManager::LoadThreadEvent> event);
 
 		void SetInfoPanel(shared_ptr<DxMeshInfoPanel> panel) { panelInfo_ = panel; }
+
+		//Where parsed meshes get cached, caching is off while it's empty
+		void SetCacheDirectory(const std::wstring& path) { pathCache_ = path; }
+		const std::wstring& GetCacheDirectory() { return pathCache_; }
 	};
 
 	class DxMeshInfoPanel : public gstd::ILoggerPanel {
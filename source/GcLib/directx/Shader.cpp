@@ -495,6 +495,7 @@ bool ShaderManager::_CreateFromFile(const std::wstring& path, shared_ptr<ShaderD
 		}
 		else {
 			dest->manager_ = this;
+			dest->semantic_.Resolve(dest->effect_);
 			dest->name_ = path;
 			dest->bLoad_ = true;
 
@@ -546,6 +547,7 @@ bool ShaderManager::_CreateFromText(const std::wstring& name, const std::string&
 		}
 		else {
 			dest->manager_ = this;
+			dest->semantic_.Resolve(dest->effect_);
 			dest->name_ = name;
 			dest->bLoad_ = true;
 			dest->bText_ = true;
@@ -587,6 +589,7 @@ bool ShaderManager::_CreateCloneFromEffect(ID3DXEffect* effect, shared_ptr<Shade
 		}
 		else {
 			dest->manager_ = this;
+			dest->semantic_.Resolve(dest->effect_);
 			dest->name_ = shaderID;
 			dest->bLoad_ = true;
 			dest->bText_ = true;
@@ -5,6 +5,7 @@
 #include "DxConstant.hpp"
 #include "DirectGraphics.hpp"
 #include "Texture.hpp"
+#include "HLSL.hpp"
 
 namespace directx {
 	class ShaderManager;
@@ -27,6 +28,8 @@ namespace directx {
 		std::wstring name_;
 		bool bLoad_;
 		bool bText_;
+
+		ShaderSemanticTable semantic_;
 	public:
 		ShaderData();
 		virtual ~ShaderData();
@@ -158,6 +161,7 @@ namespace directx {
 
 		shared_ptr<ShaderData> GetData() { return data_; }
 		ID3DXEffect* GetEffect();
+		const ShaderSemanticTable* GetSemanticTable() { return data_ ? &data_->semantic_ : nullptr; }
 
 		bool CreateFromFile(const std::wstring& path);
 		bool CreateFromText(const std::wstring& name, const std::string& source);
@@ -6,6 +6,177 @@
 using namespace gstd;
 using namespace directx;
 
+//****************************************************************************
+//TextureDecoder
+//****************************************************************************
+D3DXIMAGE_FILEFORMAT TextureDecoder::GetFileFormat(const std::wstring& path) {
+	std::wstring ext = PathProperty::GetFileExtension(path);
+	std::transform(ext.begin(), ext.end(), ext.begin(), ::towlower);
+
+	//Only the ones D3DX would've read as well
+	static const std::map<std::wstring, D3DXIMAGE_FILEFORMAT> mapFormat = {
+		{ L".png", D3DXIFF_PNG },
+		{ L".jpg", D3DXIFF_JPG }, { L".jpeg", D3DXIFF_JPG },
+		{ L".bmp", D3DXIFF_BMP }, { L".dib", D3DXIFF_DIB },
+	};
+	auto itr = mapFormat.find(ext);
+	return itr != mapFormat.end() ? itr->second : D3DXIFF_FORCE_DWORD;
+}
+bool TextureDecoder::Decode(const void* data, size_t size, Image* dst) {
+	//Worker threads join the process' MTA for the decode
+	HRESULT hrCom = ::CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+
+	IWICImagingFactory* pFactory = nullptr;
+	IWICStream* pStream = nullptr;
+	IWICBitmapDecoder* pDecoder = nullptr;
+	IWICBitmapFrameDecode* pFrame = nullptr;
+	IWICFormatConverter* pConverter = nullptr;
+
+	HRESULT hr = ::CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&pFactory));
+	if (SUCCEEDED(hr))
+		hr = pFactory->CreateStream(&pStream);
+	if (SUCCEEDED(hr))
+		hr = pStream->InitializeFromMemory((BYTE*)data, size);
+	if (SUCCEEDED(hr))
+		hr = pFactory->CreateDecoderFromStream(pStream, nullptr, WICDecodeMetadataCacheOnDemand, &pDecoder);
+	if (SUCCEEDED(hr))
+		hr = pDecoder->GetFrame(0, &pFrame);
+	if (SUCCEEDED(hr))
+		hr = pFactory->CreateFormatConverter(&pConverter);
+	if (SUCCEEDED(hr)) {
+		//Straight alpha BGRA, same layout as D3DFMT_A8R8G8B8
+		hr = pConverter->Initialize(pFrame, GUID_WICPixelFormat32bppBGRA,
+			WICBitmapDitherTypeNone, nullptr, 0.0, WICBitmapPaletteTypeCustom);
+	}
+	if (SUCCEEDED(hr))
+		hr = pConverter->GetSize(&dst->width, &dst->height);
+	if (SUCCEEDED(hr)) {
+		dst->pixels.resize((size_t)dst->width * dst->height);
+		hr = pConverter->CopyPixels(nullptr, dst->width * sizeof(D3DCOLOR),
+			dst->pixels.size() * sizeof(D3DCOLOR), (BYTE*)dst->pixels.data());
+	}
+
+	ptr_release(pConverter);
+	ptr_release(pFrame);
+	ptr_release(pDecoder);
+	ptr_release(pStream);
+	ptr_release(pFactory);
+
+	if (SUCCEEDED(hrCom))
+		::CoUninitialize();
+	return SUCCEEDED(hr);
+}
+shared_ptr<TextureDecoder::Image> TextureDecoder::DecodeFile(const std::wstring& path) {
+	shared_ptr<FileReader> reader = FileManager::GetBase()->GetFileReader(path);
+	if (reader == nullptr || !reader->Open()) return nullptr;
+
+	std::string source = reader->ReadAllString();
+
+	shared_ptr<Image> res = std::make_shared<Image>();
+	if (!Decode(source.c_str(), source.size(), res.get())) return nullptr;
+	return res;
+}
+std::wstring TextureDecoder::BenchmarkDirectory(const std::wstring& dir) {
+	//Read everything up front, only the decode is timed
+	std::vector<std::string> listSource;
+	size_t totalSize = 0;
+	for (auto& entry : stdfs::recursive_directory_iterator(dir)) {
+		if (!entry.is_regular_file() || !IsSupported(entry.path().wstring())) continue;
+
+		std::ifstream stream(entry.path(), std::ios::binary);
+		std::string source((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+		totalSize += source.size();
+		listSource.push_back(std::move(source));
+	}
+
+	auto timeStart = std::chrono::steady_clock::now();
+	size_t countFail = 0;
+	for (auto& source : listSource) {
+		Image image;
+		if (!Decode(source.c_str(), source.size(), &image))
+			++countFail;
+	}
+	auto timeSerial = std::chrono::steady_clock::now() - timeStart;
+
+	size_t countThread = 0;
+	timeStart = std::chrono::steady_clock::now();
+	{
+		TextureDecodePool pool;
+		countThread = pool.GetThreadCount();
+
+		std::vector<std::future<TextureDecodePool::Result>> listFuture;
+		for (auto& source : listSource) {
+			const std::string* pSource = &source;
+			listFuture.push_back(pool.Add([pSource]() {
+				shared_ptr<Image> res = std::make_shared<Image>();
+				if (!Decode(pSource->c_str(), pSource->size(), res.get())) return shared_ptr<Image>();
+				return res;
+			}));
+		}
+		for (auto& future : listFuture)
+			future.wait();
+	}
+	auto timePool = std::chrono::steady_clock::now() - timeStart;
+
+	using ms = std::chrono::duration<double, std::milli>;
+	return StringUtility::Format(
+		L"Decoded %u files (%.2f MB, %u failed)\r\n"
+		L"    Serial: %.2f ms\r\n"
+		L"    Pool (%u threads): %.2f ms",
+		listSource.size(), totalSize / (1024.0 * 1024.0), countFail,
+		ms(timeSerial).count(), countThread, ms(timePool).count());
+}
+
+//****************************************************************************
+//TextureDecodePool
+//****************************************************************************
+TextureDecodePool::TextureDecodePool() {
+	bStop_ = false;
+
+	size_t countThread = std::max(std::thread::hardware_concurrency(), 1U);
+	listThread_.reserve(countThread);
+	for (size_t i = 0; i < countThread; ++i)
+		listThread_.emplace_back(&TextureDecodePool::_Run, this);
+}
+TextureDecodePool::~TextureDecodePool() {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		bStop_ = true;
+	}
+	cvTask_.notify_all();
+	for (auto& thread : listThread_)
+		thread.join();
+}
+void TextureDecodePool::_Run() {
+	while (true) {
+		std::packaged_task<Result()> task;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			cvTask_.wait(lock, [&]() { return bStop_ || !listTask_.empty(); });
+			if (listTask_.empty()) return;
+
+			task = std::move(listTask_.front());
+			listTask_.pop_front();
+		}
+		task();
+	}
+}
+std::future<TextureDecodePool::Result> TextureDecodePool::Add(std::function<Result()> func) {
+	std::packaged_task<Result()> task(std::move(func));
+	std::future<Result> res = task.get_future();
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		listTask_.push_back(std::move(task));
+	}
+	cvTask_.notify_one();
+	return res;
+}
+std::future<TextureDecodePool::Result> TextureDecodePool::AddFile(const std::wstring& path) {
+	return Add([path]() {
+		return TextureDecoder::DecodeFile(path);
+	});
+}
+
 //****************************************************************************
 //TextureData
 //****************************************************************************
@@ -261,6 +432,9 @@ TextureManager::~TextureManager() {
 
 	FileManager::GetBase()->RemoveLoadThreadListener(this);
 
+	//Finishes what's still queued
+	poolDecode_ = nullptr;
+
 	panelInfo_ = nullptr;
 	thisBase_ = nullptr;
 }
@@ -276,6 +450,7 @@ bool TextureManager::Initialize() {
 	Add(TARGET_TRANSITION, texTransition);
 
 	FileManager::GetBase()->AddLoadThreadListener(this);
+	poolDecode_.reset(new TextureDecodePool());
 
 	return res;
 }
@@ -456,6 +631,54 @@ void TextureManager::__CreateFromFile(shared_ptr<TextureData>& dst, const std::w
 	dst->name_ = path;
 	dst->type_ = TextureData::Type::TYPE_TEXTURE;
 }
+void TextureManager::__CreateFromImage(shared_ptr<TextureData>& dst, const std::wstring& path, const TextureDecoder::Image& image) {
+	IDirect3DDevice9* device = DirectGraphics::GetBase()->GetDevice();
+
+	//Same sizing and mip chain as D3DXCreateTextureFromFileInMemoryEx in __CreateFromFile
+	UINT width = image.width;
+	UINT height = image.height;
+	if (!dst->useNonPowerOfTwo_) {
+		width = Math::GetNextPow2(width);
+		height = Math::GetNextPow2(height);
+	}
+
+	IDirect3DTexture9* pTexture = nullptr;
+	HRESULT hr = D3DXCreateTexture(device, width, height, dst->useMipMap_ ? D3DX_DEFAULT : 1, 0,
+		D3DFMT_A8R8G8B8, D3DPOOL_MANAGED, &pTexture);
+	if (FAILED(hr))
+		throw wexception("D3DXCreateTexture failure.");
+
+	IDirect3DSurface9* pSurface = nullptr;
+	hr = pTexture->GetSurfaceLevel(0, &pSurface);
+	if (SUCCEEDED(hr)) {
+		RECT rcSrc = { 0, 0, (LONG)image.width, (LONG)image.height };
+		hr = D3DXLoadSurfaceFromMemory(pSurface, nullptr, nullptr, image.pixels.data(), D3DFMT_A8R8G8B8,
+			image.width * sizeof(D3DCOLOR), nullptr, &rcSrc, D3DX_FILTER_BOX, 0x00000000);
+		ptr_release(pSurface);
+	}
+	if (SUCCEEDED(hr) && dst->useMipMap_)
+		hr = D3DXFilterTexture(pTexture, nullptr, 0, D3DX_DEFAULT);
+	if (FAILED(hr)) {
+		ptr_release(pTexture);
+		throw wexception("D3DXLoadSurfaceFromMemory failure.");
+	}
+	dst->pTexture_ = pTexture;
+
+	D3DXIMAGE_INFO* info = &dst->infoImage_;
+	ZeroMemory(info, sizeof(D3DXIMAGE_INFO));
+	info->Width = image.width;
+	info->Height = image.height;
+	info->Depth = 1;
+	info->MipLevels = 1;
+	info->Format = D3DFMT_A8R8G8B8;
+	info->ResourceType = D3DRTYPE_TEXTURE;
+	info->ImageFileFormat = TextureDecoder::GetFileFormat(path);
+	dst->CalculateResourceSize();
+
+	dst->manager_ = this;
+	dst->name_ = path;
+	dst->type_ = TextureData::Type::TYPE_TEXTURE;
+}
 bool TextureManager::_CreateFromFile(shared_ptr<TextureData>& dst, const std::wstring& path, bool genMipmap, bool flgNonPowerOfTwo) {
 	DirectGraphics* graphics = DirectGraphics::GetBase();
 
@@ -677,6 +900,10 @@ shared_ptr<Texture> TextureManager::CreateFromFileInLoadThread(const std::wstrin
 					}
 				}
 
+				//Decode on a worker ahead of time, the load thread only has to upload it
+				if (poolDecode_ && TextureDecoder::IsSupported(path))
+					data->futureDecode_ = poolDecode_->AddFile(path);
+
 				res->data_ = data;
 				mapTextureData_[path] = data;
 				{
@@ -708,7 +935,15 @@ void TextureManager::CallFromLoadThread(shared_ptr<FileManager::LoadThreadEvent>
 
 		std::wstring pathReduce = PathProperty::ReduceModuleDirectory(path);
 		try {
-			__CreateFromFile(data, path, data->useMipMap_, data->useNonPowerOfTwo_);
+			shared_ptr<TextureDecoder::Image> image;
+			if (data->futureDecode_.valid())
+				image = data->futureDecode_.get();
+
+			//Falls back to D3DX if the decode failed, for its error reporting
+			if (image)
+				__CreateFromImage(data, path, *image);
+			else
+				__CreateFromFile(data, path, data->useMipMap_, data->useNonPowerOfTwo_);
 
 			data->bReady_ = true;
 
@@ -772,6 +1007,283 @@ std::map<std::wstring, shared_ptr<TextureData>>::iterator TextureManager::IsData
 	return res;
 }
 
+#if defined(DNH_PROJ_EXECUTOR)
+//****************************************************************************
+//TextureAtlas
+//****************************************************************************
+TextureAtlas::TextureAtlas() {
+	sizePage_ = 0;
+	keyState_ = 0;
+	bFreed_ = false;
+}
+TextureAtlas::~TextureAtlas() {
+	Clear();
+}
+void TextureAtlas::Initialize(const std::wstring& pathCache) {
+	Clear();
+	pathCache_ = pathCache;
+
+	D3DCAPS9 caps;
+	ZeroMemory(&caps, sizeof(D3DCAPS9));
+	DirectGraphics::GetBase()->GetDevice()->GetDeviceCaps(&caps);
+	sizePage_ = std::min<LONG>(PAGE_SIZE, std::min(caps.MaxTextureWidth, caps.MaxTextureHeight));
+}
+void TextureAtlas::Clear() {
+	listPage_.clear();
+	keyState_ = 0;
+	bFreed_ = false;
+	mapOwnerSlot_.clear();
+}
+bool TextureAtlas::_AddPage() {
+	IDirect3DDevice9* device = DirectGraphics::GetBase()->GetDevice();
+
+	IDirect3DTexture9* pTexture = nullptr;
+	HRESULT hr = device->CreateTexture(sizePage_, sizePage_, 1,
+		0, D3DFMT_A8R8G8B8, D3DPOOL_MANAGED, &pTexture, nullptr);
+	if (FAILED(hr)) return false;
+
+	//Padding has to stay transparent
+	D3DLOCKED_RECT lock;
+	if (FAILED(pTexture->LockRect(0, &lock, nullptr, 0))) {
+		ptr_release(pTexture);
+		return false;
+	}
+	for (LONG iy = 0; iy < sizePage_; ++iy)
+		ZeroMemory((BYTE*)lock.pBits + lock.Pitch * iy, sizePage_ * sizeof(D3DCOLOR));
+	pTexture->UnlockRect(0);
+
+	Page page;
+	page.texture = std::make_shared<Texture>();
+	page.texture->SetTexture(pTexture);
+	page.packer.Initialize(sizePage_, sizePage_);
+	listPage_.push_back(MOVE(page));
+
+	return true;
+}
+void TextureAtlas::_FreeOwner(const std::wstring& owner) {
+	auto itrFind = mapOwnerSlot_.find(owner);
+	if (itrFind == mapOwnerSlot_.end()) return;
+
+	for (const Slot& slot : itrFind->second) {
+		Page& page = listPage_[slot.page];
+
+		//Padding of whatever goes here next has to be transparent again
+		RECT rcLock = slot.rcPacked.AsRect();
+		D3DLOCKED_RECT lock;
+		if (SUCCEEDED(page.texture->GetD3DTexture()->LockRect(0, &lock, &rcLock, 0))) {
+			for (LONG iy = 0; iy < slot.rcPacked.GetHeight(); ++iy)
+				ZeroMemory((BYTE*)lock.pBits + lock.Pitch * iy, slot.rcPacked.GetWidth() * sizeof(D3DCOLOR));
+			page.texture->GetD3DTexture()->UnlockRect(0);
+			page.packer.Free(slot.rcPacked);
+		}
+	}
+
+	mapOwnerSlot_.erase(itrFind);
+	bFreed_ = true;
+}
+bool TextureAtlas::_LoadLayout(const std::wstring& path, const ByteBuffer& key, std::vector<Placement>& listPlace) {
+	RecordBuffer record;
+	if (!File::IsExists(path) || !record.ReadFromFile(path, CACHE_VERSION, RecordBuffer::HEADER))
+		return false;
+
+	//Guards against hash collisions
+	optional<ByteBuffer> bufKey = record.GetRecordAsByteBuffer("key");
+	if (!bufKey || bufKey->GetSize() != key.GetSize()
+		|| memcmp(bufKey->GetPointer(), key.GetPointer(), key.GetSize()) != 0)
+		return false;
+
+	size_t countPlace = listPlace.size();
+	if (record.GetEntrySize("place") != countPlace * sizeof(Placement)) return false;
+	std::vector<Placement> listRead(countPlace);
+	if (countPlace > 0 && !record.GetRecord("place", listRead.data(), countPlace * sizeof(Placement)))
+		return false;
+
+	//Skylines of every page after the layout was packed
+	size_t countPage = record.GetRecordAsInteger("page", 0);
+	if (countPage < listPage_.size()) return false;
+	std::vector<RectPacker> listPacker(countPage, RectPacker(sizePage_, sizePage_));
+	for (size_t iPage = 0; iPage < countPage; ++iPage) {
+		std::string keyNode = "node" + std::to_string(iPage);
+		size_t sizeNode = record.GetEntrySize(keyNode);
+		if (sizeNode == 0 || sizeNode % sizeof(RectPacker::Node) != 0) return false;
+
+		std::vector<RectPacker::Node> listNode(sizeNode / sizeof(RectPacker::Node));
+		record.GetRecord(keyNode, listNode.data(), sizeNode);
+		if (!listPacker[iPage].SetNodeList(listNode)) return false;
+	}
+	for (const Placement& place : listRead) {
+		if (place.page != UINT32_MAX && place.page >= countPage) return false;
+	}
+
+	while (listPage_.size() < countPage) {
+		if (!_AddPage()) return false;
+	}
+	for (size_t iPage = 0; iPage < countPage; ++iPage)
+		listPage_[iPage].packer = listPacker[iPage];
+
+	listPlace = MOVE(listRead);
+	return true;
+}
+void TextureAtlas::_SaveLayout(const std::wstring& path, const ByteBuffer& key, const std::vector<Placement>& listPlace) {
+	RecordBuffer record;
+	record.SetRecord("key", const_cast<char*>(key.GetPointer()), key.GetSize());
+	record.SetRecord("place", (LPVOID)listPlace.data(), listPlace.size() * sizeof(Placement));
+
+	record.SetRecordAsInteger("page", listPage_.size());
+	for (size_t iPage = 0; iPage < listPage_.size(); ++iPage) {
+		const std::vector<RectPacker::Node>& listNode = listPage_[iPage].packer.GetNodeList();
+		record.SetRecord("node" + std::to_string(iPage),
+			(LPVOID)listNode.data(), listNode.size() * sizeof(RectPacker::Node));
+	}
+
+	File::CreateFileDirectory(path);
+	if (!record.WriteToFile(path, CACHE_VERSION, RecordBuffer::HEADER))
+		Logger::WriteTop(L"TextureAtlas: Failed to write layout cache. [" + PathProperty::ReduceModuleDirectory(path) + L"]");
+}
+void TextureAtlas::AddSource(const std::wstring& owner, shared_ptr<Texture> source, std::vector<Region>& listRegion) {
+	for (Region& region : listRegion)
+		region.page = PAGE_NONE;
+	if (sizePage_ <= PADDING * 2 || source == nullptr) return;
+
+	//Only a reload by the same owner replaces its rects
+	_FreeOwner(owner);
+
+	//Render targets change every frame, a copy would go stale
+	if (source->GetType() == TextureData::TYPE_RENDER_TARGET) return;
+
+	IDirect3DTexture9* pSrcTexture = source->GetD3DTexture();
+	if (pSrcTexture == nullptr) return;
+
+	//Images that got rescaled on load can't be copied pixel for pixel
+	LONG width = source->GetWidth();
+	LONG height = source->GetHeight();
+	{
+		D3DSURFACE_DESC desc;
+		pSrcTexture->GetLevelDesc(0, &desc);
+		if (desc.Width != width || desc.Height != height) return;
+	}
+
+	//Frames often share rects, each distinct one is packed once
+	std::vector<DxRect<LONG>> listRect;
+	std::vector<size_t> listRegionRect(listRegion.size(), SIZE_MAX);
+	{
+		std::map<std::array<LONG, 4>, size_t> mapRect;
+		for (size_t iRegion = 0; iRegion < listRegion.size(); ++iRegion) {
+			const DxRect<LONG>& rc = listRegion[iRegion].rcSrc;
+
+			//Flipped or out-of-bounds rects rely on the source's addressing
+			if (rc.left < 0 || rc.top < 0 || rc.right > width || rc.bottom > height) continue;
+			if (rc.GetWidth() <= 0 || rc.GetHeight() <= 0) continue;
+			if (rc.GetWidth() + PADDING * 2 > sizePage_ || rc.GetHeight() + PADDING * 2 > sizePage_) continue;
+
+			auto itrRect = mapRect.insert({ { rc.left, rc.top, rc.right, rc.bottom }, listRect.size() });
+			if (itrRect.second)
+				listRect.push_back(rc);
+			listRegionRect[iRegion] = itrRect.first->second;
+		}
+	}
+	if (listRect.empty()) return;
+
+	ByteBuffer key;
+	key.WriteValue<uint64_t>(keyState_);
+	key.WriteValue<int32_t>(sizePage_);
+	key.WriteValue<int32_t>(PADDING);
+	key.WriteString(source->GetName());
+	key.WriteValue<uint32_t>(listRect.size());
+	for (DxRect<LONG>& rc : listRect)
+		key.Write(&rc, sizeof(DxRect<LONG>));
+
+	size_t hash = std::_Hash_array_representation(key.GetPointer(), key.GetSize());
+	std::wstring pathLayout;
+	if (pathCache_.size() > 0 && !bFreed_)
+		pathLayout = pathCache_ + StringUtility::FormatToWide("%016llx.dat", (uint64_t)hash);
+
+	std::vector<Placement> listPlace(listRect.size(), Placement{ UINT32_MAX, 0, 0 });
+	if (pathLayout.empty() || !_LoadLayout(pathLayout, key, listPlace)) {
+		//Tallest first packs tighter, stable to keep the layout deterministic
+		std::vector<size_t> listOrder(listRect.size());
+		for (size_t i = 0; i < listOrder.size(); ++i)
+			listOrder[i] = i;
+		std::stable_sort(listOrder.begin(), listOrder.end(), [&](size_t a, size_t b) {
+			if (listRect[a].GetHeight() != listRect[b].GetHeight())
+				return listRect[a].GetHeight() > listRect[b].GetHeight();
+			return listRect[a].GetWidth() > listRect[b].GetWidth();
+		});
+
+		for (size_t iRect : listOrder) {
+			LONG wd = listRect[iRect].GetWidth() + PADDING * 2;
+			LONG ht = listRect[iRect].GetHeight() + PADDING * 2;
+
+			POINT pos;
+			size_t iPage = 0;
+			while (iPage < listPage_.size() && !listPage_[iPage].packer.Insert(wd, ht, &pos))
+				++iPage;
+			if (iPage == listPage_.size()) {
+				if (!_AddPage() || !listPage_.back().packer.Insert(wd, ht, &pos))
+					continue;
+			}
+			listPlace[iRect] = Placement{ (uint32_t)iPage, pos.x + PADDING, pos.y + PADDING };
+		}
+
+		if (pathLayout.size() > 0)
+			_SaveLayout(pathLayout, key, listPlace);
+	}
+	keyState_ = hash;
+
+	{
+		std::vector<Slot>& listSlot = mapOwnerSlot_[owner];
+		for (size_t iRect = 0; iRect < listRect.size(); ++iRect) {
+			const Placement& place = listPlace[iRect];
+			if (place.page == UINT32_MAX) continue;
+
+			const DxRect<LONG>& rc = listRect[iRect];
+			listSlot.push_back(Slot{ place.page, DxRect<LONG>(place.x - PADDING, place.y - PADDING,
+				place.x + rc.GetWidth() + PADDING, place.y + rc.GetHeight() + PADDING) });
+		}
+	}
+
+	//Copy the pixels over
+	{
+		IDirect3DSurface9* pSrcSurface = nullptr;
+		if (FAILED(pSrcTexture->GetSurfaceLevel(0, &pSrcSurface))) return;
+
+		for (size_t iRect = 0; iRect < listRect.size(); ++iRect) {
+			Placement& place = listPlace[iRect];
+			if (place.page == UINT32_MAX) continue;
+
+			const DxRect<LONG>& rc = listRect[iRect];
+			RECT rcSrc = rc.AsRect();
+			RECT rcDst = { place.x, place.y, place.x + rc.GetWidth(), place.y + rc.GetHeight() };
+
+			IDirect3DSurface9* pDstSurface = nullptr;
+			HRESULT hr = listPage_[place.page].texture->GetD3DTexture()->GetSurfaceLevel(0, &pDstSurface);
+			if (SUCCEEDED(hr)) {
+				hr = D3DXLoadSurfaceFromSurface(pDstSurface, nullptr, &rcDst,
+					pSrcSurface, nullptr, &rcSrc, D3DX_FILTER_NONE, 0);
+				ptr_release(pDstSurface);
+			}
+			if (FAILED(hr))
+				place.page = UINT32_MAX;	//Stays on the source texture
+		}
+
+		ptr_release(pSrcSurface);
+	}
+
+	for (size_t iRegion = 0; iRegion < listRegion.size(); ++iRegion) {
+		size_t iRect = listRegionRect[iRegion];
+		if (iRect == SIZE_MAX) continue;
+
+		const Placement& place = listPlace[iRect];
+		if (place.page == UINT32_MAX) continue;
+
+		Region& region = listRegion[iRegion];
+		region.page = place.page;
+		region.rcAtlas = DxRect<LONG>(place.x, place.y,
+			place.x + region.rcSrc.GetWidth(), place.y + region.rcSrc.GetHeight());
+	}
+}
+#endif
+
 //****************************************************************************
 //TextureInfoPanel
 //****************************************************************************
@@ -3,6 +3,7 @@
 #include "../pch.h"
 
 #include "DxConstant.hpp"
+#include "DxUtility.hpp"
 #include "DirectGraphics.hpp"
 
 namespace directx {
@@ -11,6 +12,56 @@ namespace directx {
 	class TextureManager;
 	class TextureInfoPanel;
 
+	//****************************************************************************
+	//TextureDecoder
+	//****************************************************************************
+	//Decodes images to 32-bit ARGB pixels through WIC. Doesn't touch the device, safe on any thread.
+	//Formats WIC can't read (TGA, DDS, ...) are left to D3DX.
+	class TextureDecoder {
+	public:
+		struct Image {
+			UINT width;
+			UINT height;
+			std::vector<D3DCOLOR> pixels;
+		};
+	public:
+		//D3DXIFF_FORCE_DWORD if the format isn't decoded here
+		static D3DXIMAGE_FILEFORMAT GetFileFormat(const std::wstring& path);
+		static bool IsSupported(const std::wstring& path) { return GetFileFormat(path) != D3DXIFF_FORCE_DWORD; }
+
+		static bool Decode(const void* data, size_t size, Image* dst);
+		//Returns nullptr on failure
+		static shared_ptr<Image> DecodeFile(const std::wstring& path);
+
+		//Decodes every supported file under dir, once serially and once through a pool, returns the timings
+		static std::wstring BenchmarkDirectory(const std::wstring& dir);
+	};
+
+	//****************************************************************************
+	//TextureDecodePool
+	//****************************************************************************
+	//Fixed set of decode workers, one per core like ParallelFor.
+	//Queued files are still decoded on destruction, so no future is left broken.
+	class TextureDecodePool {
+	public:
+		using Result = shared_ptr<TextureDecoder::Image>;
+	private:
+		std::vector<std::thread> listThread_;
+		std::list<std::packaged_task<Result()>> listTask_;
+		std::mutex mutex_;
+		std::condition_variable cvTask_;
+		bool bStop_;
+
+		void _Run();
+	public:
+		TextureDecodePool();
+		~TextureDecodePool();
+
+		std::future<Result> Add(std::function<Result()> func);
+		std::future<Result> AddFile(const std::wstring& path);
+		size_t GetThreadCount() { return listThread_.size(); }
+	};
+
 	//****************************************************************************
 	//Texture
 	//****************************************************************************
@@ -35,6 +86,8 @@ namespace directx {
 		bool useMipMap_;
 		bool useNonPowerOfTwo_;
 
+		std::future<shared_ptr<TextureDecoder::Image>> futureDecode_;	//Pixels decoded ahead of the load thread
+
 		IDirect3DTexture9* pTexture_;
 		IDirect3DSurface9* lpRenderSurface_;
 		IDirect3DSurface9* lpRenderZ_;
@@ -105,11 +158,13 @@ namespace directx {
 		std::map<std::wstring, shared_ptr<TextureData>> mapTextureData_;
 		std::list<std::pair<std::map<std::wstring, shared_ptr<TextureData>>::iterator, IDirect3DSurface9*>> listRefreshSurface_;
 		shared_ptr<TextureInfoPanel> panelInfo_;
+		unique_ptr<TextureDecodePool> poolDecode_;
 
 		void _ReleaseTextureData(const std::wstring& name);
 		void _ReleaseTextureData(std::map<std::wstring, shared_ptr<TextureData>>::iterator itr);
 
 		void __CreateFromFile(shared_ptr<TextureData>& dst, const std::wstring& path, bool genMipmap, bool flgNonPowerOfTwo);
+		void __CreateFromImage(shared_ptr<TextureData>& dst, const std::wstring& path, const TextureDecoder::Image& image);
 		bool _CreateFromFile(shared_ptr<TextureData>& dst, const std::wstring& path, bool genMipmap, bool flgNonPowerOfTwo);
 		bool _CreateRenderTarget(shared_ptr<TextureData>& dst, const std::wstring& name, 
 			size_t width = 0U, size_t height = 0U, bool bManaged = true);
@@ -149,6 +204,75 @@ namespace directx {
 		void SetInfoPanel(shared_ptr<TextureInfoPanel> panel) { panelInfo_ = panel; }
 	};
 
+#if defined(DNH_PROJ_EXECUTOR)
+	//****************************************************************************
+	//TextureAtlas
+	//****************************************************************************
+	//Packs rects from several source textures into shared pages.
+	//Layouts only depend on the rect sizes, they're cached on disk keyed by the sources that built them.
+	//Rects are owned by whoever added them (a data file), re-adding under the same owner (a reload) frees the old ones first.
+	class TextureAtlas {
+	public:
+		enum : LONG {
+			PAGE_SIZE = 2048,
+			PADDING = 2,
+		};
+		enum : size_t {
+			PAGE_NONE = SIZE_MAX,
+		};
+		enum : uint32_t {
+			CACHE_VERSION = 1,
+		};
+
+		struct Region {
+			DxRect<LONG> rcSrc;		//Rect on the source texture
+			size_t page;			//PAGE_NONE if the rect wasn't packed
+			DxRect<LONG> rcAtlas;	//Rect on the page
+		};
+	private:
+		struct Page {
+			shared_ptr<Texture> texture;
+			RectPacker packer;
+		};
+		struct Placement {
+			uint32_t page;
+			LONG x;
+			LONG y;
+		};
+		struct Slot {
+			size_t page;
+			DxRect<LONG> rcPacked;	//Including the padding
+		};
+
+		std::wstring pathCache_;
+		LONG sizePage_;
+		std::vector<Page> listPage_;
+		size_t keyState_;		//Hash of every layout added so far
+		bool bFreed_;			//Freed rects aren't part of the cached layouts, stop using the cache
+
+		std::unordered_map<std::wstring, std::vector<Slot>> mapOwnerSlot_;		//Keyed by whoever added the rects
+
+		bool _AddPage();
+		void _FreeOwner(const std::wstring& owner);
+		bool _LoadLayout(const std::wstring& path, const gstd::ByteBuffer& key, std::vector<Placement>& listPlace);
+		void _SaveLayout(const std::wstring& path, const gstd::ByteBuffer& key, const std::vector<Placement>& listPlace);
+	public:
+		TextureAtlas();
+		~TextureAtlas();
+
+		//Leave [pathCache] empty to not cache layouts
+		void Initialize(const std::wstring& pathCache);
+		void Clear();
+
+		//Packs the regions' rects and copies their pixels from [source], rects that can't be packed are left at PAGE_NONE.
+		//Rects added earlier under the same [owner] are freed first, other owners may share the source.
+		void AddSource(const std::wstring& owner, shared_ptr<Texture> source, std::vector<Region>& listRegion);
+
+		size_t GetPageCount() { return listPage_.size(); }
+		shared_ptr<Texture> GetPage(size_t index) { return listPage_[index].texture; }
+	};
+#endif
+
 	//****************************************************************************
 	//TextureInfoPanel
 	//****************************************************************************
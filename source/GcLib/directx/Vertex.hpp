@@ -59,6 +59,30 @@ namespace directx {
 		D3DXVECTOR4 z_ang_extra;
 	};
 
+	//Stream 0 is a unit quad, its position and texcoord are the (0~1) corner of the sprite
+	static const D3DVERTEXELEMENT9 ELEMENTS_TLX_INSTANCED_SPRITE[] = {
+		{ 0, 0, D3DDECLTYPE_FLOAT4, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_POSITION, 0 },
+		{ 0, 16, D3DDECLTYPE_D3DCOLOR, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_COLOR, 0 },
+		{ 0, 20, D3DDECLTYPE_FLOAT2, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_TEXCOORD, 0 },
+		//ARGB Vertex color
+		{ 1, 0, D3DDECLTYPE_D3DCOLOR, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_COLOR, 1 },
+		//Transformed X edge + Y edge
+		{ 1, 4, D3DDECLTYPE_FLOAT4, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_TEXCOORD, 1 },
+		//XY Position of the top-left corner + extra data
+		{ 1, 20, D3DDECLTYPE_FLOAT4, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_TEXCOORD, 2 },
+		//UV rect (left, top, right, bottom)
+		{ 1, 36, D3DDECLTYPE_FLOAT4, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_TEXCOORD, 3 },
+		D3DDECL_END()
+	};
+	struct VERTEX_INSTANCE_SPRITE {
+		D3DCOLOR diffuse_color;
+		D3DXVECTOR4 xy_edge_x_y;
+		D3DXVECTOR4 xy_pos_extra;
+		D3DXVECTOR4 uv_rect;
+	};
+	//Shares the instancing vertex buffer with VERTEX_INSTANCE
+	static_assert(sizeof(VERTEX_INSTANCE_SPRITE) == sizeof(VERTEX_INSTANCE), "Instance strides must match");
+
 	static const D3DVERTEXELEMENT9 ELEMENTS_L[] = {
 		{ 0, 0, D3DDECLTYPE_FLOAT3, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_POSITION, 0 },
 		{ 0, 12, D3DDECLTYPE_D3DCOLOR, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_COLOR, 0 },
@@ -393,6 +393,52 @@ size_t File::GetFilePointer(AccessType type) {
 	else return hFile_.tellp();
 }
 
+//*******************************************************************
+//MappedFile
+//*******************************************************************
+MappedFile::MappedFile() {
+	hFile_ = INVALID_HANDLE_VALUE;
+	hMapping_ = nullptr;
+	pView_ = nullptr;
+	size_ = 0;
+}
+MappedFile::~MappedFile() {
+	Close();
+}
+bool MappedFile::Open(const std::wstring& path) {
+	Close();
+
+	hFile_ = ::CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (hFile_ == INVALID_HANDLE_VALUE) return false;
+
+	LARGE_INTEGER size;
+	//Empty files can't be mapped
+	if (!::GetFileSizeEx(hFile_, &size) || size.QuadPart == 0 || size.QuadPart > SIZE_MAX) {
+		Close();
+		return false;
+	}
+	size_ = (size_t)size.QuadPart;
+
+	hMapping_ = ::CreateFileMappingW(hFile_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (hMapping_)
+		pView_ = ::MapViewOfFile(hMapping_, FILE_MAP_READ, 0, 0, 0);
+	if (pView_ == nullptr) {
+		Close();
+		return false;
+	}
+	return true;
+}
+void MappedFile::Close() {
+	if (pView_) ::UnmapViewOfFile(pView_);
+	if (hMapping_) ::CloseHandle(hMapping_);
+	if (hFile_ != INVALID_HANDLE_VALUE) ::CloseHandle(hFile_);
+	hFile_ = INVALID_HANDLE_VALUE;
+	hMapping_ = nullptr;
+	pView_ = nullptr;
+	size_ = 0;
+}
+
 //*******************************************************************
 //FileManager
 //*******************************************************************
@@ -154,6 +154,27 @@ namespace gstd {
 		size_t GetFilePointer(AccessType type = READ);
 	};
 
+	//*******************************************************************
+	//MappedFile
+	//	Read-only view of a whole file, the OS pages it in on access
+	//*******************************************************************
+	class MappedFile {
+	protected:
+		HANDLE hFile_;
+		HANDLE hMapping_;
+		const void* pView_;
+		size_t size_;
+	public:
+		MappedFile();
+		~MappedFile();
+
+		bool Open(const std::wstring& path);
+		void Close();
+
+		const void* GetPointer() const { return pView_; }
+		size_t GetSize() const { return size_; }
+	};
+
 	//*******************************************************************
 	//FileReader
 	//*******************************************************************
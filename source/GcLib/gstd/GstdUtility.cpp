@@ -121,6 +121,53 @@ std::wstring SystemUtility::GetSystemFontFilePath(const std::wstring& faceName)
 	return std::wstring(wsFontFile.begin(), wsFontFile.end());
 }
 
+//*******************************************************************
+//BucketIndexList
+//*******************************************************************
+BucketIndexList::BucketIndexList() {
+	countBucket_ = 0;
+	countChunk_ = 1;
+	countItem_ = 0;
+}
+void BucketIndexList::_PrepareBuild(size_t countItem, size_t countBucket) {
+	countBucket_ = countBucket;
+	countItem_ = countItem;
+
+	countChunk_ = 1;
+	if (countItem >= CHUNK_ITEM_MIN * 2) {
+		size_t countCore = std::max(std::thread::hardware_concurrency(), 1U);
+		countChunk_ = std::clamp<size_t>(countItem / CHUNK_ITEM_MIN, 1, countCore);
+	}
+
+	listKey_.resize(countItem);
+	listChunkOffset_.assign(countChunk_ * countBucket, 0);
+	listBucketOffset_.assign(countBucket + 1, 0);
+	listIndex_.clear();
+}
+void BucketIndexList::_ComputeOffset() {
+	//Bucket-major, then chunk order, so indices within a bucket stay ascending
+	uint32_t pos = 0;
+	for (size_t iBucket = 0; iBucket < countBucket_; ++iBucket) {
+		listBucketOffset_[iBucket] = pos;
+		for (size_t iChunk = 0; iChunk < countChunk_; ++iChunk) {
+			uint32_t& ref = listChunkOffset_[iChunk * countBucket_ + iBucket];
+			uint32_t count = ref;
+			ref = pos;
+			pos += count;
+		}
+	}
+	listBucketOffset_[countBucket_] = pos;
+	listIndex_.resize(pos);
+}
+void BucketIndexList::_GetChunkRange(size_t iChunk, size_t* pBegin, size_t* pEnd) {
+	*pBegin = countItem_ / countChunk_ * iChunk + std::min(countItem_ % countChunk_, iChunk);
+	*pEnd = countItem_ / countChunk_ * (iChunk + 1U) + std::min(countItem_ % countChunk_, iChunk + 1U);
+}
+void BucketIndexList::Clear() {
+	std::fill(listBucketOffset_.begin(), listBucketOffset_.end(), 0);
+	listIndex_.clear();
+}
+
 //*******************************************************************
 //AnyMap
 //*******************************************************************
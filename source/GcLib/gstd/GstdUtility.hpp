@@ -81,6 +81,98 @@ namespace gstd {
 		}
 	}
 
+	//================================================================
+	//BucketIndexList
+	//Stable counting sort of item indices into contiguous buckets.
+	//Keys are computed and indices scattered in parallel chunks when there are enough items.
+	class BucketIndexList {
+	public:
+		enum : uint32_t {
+			KEY_SKIP = UINT32_MAX,
+
+			CHUNK_ITEM_MIN = 4096,
+		};
+	private:
+		size_t countBucket_;
+		size_t countChunk_;
+		size_t countItem_;
+
+		std::vector<uint32_t> listKey_;
+		std::vector<uint32_t> listChunkOffset_;		//[chunk][bucket], counts then write positions
+		std::vector<uint32_t> listBucketOffset_;	//countBucket_ + 1
+		std::vector<uint32_t> listIndex_;
+
+		void _PrepareBuild(size_t countItem, size_t countBucket);
+		void _ComputeOffset();
+		void _GetChunkRange(size_t iChunk, size_t* pBegin, size_t* pEnd);
+
+		template<class F> void _RunChunk(F&& func);
+	public:
+		BucketIndexList();
+
+		//funcKey(i) returns the bucket of item i, or KEY_SKIP to leave it out
+		template<class FKey> void Build(size_t countItem, size_t countBucket, FKey&& funcKey);
+		void Clear();
+
+		size_t GetBucketCount() const { return countBucket_; }
+		size_t GetSize() const { return listIndex_.size(); }
+		size_t GetBucketSize(size_t bucket) const {
+			return listBucketOffset_[bucket + 1] - listBucketOffset_[bucket];
+		}
+		const uint32_t* GetBucketBegin(size_t bucket) const { return listIndex_.data() + listBucketOffset_[bucket]; }
+		const uint32_t* GetBucketEnd(size_t bucket) const { return listIndex_.data() + listBucketOffset_[bucket + 1]; }
+	};
+
+	template<class F>
+	void BucketIndexList::_RunChunk(F&& func) {
+		if (countChunk_ > 1) {
+			std::vector<std::future<void>> workers;
+			workers.reserve(countChunk_);
+			for (size_t iChunk = 0; iChunk < countChunk_; ++iChunk)
+				workers.emplace_back(std::async(std::launch::async | std::launch::deferred, func, iChunk));
+			for (const auto& worker : workers)
+				worker.wait();
+		}
+		else {
+			func(0);
+		}
+	}
+	template<class FKey>
+	void BucketIndexList::Build(size_t countItem, size_t countBucket, FKey&& funcKey) {
+		_PrepareBuild(countItem, countBucket);
+		if (countItem == 0 || countBucket == 0) return;
+
+		//Keys and per-chunk bucket counts
+		_RunChunk([&](size_t iChunk) {
+			size_t begin, end;
+			_GetChunkRange(iChunk, &begin, &end);
+
+			uint32_t* pCount = listChunkOffset_.data() + iChunk * countBucket;
+			for (size_t i = begin; i < end; ++i) {
+				uint32_t key = funcKey(i);
+				if (key >= countBucket) key = KEY_SKIP;
+				listKey_[i] = key;
+				if (key != KEY_SKIP)
+					++pCount[key];
+			}
+		});
+
+		_ComputeOffset();
+
+		//Scatter, each chunk writes to its own reserved range of every bucket
+		_RunChunk([&](size_t iChunk) {
+			size_t begin, end;
+			_GetChunkRange(iChunk, &begin, &end);
+
+			uint32_t* pOffset = listChunkOffset_.data() + iChunk * countBucket;
+			for (size_t i = begin; i < end; ++i) {
+				uint32_t key = listKey_[i];
+				if (key != KEY_SKIP)
+					listIndex_[pOffset[key]++] = i;
+			}
+		});
+	}
+
 	//================================================================
 	//VersionUtility
 	class VersionUtility {
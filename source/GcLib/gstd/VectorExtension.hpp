@@ -73,6 +73,13 @@ namespace gstd {
 
 		//Computes reciprocal of vector
 		static __forceinline __m128 Rcp(const __m128& x);
+		//Computes absolute value of vector
+		static __forceinline __m128 Abs(const __m128& x);
+
+		//Performs [max] on vector a and b
+		static __forceinline __m128 Max(const __m128& a, const __m128& b);
+		//Compares vector a and b, bit i of the result is set if a[i] <= b[i]
+		static __forceinline int MaskLessEqual(const __m128& a, const __m128& b);
 
 		//[add] double vector a and b
 		static __forceinline __m128d Add(const __m128d& a, const __m128d& b);
@@ -382,6 +389,40 @@ namespace gstd {
 #endif
 		return res;
 	}
+	__m128 Vectorize::Abs(const __m128& x) {
+		__m128 res;
+#ifndef __L_MATH_VECTORIZE
+		for (int i = 0; i < 4; ++i)
+			res.m128_f32[i] = fabsf(x.m128_f32[i]);
+#else
+		//SSE, clears the sign bits
+		res = _mm_andnot_ps(_mm_set1_ps(-0.0f), x);
+#endif
+		return res;
+	}
+
+	__m128 Vectorize::Max(const __m128& a, const __m128& b) {
+		__m128 res;
+#ifndef __L_MATH_VECTORIZE
+		for (int i = 0; i < 4; ++i)
+			res.m128_f32[i] = std::max(a.m128_f32[i], b.m128_f32[i]);
+#else
+		//SSE
+		res = _mm_max_ps(a, b);
+#endif
+		return res;
+	}
+	int Vectorize::MaskLessEqual(const __m128& a, const __m128& b) {
+		int res = 0;
+#ifndef __L_MATH_VECTORIZE
+		for (int i = 0; i < 4; ++i)
+			res |= (a.m128_f32[i] <= b.m128_f32[i]) ? (1 << i) : 0;
+#else
+		//SSE
+		res = _mm_movemask_ps(_mm_cmple_ps(a, b));
+#endif
+		return res;
+	}
 
 	//---------------------------------------------------------------------
 
@@ -481,7 +522,7 @@ namespace gstd {
 			res.m128d_f64[i] = std::max(a.m128d_f64[i], b.m128d_f64[i]);
 #else
 		//SSE2
-		res = _mm_min_pd(a, b);
+		res = _mm_max_pd(a, b);
 #endif
 		return res;
 	}
@@ -492,7 +533,7 @@ namespace gstd {
 			res.m128d_f64[i] = std::min(a.m128d_f64[i], b.m128d_f64[i]);
 #else
 		//SSE2
-		res = _mm_max_pd(a, b);
+		res = _mm_min_pd(a, b);
 #endif
 		return res;
 	}
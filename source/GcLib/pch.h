@@ -68,10 +68,12 @@
 	#include <wingdi.h>		// For font generation in DxText.cpp
 	#include <pdh.h>		// For performance queries in Logger.cpp
 	#include <wbemidl.h>
+	#include <wincodec.h>	// For image decoding in Texture.cpp
 
 	#pragma comment (lib, "gdi32.lib")
 	#pragma comment (lib, "pdh.lib")
 	#pragma comment (lib, "wbemuuid.lib")
+	#pragma comment (lib, "windowscodecs.lib")
 
 #endif	// defined(DNH_PROJ_EXECUTOR)
 
@@ -147,6 +149,9 @@
 #include <algorithm>
 #include <iterator>
 #include <future>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 #include <fstream>
 #include <sstream>
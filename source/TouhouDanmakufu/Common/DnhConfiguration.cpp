@@ -64,6 +64,9 @@ DnhConfiguration::DnhConfiguration() {
 
 	bEnableUnfocusedProcessing_ = false;
 
+	bUseNullDevice_ = false;
+	pathRenderTrace_ = L"";
+
 	LoadConfigFile();
 	_LoadDefinitionFile();
 }
@@ -98,6 +101,17 @@ bool DnhConfiguration::_LoadDefinitionFile() {
 		bEnableUnfocusedProcessing_ = str == L"true" ? true : StringUtility::ToInteger(str);
 	}
 
+	{
+		std::wstring str = prop.GetString(L"render.null", L"false");
+		bUseNullDevice_ = str == L"true" ? true : StringUtility::ToInteger(str);
+
+		pathRenderTrace_ = prop.GetString(L"render.trace", L"");
+		if (pathRenderTrace_.size() > 0) {
+			pathRenderTrace_ = PathProperty::GetModuleDirectory() + pathRenderTrace_;
+			pathRenderTrace_ = PathProperty::ReplaceYenToSlash(pathRenderTrace_);
+		}
+	}
+
 	{
 		auto _AddWindowSize = [&](std::vector<POINT>& listSize, LONG width, LONG height) {
 			POINT size = {
@@ -39,6 +39,11 @@ const std::wstring& EPathProperty::GetPlayerScriptRootDirectory() {
 	static std::wstring path = GetModuleDirectory() + L"script/player/";
 	return path;
 }
+
+const std::wstring& EPathProperty::GetCacheDirectory() {
+	static std::wstring path = GetModuleDirectory() + L"cache/";
+	return path;
+}
 std::wstring EPathProperty::GetReplaySaveDirectory(const std::wstring& scriptPath) {
 	std::wstring scriptName = PathProperty::GetFileNameWithoutExtension(scriptPath);
 	std::wstring dir = PathProperty::GetFileDirectory(scriptPath) + L"replay/";
@@ -19,6 +19,8 @@ public:
 	static const std::wstring& GetStgDefaultScriptDirectory();
 	static const std::wstring& GetPlayerScriptRootDirectory();
 
+	static const std::wstring& GetCacheDirectory();
+
 	static std::wstring GetReplaySaveDirectory(const std::wstring& scriptPath);
 	static std::wstring GetCommonDataPath(const std::wstring& scriptPath, const std::wstring& area);
 };
@@ -2,6 +2,72 @@
 
 #include "StgCommon.hpp"
 #include "StgSystem.hpp"
+#include "../../GcLib/directx/HLSL.hpp"
+
+//****************************************************************************
+//StgObjectPool
+//****************************************************************************
+StgObjectPool::Block* StgObjectPool::listFree_[SIZE_POOL_MAX / SIZE_ALIGN + 1] = { nullptr };
+size_t StgObjectPool::listFreeCount_[SIZE_POOL_MAX / SIZE_ALIGN + 1] = { 0 };
+size_t StgObjectPool::countFree_ = 0;
+size_t StgObjectPool::countCreate_ = 0;
+size_t StgObjectPool::countHeapAlloc_ = 0;
+
+void* StgObjectPool::Allocate(size_t size) {
+	++countCreate_;
+
+	size_t bucket = (size + SIZE_ALIGN - 1) / SIZE_ALIGN;
+	if (bucket >= sizeof(listFree_) / sizeof(Block*)) {
+		++countHeapAlloc_;
+		return ::operator new(size);
+	}
+
+	if (Block* block = listFree_[bucket]) {
+		listFree_[bucket] = block->next;
+		--listFreeCount_[bucket];
+		--countFree_;
+		return block;
+	}
+
+	++countHeapAlloc_;
+	return ::operator new(bucket * SIZE_ALIGN);
+}
+void StgObjectPool::Release(void* ptr, size_t size) {
+	if (ptr == nullptr) return;
+
+	size_t bucket = (size + SIZE_ALIGN - 1) / SIZE_ALIGN;
+	if (bucket >= sizeof(listFree_) / sizeof(Block*)) {
+		::operator delete(ptr);
+		return;
+	}
+
+	Block* block = (Block*)ptr;
+	block->next = listFree_[bucket];
+	listFree_[bucket] = block;
+	++listFreeCount_[bucket];
+	++countFree_;
+}
+void StgObjectPool::Reserve(size_t size, size_t count) {
+	size_t bucket = (size + SIZE_ALIGN - 1) / SIZE_ALIGN;
+	if (bucket == 0 || bucket >= sizeof(listFree_) / sizeof(Block*)) return;
+
+	size_t countExist = listFreeCount_[bucket];
+	if (countExist >= count) return;
+
+	//Blocks never go back to the heap, so the slab is never freed as a whole
+	size_t sizeBlock = bucket * SIZE_ALIGN;
+	size_t countNew = count - countExist;
+	byte* slab = (byte*)::operator new(sizeBlock * countNew);
+	++countHeapAlloc_;
+
+	for (size_t i = 0; i < countNew; ++i) {
+		Block* block = (Block*)(slab + sizeBlock * (countNew - 1 - i));
+		block->next = listFree_[bucket];
+		listFree_[bucket] = block;
+	}
+	listFreeCount_[bucket] += countNew;
+	countFree_ += countNew;
+}
 
 //****************************************************************************
 //StgMoveObject
@@ -66,7 +132,18 @@ void StgMoveObject::_Move() {
 	}
 	else if (pattern_ == nullptr) return;
 
-	pattern_->Move();
+	//The two plain patterns cover nearly every moving object, call them directly so they can be inlined
+	switch (pattern_->GetType()) {
+	case StgMovePattern::TYPE_ANGLE:
+		((StgMovePattern_Angle*)pattern_.get())->StgMovePattern_Angle::Move();
+		break;
+	case StgMovePattern::TYPE_XY:
+		((StgMovePattern_XY*)pattern_.get())->StgMovePattern_XY::Move();
+		break;
+	default:
+		pattern_->Move();
+		break;
+	}
 	++framePattern_;
 }
 void StgMoveObject::_AttachReservedPattern(ref_unsync_ptr<StgMovePattern> pattern) {
@@ -81,6 +158,21 @@ void StgMoveObject::AddPattern(uint32_t frameDelay, ref_unsync_ptr<StgMovePatter
 		mapPattern_[frame].push_back(pattern);
 	}
 }
+//False if a current or reserved pattern follows another object
+bool StgMoveObject::IsMoveIsolated() {
+	auto _IsRelative = [](StgMovePattern* pattern) {
+		return pattern->GetType() == StgMovePattern::TYPE_ANGLE
+			&& ((StgMovePattern_Angle*)pattern)->objRelative_;
+	};
+
+	if (pattern_ && _IsRelative(pattern_.get())) return false;
+	for (auto& iPair : mapPattern_) {
+		for (auto& iPattern : iPair.second) {
+			if (_IsRelative(iPattern.get())) return false;
+		}
+	}
+	return true;
+}
 double StgMoveObject::GetSpeed() {
 	if (pattern_ == nullptr) return 0;
 	double res = pattern_->GetSpeed();
@@ -868,4 +960,161 @@ void StgMovePattern_Line_Weight::Move() {
 	target_->SetPositionX(tPos[0]);
 	target_->SetPositionY(tPos[1]);
 	++frameWork_;
-}
\ No newline at end of file
+}
+
+//****************************************************************************
+//StgInstanceStream
+//****************************************************************************
+StgInstanceStream::StgInstanceStream() {
+	countInstance_ = 0;
+}
+
+void StgInstanceStream::BuildInstance(VERTEX_INSTANCE_SPRITE* dst, const VERTEX_TLX* src, const D3DXMATRIX& matWorld, D3DCOLOR color) {
+	//The quad is a parallelogram after the transform, so its TL, TR and BL corners describe all of it
+	D3DXVECTOR2 corner[3];
+	for (size_t iVert = 0; iVert < 3; ++iVert) {
+		const D3DXVECTOR4& pos = src[iVert].position;
+		corner[iVert].x = pos.x * matWorld._11 + pos.y * matWorld._21 + matWorld._41;
+		corner[iVert].y = pos.x * matWorld._12 + pos.y * matWorld._22 + matWorld._42;
+	}
+
+	dst->diffuse_color = color;
+	dst->xy_edge_x_y = D3DXVECTOR4(corner[1].x - corner[0].x, corner[1].y - corner[0].y,
+		corner[2].x - corner[0].x, corner[2].y - corner[0].y);
+	dst->xy_pos_extra = D3DXVECTOR4(corner[0].x, corner[0].y, 0, 0);
+	dst->uv_rect = D3DXVECTOR4(src[0].texcoord.x, src[0].texcoord.y, src[3].texcoord.x, src[3].texcoord.y);
+}
+
+bool StgInstanceStream::AddInstance(const VERTEX_TLX* src, const D3DXMATRIX& matWorld, D3DCOLOR color) {
+	if (countInstance_ >= INSTANCE_MAX) return false;
+
+	if (listInstance_.size() <= countInstance_)
+		listInstance_.resize(std::min<size_t>(std::max<size_t>(listInstance_.size() * 2U, 1024U), INSTANCE_MAX));
+
+	BuildInstance(&listInstance_[countInstance_], src, matWorld, color);
+	++countInstance_;
+	return true;
+}
+
+void StgInstanceStream::Render(ID3DXEffect* effect, const ShaderSemanticTable* semantic, const D3DXMATRIX& matViewProj) {
+	size_t countRenderInstance = countInstance_;
+	if (countRenderInstance == 0) return;
+
+	//Unit quad, every instance stretches it over its own corners
+	static std::array<VERTEX_TLX, 4> vertexCorner = {
+		VERTEX_TLX(D3DXVECTOR4(0, 0, 0, 1), 0xffffffff, D3DXVECTOR2(0, 0)),
+		VERTEX_TLX(D3DXVECTOR4(1, 0, 0, 1), 0xffffffff, D3DXVECTOR2(1, 0)),
+		VERTEX_TLX(D3DXVECTOR4(0, 1, 0, 1), 0xffffffff, D3DXVECTOR2(0, 1)),
+		VERTEX_TLX(D3DXVECTOR4(1, 1, 0, 1), 0xffffffff, D3DXVECTOR2(1, 1)),
+	};
+	static std::array<uint16_t, 6> indexCorner = { 0, 1, 2, 2, 1, 3 };
+
+	DirectGraphics* graphics = DirectGraphics::GetBase();
+	IDirect3DDevice9* device = graphics->GetDevice();
+	RenderShaderLibrary* shaderManager = ShaderManager::GetBase()->GetRenderLib();
+
+	VertexBufferManager* vbManager = VertexBufferManager::GetBase();
+	FixedVertexBuffer* vertexBuffer = vbManager->GetVertexBufferTLX();
+	GrowableVertexBuffer* instanceBuffer = vbManager->GetInstancingVertexBuffer();
+	FixedIndexBuffer* indexBuffer = vbManager->GetIndexBuffer();
+
+	instanceBuffer->Expand(countRenderInstance);
+
+	{
+		BufferLockParameter lockParam = BufferLockParameter(D3DLOCK_DISCARD);
+
+		lockParam.SetSource(vertexCorner, 4U, sizeof(VERTEX_TLX));
+		vertexBuffer->UpdateBuffer(&lockParam);
+
+		lockParam.SetSource(listInstance_, countRenderInstance, sizeof(VERTEX_INSTANCE_SPRITE));
+		instanceBuffer->UpdateBuffer(&lockParam);
+
+		lockParam.SetSource(indexCorner, 6U, sizeof(uint16_t));
+		indexBuffer->UpdateBuffer(&lockParam);
+	}
+
+	device->SetVertexDeclaration(shaderManager->GetVertexDeclarationInstancedSprite());
+
+	device->SetStreamSource(0, vertexBuffer->GetBuffer(), 0, sizeof(VERTEX_TLX));
+#ifdef __L_USE_HWINSTANCING
+	device->SetStreamSourceFreq(0, D3DSTREAMSOURCE_INDEXEDDATA | countRenderInstance);
+	device->SetStreamSource(1, instanceBuffer->GetBuffer(), 0, sizeof(VERTEX_INSTANCE_SPRITE));
+	device->SetStreamSourceFreq(1, D3DSTREAMSOURCE_INSTANCEDATA | 1U);
+#endif
+
+	device->SetIndices(indexBuffer->GetBuffer());
+
+	{
+		if (D3DXHANDLE handle = semantic->Get(ShaderSemanticTable::VIEWPROJECTION)) {
+			effect->SetMatrix(handle, &matViewProj);
+		}
+
+		UINT countPass = 1;
+		effect->Begin(&countPass, D3DXFX_DONOTSAVESHADERSTATE);
+		for (UINT iPass = 0; iPass < countPass; ++iPass) {
+			effect->BeginPass(iPass);
+
+#ifdef __L_USE_HWINSTANCING
+			graphics->DrawIndexedPrimitive(D3DPT_TRIANGLELIST, 0, 0, 4, 0, 2);
+#else
+			for (UINT nInst = 0; nInst < countRenderInstance; ++nInst) {
+				device->SetStreamSource(1, instanceBuffer->GetBuffer(),
+					nInst * sizeof(VERTEX_INSTANCE_SPRITE), 0);
+				graphics->DrawIndexedPrimitive(D3DPT_TRIANGLELIST, 0, 0, 4, 0, 2);
+			}
+#endif
+
+			effect->EndPass();
+		}
+		effect->End();
+	}
+
+#ifdef __L_USE_HWINSTANCING
+	device->SetStreamSourceFreq(0, 1);
+	device->SetStreamSourceFreq(1, 1);
+#endif
+	device->SetStreamSource(1, nullptr, 0, 0);
+	device->SetVertexDeclaration(shaderManager->GetVertexDeclarationTLX());
+
+	countInstance_ = 0;
+}
+
+//****************************************************************************
+//StgRenderCuller
+//****************************************************************************
+StgRenderCuller::StgRenderCuller() {
+}
+
+void StgRenderCuller::Reset(size_t count) {
+	//Padded to a multiple of 4, the padding is never culled
+	size_t countPad = (count + 3U) & ~3U;
+	listX_.assign(countPad, 0.0f);
+	listY_.assign(countPad, 0.0f);
+	listRadius_.assign(countPad, RADIUS_NO_CULL);
+	listVisible_.resize(countPad);
+}
+size_t StgRenderCuller::Cull(const DxRect<float>& rcView) {
+	//A circle is culled when it's outside the view rect expanded by its radius on either axis
+	__m128 vCenterX = Vectorize::Replicate((rcView.left + rcView.right) * 0.5f);
+	__m128 vCenterY = Vectorize::Replicate((rcView.top + rcView.bottom) * 0.5f);
+	__m128 vHalfW = Vectorize::Replicate((rcView.right - rcView.left) * 0.5f);
+	__m128 vHalfH = Vectorize::Replicate((rcView.bottom - rcView.top) * 0.5f);
+	__m128 vZero = Vectorize::Replicate(0.0f);
+
+	size_t countCulled = 0;
+	for (size_t i = 0; i < listRadius_.size(); i += 4) {
+		__m128 vRadius = Vectorize::Load(&listRadius_[i]);
+		__m128 vDistX = Vectorize::Abs(Vectorize::Sub(Vectorize::Load(&listX_[i]), vCenterX));
+		__m128 vDistY = Vectorize::Abs(Vectorize::Sub(Vectorize::Load(&listY_[i]), vCenterY));
+		vDistX = Vectorize::Sub(vDistX, Vectorize::Add(vHalfW, vRadius));
+		vDistY = Vectorize::Sub(vDistY, Vectorize::Add(vHalfH, vRadius));
+
+		int maskVisible = Vectorize::MaskLessEqual(Vectorize::Max(vDistX, vDistY), vZero);
+		for (size_t j = 0; j < 4; ++j) {
+			bool bVisible = (maskVisible >> j) & 1;
+			listVisible_[i + j] = bVisible;
+			countCulled += bVisible ? 0 : 1;
+		}
+	}
+	return countCulled;
+}
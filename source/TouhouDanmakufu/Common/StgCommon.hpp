@@ -65,6 +65,8 @@ public:
 	void AddPattern(uint32_t frameDelay, ref_unsync_ptr<StgMovePattern> pattern, bool bForceMap = false);
 
 	int GetMoveFrame() { return frameMove_; }
+
+	bool IsMoveIsolated();
 };
 
 //*******************************************************************
@@ -403,4 +405,75 @@ public:
 	virtual void Move();
 
 	void SetAtWeight(double tx, double ty, double weight, double maxSpeed);
-};
\ No newline at end of file
+};
+
+//*******************************************************************
+//StgRenderQuad
+//*******************************************************************
+//CPU copy of a sprite frame's vertices, for batched and instanced rendering
+struct StgRenderQuad {
+	VERTEX_TLX vertex[4];	//Strip order (TL, TR, BL, BR)
+
+	void Load(const VERTEX_TLX* src) {
+		for (size_t i = 0; i < 4; ++i)
+			vertex[i] = src[i];
+	}
+	const VERTEX_TLX* Get() const { return vertex; }
+};
+
+//*******************************************************************
+//StgInstanceStream
+//*******************************************************************
+//CPU-built per-instance data for hardware-instanced sprite rendering. Only Render touches the device.
+class StgInstanceStream {
+public:
+	enum : size_t {
+		INSTANCE_MAX = 16384,
+	};
+private:
+	std::vector<VERTEX_INSTANCE_SPRITE> listInstance_;
+	size_t countInstance_;
+public:
+	StgInstanceStream();
+
+	//Packs a quad in strip order (TL, TR, BL, BR) transformed by the 2D affine [matWorld] into one instance
+	static void BuildInstance(VERTEX_INSTANCE_SPRITE* dst, const VERTEX_TLX* src, const D3DXMATRIX& matWorld, D3DCOLOR color);
+
+	//Returns false when the stream is full
+	bool AddInstance(const VERTEX_TLX* src, const D3DXMATRIX& matWorld, D3DCOLOR color);
+	void Clear() { countInstance_ = 0; }
+
+	size_t GetInstanceCount() const { return countInstance_; }
+	std::vector<VERTEX_INSTANCE_SPRITE>& GetInstanceList() { return listInstance_; }
+
+	//Draws the stream with the current texture and blend mode, then clears it
+	void Render(ID3DXEffect* effect, const ShaderSemanticTable* semantic, const D3DXMATRIX& matViewProj);
+};
+
+//*******************************************************************
+//StgRenderCuller
+//*******************************************************************
+//Bounding circles of a render queue, tested against the 2D camera's view four at a time
+class StgRenderCuller {
+public:
+	static constexpr float RADIUS_NO_CULL = FLT_MAX;
+private:
+	std::vector<float> listX_;
+	std::vector<float> listY_;
+	std::vector<float> listRadius_;
+	std::vector<byte> listVisible_;
+public:
+	StgRenderCuller();
+
+	//Every circle starts out as RADIUS_NO_CULL
+	void Reset(size_t count);
+	void SetCircle(size_t index, const D3DXVECTOR2& pos, float radius) {
+		listX_[index] = pos.x;
+		listY_[index] = pos.y;
+		listRadius_[index] = radius;
+	}
+
+	//Returns the number of circles completely outside [rcView]
+	size_t Cull(const DxRect<float>& rcView);
+	bool IsVisible(size_t index) const { return listVisible_[index] != 0; }
+};
@@ -234,7 +234,7 @@ void StgEnemyObject::Intersect(StgIntersectionTarget* ownTarget, StgIntersection
 	if (auto ptrObj = otherTarget->GetObject()) {
 		if (otherTarget->GetTargetType() == StgIntersectionTarget::TYPE_PLAYER_SHOT) {
 			if (StgShotObject* shot = dynamic_cast<StgShotObject*>(ptrObj.get())) {
-				if (ref_unsync_weak_ptr<StgEnemyObject> self = ownTarget->GetObject()) {
+				if (StgEnemyObject* self = dynamic_cast<StgEnemyObject*>(ownTarget->GetObjectPointer())) {
 					//Register intersection only if the enemy is off hit cooldown
 					if (!shot->CheckEnemyHitCooldownExists(self)) {
 						damage = shot->GetDamage() * (shot->IsSpellFactor() ? rateDamageSpell_ : rateDamageShot_) 
@@ -14,6 +14,8 @@ StgIntersectionManager::StgIntersectionManager() {
 	LONG screenWidth = graphics->GetScreenWidth();
 	LONG screenHeight = graphics->GetScreenHeight();
 
+	countGrazeCheck_ = 0;
+
 	//_CreatePool(2);
 	listSpace_.resize(3);
 	for (size_t iSpace = 0; iSpace < listSpace_.size(); iSpace++) {
@@ -125,43 +127,76 @@ void StgIntersectionManager::Work() {
 
 	size_t totalCheck = 0;
 	size_t totalTarget = 0;
+	size_t totalCellVisit = 0;
+	countGrazeCheck_ = 0;
 	for (auto itr = listSpace_.begin(); itr != listSpace_.end(); itr++) {
 		StgIntersectionSpace* space = *itr;
 
 		size_t currentCheck = 0;
 		auto listCheck = space->CreateIntersectionCheckList(this, currentCheck);
 
+		//Compute hits in parallel, nothing is mutated here
+		listPairHit_.resize(currentCheck);
+		ParallelFor(currentCheck, [&](size_t iCheck) {
+			auto& cTargetPair = listCheck->at(iCheck);
+			listPairHit_[iCheck] = IsIntersected(cTargetPair.first, cTargetPair.second);
+		});
+
+		listHit_.clear();
 		for (size_t iCheck = 0; iCheck < currentCheck; iCheck++) {
+			if (!listPairHit_[iCheck]) continue;
 			auto& cTargetPair = listCheck->at(iCheck);
 
-			StgIntersectionTarget* targetA = cTargetPair.first;
-			StgIntersectionTarget* targetB = cTargetPair.second;
-			if (targetA == nullptr || targetB == nullptr) continue;
+			StgIntersectionObject* pObjA = cTargetPair.first->GetObjectPointer();
+			StgIntersectionObject* pObjB = cTargetPair.second->GetObjectPointer();
+
+			HitRecord hit;
+			hit.idA = pObjA ? pObjA->GetDxScriptObjectID() : DxScript::ID_INVALID;
+			hit.idB = pObjB ? pObjB->GetDxScriptObjectID() : DxScript::ID_INVALID;
+			hit.indexA = cTargetPair.indexA;
+			hit.indexB = cTargetPair.indexB;
+			hit.targetA = cTargetPair.first;
+			hit.targetB = cTargetPair.second;
+			listHit_.push_back(hit);
+		}
 
-			if (IsIntersected(targetA, targetB)) {
-				ref_unsync_weak_ptr<StgIntersectionObject>& ptrA = targetA->GetObject();
-				ref_unsync_weak_ptr<StgIntersectionObject>& ptrB = targetB->GetObject();
-				{
-					if (ptrA) {
-						ptrA->Intersect(targetA, targetB);
-						ptrA->SetIntersected();
-						if (ptrB)
-							ptrA->AddIntersectedId(ptrB);
-					}
-					if (ptrB) {
-						ptrB->Intersect(targetB, targetA);
-						ptrB->SetIntersected();
-						if (ptrA)
-							ptrB->AddIntersectedId(ptrA);
-					}
+		//Apply them sequentially in a canonical order, keeps replays reproducible regardless of thread count
+		std::sort(listHit_.begin(), listHit_.end());
+
+		for (HitRecord& hit : listHit_) {
+			StgIntersectionTarget* targetA = hit.targetA;
+			StgIntersectionTarget* targetB = hit.targetB;
+
+			ref_unsync_weak_ptr<StgIntersectionObject> ptrA = targetA->GetObject();
+			ref_unsync_weak_ptr<StgIntersectionObject> ptrB = targetB->GetObject();
+			{
+				if (ptrA) {
+					ptrA->Intersect(targetA, targetB);
+					ptrA->SetIntersected();
+					if (ptrB)
+						ptrA->AddIntersectedId(ptrB);
+				}
+				if (ptrB) {
+					ptrB->Intersect(targetB, targetA);
+					ptrB->SetIntersected();
+					if (ptrA)
+						ptrB->AddIntersectedId(ptrA);
 				}
 			}
 		}
 
+		if (space == listSpace_[SPACE_PLAYER_ENEMY])
+			_WorkGraze(space);
+
 		totalCheck += currentCheck;
+		totalTarget += space->GetTargetCount();
+		totalCellVisit += space->GetCellVisitCount();
 		space->ClearTarget();
 	}
 
+	totalTarget += listGrazeTarget_.size();
+	listGrazeTarget_.clear();
+
 	//_ArrangePool();
 
 	ELogger* logger = ELogger::GetInstance();
@@ -173,7 +208,50 @@ void StgIntersectionManager::Work() {
 			StringUtility::Format(L"Used=%4d, Cached=%4d, Total=%4d, Check=%4d", countUsed, countCache, countUsed + countCache, totalCheck));
 		*/
 		infoLog->SetInfo(9, "Intersection count",
-			StringUtility::Format("Total=%4d, Check=%4d", totalTarget, totalCheck));
+			StringUtility::Format("Total=%4d, Cell=%4d, Check=%4d, Graze=%4d", 
+				totalTarget, totalCellVisit, totalCheck, countGrazeCheck_));
+	}
+}
+void StgIntersectionManager::_WorkGraze(StgIntersectionSpace* space) {
+	if (listGrazeTarget_.size() == 0) return;
+
+	StgIntersectionSpace::ListTarget& listTargetB = space->GetTargetListB();
+
+	for (auto& pTargetGraze : listGrazeTarget_) {
+		AddVisualization(pTargetGraze);
+		if (listTargetB.size() == 0) continue;
+
+		//One sweep for all candidates of this graze circle, then the narrow phase in parallel
+		space->GetCandidateB(pTargetGraze.get(), listGrazeCandidate_);
+		countGrazeCheck_ += listGrazeCandidate_.size();
+
+		listPairHit_.resize(listGrazeCandidate_.size());
+		ParallelFor(listGrazeCandidate_.size(), [&](size_t i) {
+			listPairHit_[i] = IsIntersected(pTargetGraze.get(), listTargetB[listGrazeCandidate_[i]].get());
+		});
+
+		//Applied in registration order, the same order the shots' own hit processing uses.
+		//	IsValidGraze is rechecked per hit, so a laser grazed by several segments only counts once.
+		ref_unsync_weak_ptr<StgIntersectionObject> ptrA = pTargetGraze->GetObject();
+		for (size_t i = 0; i < listGrazeCandidate_.size(); ++i) {
+			if (!listPairHit_[i]) continue;
+			StgIntersectionTarget* targetA = pTargetGraze.get();
+			StgIntersectionTarget* targetB = listTargetB[listGrazeCandidate_[i]].get();
+
+			ref_unsync_weak_ptr<StgIntersectionObject> ptrB = targetB->GetObject();
+			if (ptrA) {
+				ptrA->Intersect(targetA, targetB);
+				ptrA->SetIntersected();
+				if (ptrB)
+					ptrA->AddIntersectedId(ptrB);
+			}
+			if (ptrB) {
+				ptrB->Intersect(targetB, targetA);
+				ptrB->SetIntersected();
+				if (ptrA)
+					ptrB->AddIntersectedId(ptrA);
+			}
+		}
 	}
 }
 void StgIntersectionManager::RenderVisualizer() {
@@ -192,7 +270,11 @@ void StgIntersectionManager::AddTarget(ref_unsync_ptr<StgIntersectionTarget> tar
 		switch (type) {
 		case StgIntersectionTarget::TYPE_PLAYER:
 		{
-			listSpace_[SPACE_PLAYER_ENEMY]->RegistTargetA(target);
+			StgIntersectionTarget_Player* pTarget = dynamic_cast<StgIntersectionTarget_Player*>(target.get());
+			if (pTarget && pTarget->IsGraze())
+				listGrazeTarget_.push_back(target);
+			else
+				listSpace_[SPACE_PLAYER_ENEMY]->RegistTargetA(target);
 			break;
 		}
 		case StgIntersectionTarget::TYPE_PLAYER_SHOT:
@@ -444,12 +526,15 @@ ref_unsync_ptr<StgIntersectionTarget> StgIntersectionCheckList::GetTargetB(size_
 StgIntersectionSpace::StgIntersectionSpace() {
 	spaceRect_ = DxRect<double>(0, 0, 0, 0);
 	previousCheckCreated_ = 0;
+	bGridB_ = false;
+	countCellVisit_ = 0;
 }
 StgIntersectionSpace::~StgIntersectionSpace() {
 }
 bool StgIntersectionSpace::Initialize(double left, double top, double right, double bottom) {
 	spaceRect_ = DxRect<double>(left, top, right, bottom);
 	pooledCheckList_.resize(64U);
+	grid_.Initialize(DxRect<LONG>(left, top, right, bottom));
 	return true;
 }
 bool StgIntersectionSpace::RegistTarget(ListTarget* pVec, ref_unsync_ptr<StgIntersectionTarget>& target) {
@@ -468,6 +553,20 @@ void StgIntersectionSpace::ClearTarget() {
 	}
 }
 
+template<class TFunc>
+void StgIntersectionSpace::_VisitTargetCells(StgIntersectionTarget* target, TFunc&& func) {
+	if (target == nullptr) return;
+	if (target->GetShape() == StgIntersectionTarget::SHAPE_LINE) {
+		//Walk the cells along the line instead of its whole bounding rect, which for a
+		//	screen-crossing laser would cover most of the grid
+		StgIntersectionTarget_Line* pTarget = (StgIntersectionTarget_Line*)target;
+		grid_.VisitLineCells(pTarget->GetLine(), func);
+	}
+	else {
+		grid_.VisitRectCells(target->GetIntersectionSpaceRect(), func);
+	}
+}
+
 std::vector<StgIntersectionSpace::TargetCheckListPair>* StgIntersectionSpace::CreateIntersectionCheckList(
 	StgIntersectionManager* manager, size_t& total) 
 {
@@ -493,7 +592,9 @@ std::vector<StgIntersectionSpace::TargetCheckListPair>* StgIntersectionSpace::Cr
 	}
 
 	if (pListTargetA->size() > 0 && pListTargetB->size() > 0) {
-		auto CheckSpaceRect = [&](StgIntersectionTarget* targetA, StgIntersectionTarget* targetB) {
+		auto CheckSpaceRect = [&](uint32_t indexA, uint32_t indexB) {
+			StgIntersectionTarget* targetA = pListTargetA->at(indexA).get();
+			StgIntersectionTarget* targetB = pListTargetB->at(indexB).get();
 			if (targetA == nullptr || targetB == nullptr) return;
 			const DxRect<LONG>& boundA = targetA->GetIntersectionSpaceRect();
 			const DxRect<LONG>& boundB = targetB->GetIntersectionSpaceRect();
@@ -502,40 +603,50 @@ std::vector<StgIntersectionSpace::TargetCheckListPair>* StgIntersectionSpace::Cr
 				if ((size_t)count >= pooledCheckList_.size()) {
 					pooledCheckList_.resize(pooledCheckList_.size() * 2);
 				}
-				pooledCheckList_[count.load()] = std::make_pair(targetA, targetB);
+				pooledCheckList_[count.load()] = { targetA, targetB, indexA, indexB };
 				++count;
 			}
 		};
 
-		//Attempt to most efficiently utilize multithreading
-		if (pListTargetA->size() >= pListTargetB->size()) {
-			ParallelFor(pListTargetA->size(), [&](size_t iA) {
-				StgIntersectionTarget* pTargetA = pListTargetA->at(iA).get();
-				for (auto itrB = pListTargetB->begin(); itrB != pListTargetB->end(); ++itrB) {
-					StgIntersectionTarget* pTargetB = itrB->get();
-					CheckSpaceRect(pTargetA, pTargetB);
-				}
-			});
-		}
-		else {
-			ParallelFor(pListTargetB->size(), [&](size_t iB) {
-				StgIntersectionTarget* pTargetB = pListTargetB->at(iB).get();
-				for (auto itrA = pListTargetA->begin(); itrA != pListTargetA->end(); ++itrA) {
-					StgIntersectionTarget* pTargetA = itrA->get();
-					CheckSpaceRect(pTargetA, pTargetB);
-				}
+		//Grid the larger list, then query it in parallel with the smaller one
+		bool bGridA = pListTargetA->size() >= pListTargetB->size();
+		ListTarget* pListGrid = bGridA ? pListTargetA : pListTargetB;
+		ListTarget* pListQuery = bGridA ? pListTargetB : pListTargetA;
+
+		grid_.BuildByCells(pListGrid->size(), [&](size_t i, auto&& emit) {
+			_VisitTargetCells(pListGrid->at(i).get(), emit);
+		});
+
+		std::atomic_size_t countVisit = 0;
+		ParallelFor(pListQuery->size(), [&](size_t iQuery) {
+			static thread_local std::vector<uint32_t> listCandidate;
+			listCandidate.clear();
+
+			StgIntersectionTarget* pTargetQuery = pListQuery->at(iQuery).get();
+			_VisitTargetCells(pTargetQuery, [&](LONG cx, LONG cy) {
+				grid_.QueryCell(cx, cy, [&](uint32_t index) {
+					listCandidate.push_back(index);
+				});
 			});
-		}
-		/*
-		//No multithreading mode
-		for (auto itrA = pListTargetA->begin(); itrA != pListTargetA->end(); ++itrA) {
-			StgIntersectionTarget* pTargetA = itrA->get();
-			for (auto itrB = pListTargetB->begin(); itrB != pListTargetB->end(); ++itrB) {
-				StgIntersectionTarget* pTargetB = itrB->get();
-				CheckSpaceRect(pTargetA, pTargetB);
+			countVisit += listCandidate.size();
+
+			//Targets sharing more than one cell are found once per cell
+			std::sort(listCandidate.begin(), listCandidate.end());
+			auto itrEnd = std::unique(listCandidate.begin(), listCandidate.end());
+
+			for (auto itr = listCandidate.begin(); itr != itrEnd; ++itr) {
+				if (bGridA)
+					CheckSpaceRect(*itr, iQuery);
+				else
+					CheckSpaceRect(iQuery, *itr);
 			}
-		}
-		*/
+		});
+		countCellVisit_ = countVisit;
+		bGridB_ = !bGridA;
+	}
+	else {
+		countCellVisit_ = 0;
+		bGridB_ = false;
 	}
 
 	total = (size_t)count;
@@ -543,12 +654,182 @@ std::vector<StgIntersectionSpace::TargetCheckListPair>* StgIntersectionSpace::Cr
 	return &pooledCheckList_;
 }
 
+void StgIntersectionSpace::GetCandidateB(StgIntersectionTarget* target, std::vector<uint32_t>& res) {
+	ListTarget& listTargetB = pairTargetList_.second;
+	const DxRect<LONG>& bound = target->GetIntersectionSpaceRect();
+
+	res.clear();
+	if (bGridB_) {
+		_VisitTargetCells(target, [&](LONG cx, LONG cy) {
+			grid_.QueryCell(cx, cy, [&](uint32_t index) {
+				res.push_back(index);
+			});
+		});
+		std::sort(res.begin(), res.end());
+		res.erase(std::unique(res.begin(), res.end()), res.end());
+		res.erase(std::remove_if(res.begin(), res.end(), [&](uint32_t index) {
+			return !bound.IsIntersected(listTargetB[index]->GetIntersectionSpaceRect());
+		}), res.end());
+	}
+	else {
+		for (size_t i = 0; i < listTargetB.size(); ++i) {
+			if (bound.IsIntersected(listTargetB[i]->GetIntersectionSpaceRect()))
+				res.push_back(i);
+		}
+	}
+}
+
+//*******************************************************************
+//StgIntersectionGrid
+//*******************************************************************
+StgIntersectionGrid::StgIntersectionGrid() {
+	rcSpace_ = DxRect<LONG>(0, 0, 0, 0);
+	cellSize_ = CELL_SIZE;
+	countX_ = 1;
+	countY_ = 1;
+	countItem_ = 0;
+	listCellStart_.resize(2, 0U);
+	listCellCursor_.resize(1, 0U);
+}
+void StgIntersectionGrid::Initialize(const DxRect<LONG>& rcSpace, LONG cellSize) {
+	rcSpace_ = rcSpace;
+	cellSize_ = std::max<LONG>(cellSize, 1);
+	countX_ = std::max<LONG>((rcSpace.GetWidth() + cellSize_ - 1) / cellSize_, 1);
+	countY_ = std::max<LONG>((rcSpace.GetHeight() + cellSize_ - 1) / cellSize_, 1);
+
+	size_t countCell = countX_ * countY_;
+	listCellStart_.resize(countCell + 1U);
+	listCellCursor_.resize(countCell);
+	Clear();
+}
+void StgIntersectionGrid::Clear() {
+	std::fill(listCellStart_.begin(), listCellStart_.end(), 0U);
+	listCellItem_.clear();
+	countItem_ = 0;
+}
+
+//*******************************************************************
+//StgIntersectionArea
+//*******************************************************************
+void StgIntersectionArea::_SetBound(double left, double top, double right, double bottom) {
+	//Padded by a pixel so that truncated object positions always land inside
+	rcBound_ = DxRect<LONG>((LONG)floor(left) - 1, (LONG)floor(top) - 1,
+		(LONG)ceil(right) + 1, (LONG)ceil(bottom) + 1);
+}
+StgIntersectionArea StgIntersectionArea::CreateRect(double left, double top, double right, double bottom) {
+	StgIntersectionArea res;
+	res.type_ = AREA_RECT;
+	if (left > right) std::swap(left, right);
+	if (top > bottom) std::swap(top, bottom);
+	res.param_[0] = left;
+	res.param_[1] = top;
+	res.param_[2] = right;
+	res.param_[3] = bottom;
+	res._SetBound(left, top, right, bottom);
+	return res;
+}
+StgIntersectionArea StgIntersectionArea::CreateRotatedRect(double x, double y, double width, double height, double angle) {
+	StgIntersectionArea res;
+	res.type_ = AREA_ROTATED_RECT;
+
+	double hw = abs(width) * 0.5;
+	double hh = abs(height) * 0.5;
+	double c = cos(Math::DegreeToRadian(angle));
+	double s = sin(Math::DegreeToRadian(angle));
+	res.param_[0] = x;
+	res.param_[1] = y;
+	res.param_[2] = hw;
+	res.param_[3] = hh;
+	res.param_[4] = c;
+	res.param_[5] = s;
+
+	double ex = hw * abs(c) + hh * abs(s);
+	double ey = hw * abs(s) + hh * abs(c);
+	res._SetBound(x - ex, y - ey, x + ex, y + ey);
+	return res;
+}
+StgIntersectionArea StgIntersectionArea::CreateLine(double x1, double y1, double x2, double y2, double width) {
+	StgIntersectionArea res;
+	res.type_ = AREA_LINE;
+
+	double dx = x2 - x1;
+	double dy = y2 - y1;
+	double lenSq = Math::HypotSq(dx, dy);
+	double hw = abs(width) * 0.5;
+	res.param_[0] = x1;
+	res.param_[1] = y1;
+	res.param_[2] = dx;
+	res.param_[3] = dy;
+	res.param_[4] = hw * hw;
+	res.param_[5] = lenSq > 0 ? 1.0 / lenSq : 0.0;
+
+	res._SetBound(std::min(x1, x2) - hw, std::min(y1, y2) - hw, std::max(x1, x2) + hw, std::max(y1, y2) + hw);
+	return res;
+}
+StgIntersectionArea StgIntersectionArea::CreateSector(double x, double y, double radius, double angle, double spread) {
+	StgIntersectionArea res;
+	res.type_ = AREA_SECTOR;
+
+	double r = abs(radius);
+	double halfSpread = std::min(abs(spread), 360.0) * 0.5;
+	res.param_[0] = x;
+	res.param_[1] = y;
+	res.param_[2] = r * r;
+	res.param_[3] = cos(Math::DegreeToRadian(angle));
+	res.param_[4] = sin(Math::DegreeToRadian(angle));
+	res.param_[5] = cos(Math::DegreeToRadian(halfSpread));
+
+	res._SetBound(x - r, y - r, x + r, y + r);
+	return res;
+}
+bool StgIntersectionArea::IsPointInside(double x, double y) const {
+	switch (type_) {
+	case AREA_RECT:
+		return (x >= param_[0] && y >= param_[1]) && (x <= param_[2] && y <= param_[3]);
+	case AREA_ROTATED_RECT:
+	{
+		//Rotate into the rect's local space
+		double dx = x - param_[0];
+		double dy = y - param_[1];
+		double lx = dx * param_[4] + dy * param_[5];
+		double ly = -dx * param_[5] + dy * param_[4];
+		return abs(lx) <= param_[2] && abs(ly) <= param_[3];
+	}
+	case AREA_LINE:
+	{
+		double px = x - param_[0];
+		double py = y - param_[1];
+		double t = std::clamp((px * param_[2] + py * param_[3]) * param_[5], 0.0, 1.0);
+		return Math::HypotSq(px - param_[2] * t, py - param_[3] * t) <= param_[4];
+	}
+	case AREA_SECTOR:
+	{
+		double dx = x - param_[0];
+		double dy = y - param_[1];
+		double distSq = Math::HypotSq(dx, dy);
+		if (distSq > param_[2]) return false;
+		if (distSq == 0) return true;
+		//cos(angle between) >= cos(spread / 2)
+		double dot = dx * param_[3] + dy * param_[4];
+		return dot >= param_[5] * sqrt(distSq);
+	}
+	}
+	return false;
+}
+
 //*******************************************************************
 //StgIntersectionObject
 //*******************************************************************
 StgIntersectionObject::StgIntersectionObject() {
 	bIntersected_ = false;
 	intersectedCount_ = 0;
+
+	StgContainerPool<ref_unsync_weak_ptr<StgIntersectionObject>>::Acquire(listIntersectedID_);
+	StgContainerPool<IntersectionRelativeTarget>::Acquire(listRelativeTarget_);
+}
+StgIntersectionObject::~StgIntersectionObject() {
+	StgContainerPool<ref_unsync_weak_ptr<StgIntersectionObject>>::Recycle(listIntersectedID_);
+	StgContainerPool<IntersectionRelativeTarget>::Recycle(listRelativeTarget_);
 }
 void StgIntersectionObject::Copy(StgIntersectionObject* src) {
 	bIntersected_ = src->bIntersected_;
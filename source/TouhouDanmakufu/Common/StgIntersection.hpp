@@ -38,6 +38,10 @@ public:
 	StgIntersectionTarget();
 	virtual ~StgIntersectionTarget() {}
 
+	//Storage is recycled through StgObjectPool
+	static void* operator new(size_t size) { return StgObjectPool::Allocate(size); }
+	static void operator delete(void* ptr, size_t size) { StgObjectPool::Release(ptr, size); }
+
 	const DxRect<LONG>& GetIntersectionSpaceRect() const { return intersectionSpace_; }
 	void SetIntersectionSpace(const DxRect<LONG>& rect) { intersectionSpace_ = rect; }
 	virtual void SetIntersectionSpace() = 0;
@@ -47,6 +51,8 @@ public:
 	Shape GetShape() const { return shape_; }
 
 	ref_unsync_weak_ptr<StgIntersectionObject> GetObject() { return obj_; }
+	//Doesn't touch the reference count, safe to use from worker threads
+	StgIntersectionObject* GetObjectPointer() const { return obj_.get(); }
 	void SetObject(ref_unsync_weak_ptr<StgIntersectionObject> obj) {
 		if (!obj.expired())
 			obj_ = obj;
@@ -97,6 +103,188 @@ public:
 
 class StgIntersectionTargetPoint;
 
+//*******************************************************************
+//StgIntersectionGrid
+//*******************************************************************
+//Uniform grid of item indices, rebuilt in bulk.
+//Bounds outside of the space are clamped into the border cells, so nothing is ever lost.
+//An item spanning multiple cells is stored (and reported by Query) once per cell.
+class StgIntersectionGrid {
+public:
+	enum {
+		CELL_SIZE = 32,
+	};
+protected:
+	DxRect<LONG> rcSpace_;
+	LONG cellSize_;
+	LONG countX_;
+	LONG countY_;
+	size_t countItem_;
+
+	std::vector<uint32_t> listCellStart_;		//countX_ * countY_ + 1, prefix sums
+	std::vector<uint32_t> listCellCursor_;
+	std::vector<uint32_t> listCellItem_;
+public:
+	StgIntersectionGrid();
+	virtual ~StgIntersectionGrid() {}
+
+	void Initialize(const DxRect<LONG>& rcSpace, LONG cellSize = CELL_SIZE);
+	void Clear();
+
+	const DxRect<LONG>& GetSpaceRect() const { return rcSpace_; }
+	LONG GetCellSize() const { return cellSize_; }
+	LONG GetCellCountX() const { return countX_; }
+	LONG GetCellCountY() const { return countY_; }
+	size_t GetItemCount() const { return countItem_; }
+
+	LONG GetCellX(LONG x) const {
+		return std::clamp<LONG>(x - rcSpace_.left, 0, countX_ * cellSize_ - 1) / cellSize_;
+	}
+	LONG GetCellY(LONG y) const {
+		return std::clamp<LONG>(y - rcSpace_.top, 0, countY_ * cellSize_ - 1) / cellSize_;
+	}
+	DxRect<LONG> GetCellRange(const DxRect<LONG>& rect) const {
+		return DxRect<LONG>(GetCellX(rect.left), GetCellY(rect.top), GetCellX(rect.right), GetCellY(rect.bottom));
+	}
+
+	//func(cx, cy) for every cell touched by the rect
+	template<class TFunc> void VisitRectCells(const DxRect<LONG>& rect, TFunc&& func) const;
+	//func(cx, cy) for every cell touched by the width line, walked row by row along the line
+	template<class TFunc> void VisitLineCells(const DxWidthLine& line, TFunc&& func) const;
+
+	//visit(i, emit) must call emit(cx, cy) for every cell of item i, the same way on both calls
+	template<class TVisit> void BuildByCells(size_t count, TVisit&& visit);
+	template<class TGetBound> void Build(size_t count, TGetBound&& getBound);
+
+	template<class TFunc> void QueryCell(LONG cx, LONG cy, TFunc&& func) const;
+	template<class TFunc> void Query(const DxRect<LONG>& rect, TFunc&& func) const;
+};
+
+template<class TFunc>
+void StgIntersectionGrid::VisitRectCells(const DxRect<LONG>& rect, TFunc&& func) const {
+	DxRect<LONG> rcCell = GetCellRange(rect);
+	for (LONG iy = rcCell.top; iy <= rcCell.bottom; ++iy) {
+		for (LONG ix = rcCell.left; ix <= rcCell.right; ++ix)
+			func(ix, iy);
+	}
+}
+template<class TFunc>
+void StgIntersectionGrid::VisitLineCells(const DxWidthLine& line, TFunc&& func) const {
+	float x1 = line.GetX1(), y1 = line.GetY1();
+	float x2 = line.GetX2(), y2 = line.GetY2();
+	float hw = abs(line.GetWidth()) * 0.5f;
+	float dx = x2 - x1;
+	float dy = y2 - y1;
+
+	LONG cyStart = GetCellY((LONG)floorf(std::min(y1, y2) - hw));
+	LONG cyEnd = GetCellY((LONG)ceilf(std::max(y1, y2) + hw));
+	for (LONG iy = cyStart; iy <= cyEnd; ++iy) {
+		//The row's band, widened by the half width. Border rows extend to infinity.
+		float bandT = iy == 0 ? -FLT_MAX : (float)(rcSpace_.top + iy * cellSize_) - hw;
+		float bandB = iy == countY_ - 1 ? FLT_MAX : (float)(rcSpace_.top + (iy + 1) * cellSize_) + hw;
+
+		//Clip the segment to the band
+		float t0 = 0.0f, t1 = 1.0f;
+		if (dy != 0.0f) {
+			float ta = (bandT - y1) / dy;
+			float tb = (bandB - y1) / dy;
+			if (ta > tb) std::swap(ta, tb);
+			t0 = std::max(t0, ta);
+			t1 = std::min(t1, tb);
+			if (t0 > t1) continue;
+		}
+		else if (y1 < bandT || y1 > bandB) continue;
+
+		float xa = x1 + dx * t0;
+		float xb = x1 + dx * t1;
+		if (xa > xb) std::swap(xa, xb);
+
+		LONG cxStart = GetCellX((LONG)floorf(xa - hw));
+		LONG cxEnd = GetCellX((LONG)ceilf(xb + hw));
+		for (LONG ix = cxStart; ix <= cxEnd; ++ix)
+			func(ix, iy);
+	}
+}
+
+template<class TVisit>
+void StgIntersectionGrid::BuildByCells(size_t count, TVisit&& visit) {
+	countItem_ = count;
+	std::fill(listCellStart_.begin(), listCellStart_.end(), 0U);
+
+	for (size_t i = 0; i < count; ++i) {
+		visit(i, [&](LONG cx, LONG cy) {
+			++listCellStart_[cy * countX_ + cx + 1];
+		});
+	}
+	for (size_t i = 1; i < listCellStart_.size(); ++i)
+		listCellStart_[i] += listCellStart_[i - 1];
+
+	listCellItem_.resize(listCellStart_.back());
+	std::copy(listCellStart_.begin(), listCellStart_.end() - 1, listCellCursor_.begin());
+
+	for (size_t i = 0; i < count; ++i) {
+		visit(i, [&](LONG cx, LONG cy) {
+			listCellItem_[listCellCursor_[cy * countX_ + cx]++] = i;
+		});
+	}
+}
+template<class TGetBound>
+void StgIntersectionGrid::Build(size_t count, TGetBound&& getBound) {
+	BuildByCells(count, [&](size_t i, auto&& emit) {
+		VisitRectCells(getBound(i), emit);
+	});
+}
+template<class TFunc>
+void StgIntersectionGrid::QueryCell(LONG cx, LONG cy, TFunc&& func) const {
+	size_t iCell = cy * countX_ + cx;
+	for (uint32_t i = listCellStart_[iCell]; i < listCellStart_[iCell + 1]; ++i)
+		func(listCellItem_[i]);
+}
+template<class TFunc>
+void StgIntersectionGrid::Query(const DxRect<LONG>& rect, TFunc&& func) const {
+	if (listCellItem_.empty()) return;
+	VisitRectCells(rect, [&](LONG cx, LONG cy) {
+		QueryCell(cx, cy, func);
+	});
+}
+
+//*******************************************************************
+//StgIntersectionArea
+//*******************************************************************
+//Point-containment shapes for the script area queries (GetShotIdInRect, DeleteShotInSector, etc.)
+class StgIntersectionArea {
+public:
+	typedef enum : uint8_t {
+		AREA_RECT,
+		AREA_ROTATED_RECT,
+		AREA_LINE,
+		AREA_SECTOR,
+	} Type;
+protected:
+	Type type_;
+	DxRect<LONG> rcBound_;
+
+	//RECT:			left, top, right, bottom
+	//ROTATED_RECT:	x, y, half width, half height, cos, sin
+	//LINE:			x1, y1, dx, dy, (width / 2)^2, 1 / length^2
+	//SECTOR:		x, y, r^2, cos, sin, cos(spread / 2)
+	double param_[6];
+
+	void _SetBound(double left, double top, double right, double bottom);
+public:
+	StgIntersectionArea() { type_ = AREA_RECT; ZeroMemory(param_, sizeof(param_)); }
+
+	static StgIntersectionArea CreateRect(double left, double top, double right, double bottom);
+	static StgIntersectionArea CreateRotatedRect(double x, double y, double width, double height, double angle);
+	static StgIntersectionArea CreateLine(double x1, double y1, double x2, double y2, double width);
+	static StgIntersectionArea CreateSector(double x, double y, double radius, double angle, double spread);
+
+	Type GetType() const { return type_; }
+	const DxRect<LONG>& GetBounds() const { return rcBound_; }
+
+	bool IsPointInside(double x, double y) const;
+};
+
 //*******************************************************************
 //StgIntersectionManager
 //*******************************************************************
@@ -122,6 +310,30 @@ private:
 	shared_ptr<Shader> shaderVisualizerCircle_;
 	shared_ptr<Shader> shaderVisualizerLine_;
 
+	//A narrow phase hit, applied in (idA, idB, indexA, indexB) order so that the
+	//	outcome doesn't depend on how the pairs were generated
+	struct HitRecord {
+		int idA;
+		int idB;
+		uint32_t indexA;
+		uint32_t indexB;
+		StgIntersectionTarget* targetA;
+		StgIntersectionTarget* targetB;
+
+		bool operator<(const HitRecord& other) const {
+			return std::tie(idA, idB, indexA, indexB) < std::tie(other.idA, other.idB, other.indexA, other.indexB);
+		}
+	};
+	std::vector<uint8_t> listPairHit_;
+	std::vector<HitRecord> listHit_;
+
+	//Player graze circles skip the generic pairing and get their own pass over the player-enemy space
+	std::vector<ref_unsync_ptr<StgIntersectionTarget>> listGrazeTarget_;
+	std::vector<uint32_t> listGrazeCandidate_;
+	size_t countGrazeCheck_;
+
+	void _WorkGraze(StgIntersectionSpace* space);
+
 	CriticalSection lock_;
 public:
 	StgIntersectionManager();
@@ -171,13 +383,25 @@ class StgIntersectionSpace {
 	};
 public:
 	typedef std::vector<ref_unsync_ptr<StgIntersectionTarget>> ListTarget;
-	typedef std::pair<StgIntersectionTarget*, StgIntersectionTarget*> TargetCheckListPair;
+	struct TargetCheckListPair {
+		StgIntersectionTarget* first;
+		StgIntersectionTarget* second;
+		uint32_t indexA;	//Registration index in the A/B lists, used as a stable tie-breaker
+		uint32_t indexB;
+	};
 protected:
 	DxRect<double> spaceRect_;
 
 	size_t previousCheckCreated_;
 	std::pair<ListTarget, ListTarget> pairTargetList_;
 	std::vector<TargetCheckListPair> pooledCheckList_;
+
+	//Broadphase over the larger target list, the smaller one is queried against it
+	StgIntersectionGrid grid_;
+	bool bGridB_;
+	size_t countCellVisit_;
+
+	template<class TFunc> void _VisitTargetCells(StgIntersectionTarget* target, TFunc&& func);
 public:
 	StgIntersectionSpace();
 	virtual ~StgIntersectionSpace();
@@ -190,6 +414,12 @@ public:
 	void ClearTarget();
 
 	std::vector<TargetCheckListPair>* CreateIntersectionCheckList(StgIntersectionManager* manager, size_t& total);
+
+	size_t GetTargetCount() { return pairTargetList_.first.size() + pairTargetList_.second.size(); }
+	ListTarget& GetTargetListB() { return pairTargetList_.second; }
+	//Indices of the B targets whose bounds intersect the target's, ascending. Valid until ClearTarget.
+	void GetCandidateB(StgIntersectionTarget* target, std::vector<uint32_t>& res);
+	size_t GetCellVisitCount() { return countCellVisit_; }
 };
 
 class StgIntersectionObject {
@@ -213,7 +443,7 @@ protected:
 	std::vector<IntersectionRelativeTarget> listRelativeTarget_;
 public:
 	StgIntersectionObject();
-	virtual ~StgIntersectionObject() {}
+	virtual ~StgIntersectionObject();
 
 	void Copy(StgIntersectionObject* src);
 
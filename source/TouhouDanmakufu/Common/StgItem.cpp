@@ -44,16 +44,23 @@ StgItemManager::StgItemManager(StgStageController* stageController) {
 	{
 		RenderShaderLibrary* shaderManager_ = ShaderManager::GetBase()->GetRenderLib();
 		effectItem_ = shaderManager_->GetRender2DShader();
+		semanticItem_ = shaderManager_->GetRender2DSemantic();
+		effectInstance_ = shaderManager_->GetInstancingSpriteShader();
+		semanticInstance_ = shaderManager_->GetInstancingSpriteSemantic();
 	}
-	{
-		size_t renderPriMax = stageController_->GetMainObjectManager()->GetRenderBucketCapacity();
+	bRenderInstancing_ = false;
+	pBatchTexture_ = nullptr;
+	countRenderCulled_ = 0;
+	countRenderPriority_ = stageController_->GetMainObjectManager()->GetRenderBucketCapacity();
+	pLastTexture_ = nullptr;
 
-		listRenderQueue_.resize(renderPriMax);
-		for (size_t i = 0; i < renderPriMax; ++i) {
-			listRenderQueue_[i].listItem.resize(32);
-		}
+	{
+		DirectGraphics* graphics = DirectGraphics::GetBase();
+		LONG screenWidth = graphics->GetScreenWidth();
+		LONG screenHeight = graphics->GetScreenHeight();
+		gridSpatialIndex_.Initialize(DxRect<LONG>(-64, -64, screenWidth + 64, screenHeight + 64));
+		bSpatialIndexValid_ = false;
 	}
-	pLastTexture_ = nullptr;
 }
 StgItemManager::~StgItemManager() {
 }
@@ -66,6 +73,21 @@ void StgItemManager::Work() {
 	int pr = objPlayer->GetItemIntersectionRadius() * objPlayer->GetItemIntersectionRadius();
 	int pAutoItemCollectY = objPlayer->GetAutoItemCollectY();
 
+	//CollectItemsInCircle: resolve the circles through the spatial index, the first matching circle wins
+	mapCircleHit_.clear();
+	for (DxCircle& circle : listCircleToPlayer_) {
+		float rr = circle.GetR() * circle.GetR();
+		DxRect<LONG> rcBox(floorf(circle.GetX() - circle.GetR()) - 1, floorf(circle.GetY() - circle.GetR()) - 1,
+			ceilf(circle.GetX() + circle.GetR()) + 1, ceilf(circle.GetY() + circle.GetR()) + 1);
+		for (uint32_t index : _QuerySpatialIndex(rcBox)) {
+			StgItemObject* obj = listSpatialIndexObj_[index];
+			float ix = obj->GetPositionX();
+			float iy = obj->GetPositionY();
+			if (Math::HypotSq(ix - circle.GetX(), iy - circle.GetY()) <= rr)
+				mapCircleHit_.emplace(obj, &circle);
+		}
+	}
+
 	for (auto itr = listObj_.begin(); itr != listObj_.end();) {
 		ref_unsync_ptr<StgItemObject>& obj = *itr;
 
@@ -126,14 +148,12 @@ void StgItemManager::Work() {
 					}
 
 					//CollectItemsInCircle collection
-					if (moveToPlayerFlags & StgItemObject::FLAG_MOVETOPL_COLLECT_CIRCLE) {
-						for (DxCircle& circle : listCircleToPlayer_) {
-							float rr = circle.GetR() * circle.GetR();
-							if (Math::HypotSq(ix - circle.GetX(), iy - circle.GetY()) <= rr) {
-								typeCollect = StgItemObject::COLLECT_IN_CIRCLE;
-								collectParam = (uint64_t)circle.GetR();
-								goto lab_move_to_player;
-							}
+					if ((moveToPlayerFlags & StgItemObject::FLAG_MOVETOPL_COLLECT_CIRCLE) && mapCircleHit_.size() > 0) {
+						auto itrHit = mapCircleHit_.find(obj.get());
+						if (itrHit != mapCircleHit_.end()) {
+							typeCollect = StgItemObject::COLLECT_IN_CIRCLE;
+							collectParam = (uint64_t)itrHit->second->GetR();
+							goto lab_move_to_player;
 						}
 					}
 
@@ -153,6 +173,37 @@ lab_next_item:
 
 	bAllItemToPlayer_ = false;
 	bCancelToPlayer_ = false;
+	bSpatialIndexValid_ = false;
+}
+
+void StgItemManager::_UpdateSpatialIndex() {
+	if (bSpatialIndexValid_) return;
+
+	listSpatialIndexObj_.clear();
+	for (ref_unsync_ptr<StgItemObject>& obj : listObj_) {
+		if (!obj->IsDeleted())
+			listSpatialIndexObj_.push_back(obj.get());
+	}
+
+	gridSpatialIndex_.Build(listSpatialIndexObj_.size(), [&](size_t i) {
+		StgItemObject* obj = listSpatialIndexObj_[i];
+		LONG ix = obj->GetPositionX();
+		LONG iy = obj->GetPositionY();
+		return DxRect<LONG>(ix, iy, ix, iy);
+	});
+	bSpatialIndexValid_ = true;
+}
+std::vector<uint32_t>& StgItemManager::_QuerySpatialIndex(const DxRect<LONG>& rect) {
+	_UpdateSpatialIndex();
+
+	listSpatialQueryResult_.clear();
+	gridSpatialIndex_.Query(rect, [&](uint32_t index) {
+		listSpatialQueryResult_.push_back(index);
+	});
+
+	//Keep the results in creation order, same as a linear scan of listObj_
+	std::sort(listSpatialQueryResult_.begin(), listSpatialQueryResult_.end());
+	return listSpatialQueryResult_;
 }
 
 std::array<BlendMode, StgItemManager::BLEND_COUNT> StgItemManager::blendTypeRenderOrder = {
@@ -166,10 +217,11 @@ std::array<BlendMode, StgItemManager::BLEND_COUNT> StgItemManager::blendTypeRend
 	MODE_BLEND_ALPHA_INV,
 };
 void StgItemManager::Render(int targetPriority) {
-	if (targetPriority < 0 || targetPriority >= listRenderQueue_.size()) return;
+	if (targetPriority < 0 || targetPriority >= listRenderIndex_.GetBucketCount()) return;
 
-	const RenderQueue& renderQueue = listRenderQueue_[targetPriority];
-	if (renderQueue.count == 0) return;
+	const uint32_t* pQueueBegin = listRenderIndex_.GetBucketBegin(targetPriority);
+	const uint32_t* pQueueEnd = listRenderIndex_.GetBucketEnd(targetPriority);
+	if (pQueueBegin == pQueueEnd) return;
 
 	DirectGraphics* graphics = DirectGraphics::GetBase();
 	IDirect3DDevice9* device = graphics->GetDevice();
@@ -181,8 +233,7 @@ void StgItemManager::Render(int targetPriority) {
 	graphics->SetLightingEnable(false);
 	graphics->SetTextureFilter(filterMin_, filterMag_, D3DTEXF_NONE);
 
-	DWORD bEnableFog = FALSE;
-	device->GetRenderState(D3DRS_FOGENABLE, &bEnableFog);
+	bool bEnableFog = graphics->IsFogEnable();
 	if (bEnableFog)
 		graphics->SetFogEnable(false);
 
@@ -193,8 +244,8 @@ void StgItemManager::Render(int targetPriority) {
 
 	//Render default items and score texts
 	{
-		for (size_t i = 0; i < renderQueue.count; ++i) {
-			StgItemObject* pItem = renderQueue.listItem[i];
+		for (const uint32_t* pItr = pQueueBegin; pItr != pQueueEnd; ++pItr) {
+			StgItemObject* pItem = listRenderObj_[*pItr];
 			pItem->RenderOnItemManager();
 		}
 
@@ -211,7 +262,7 @@ void StgItemManager::Render(int targetPriority) {
 	device->SetVertexDeclaration(shaderManager->GetVertexDeclarationTLX());
 	pLastTexture_ = nullptr;
 
-	if (D3DXHANDLE handle = effectItem_->GetParameterBySemantic(nullptr, "VIEWPROJECTION")) {
+	if (D3DXHANDLE handle = semanticItem_->Get(ShaderSemanticTable::VIEWPROJECTION)) {
 		effectItem_->SetMatrix(handle, &matProj_);
 	}
 
@@ -220,11 +271,14 @@ void StgItemManager::Render(int targetPriority) {
 
 		graphics->SetBlendMode(blend);
 		effectItem_->SetTechnique(blend == MODE_BLEND_ALPHA_INV ? "RenderInv" : "Render");
+		if (bRenderInstancing_)
+			effectInstance_->SetTechnique(blend == MODE_BLEND_ALPHA_INV ? "RenderInv" : "Render");
 
-		for (size_t i = 0; i < renderQueue.count; ++i) {
-			StgItemObject* pItem = renderQueue.listItem[i];
+		for (const uint32_t* pItr = pQueueBegin; pItr != pQueueEnd; ++pItr) {
+			StgItemObject* pItem = listRenderObj_[*pItr];
 			pItem->Render(blend);	//Render custom items
 		}
+		FlushRenderBatch();
 	}
 
 	device->SetVertexShader(nullptr);
@@ -235,20 +289,70 @@ void StgItemManager::Render(int targetPriority) {
 	if (bEnableFog)
 		graphics->SetFogEnable(true);
 }
-void StgItemManager::LoadRenderQueue() {
-	for (size_t i = 0; i < listRenderQueue_.size(); ++i) {
-		listRenderQueue_[i].count = 0;
+void StgItemManager::AddRenderBatch(IDirect3DTexture9* texture, const VERTEX_TLX* quad, const D3DXMATRIX& matWorld, D3DCOLOR color) {
+	if (texture != pBatchTexture_) {
+		FlushRenderBatch();
+		pBatchTexture_ = texture;
+	}
+	if (!streamInstance_.AddInstance(quad, matWorld, color)) {
+		FlushRenderBatch();
+		streamInstance_.AddInstance(quad, matWorld, color);
 	}
+}
+void StgItemManager::FlushRenderBatch() {
+	if (streamInstance_.GetInstanceCount() == 0) return;
 
-	for (ref_unsync_ptr<StgItemObject>& obj : listObj_) {
-		if (obj->IsDeleted() || !obj->IsActive() || !obj->IsVisible()) continue;
+	DirectGraphics* graphics = DirectGraphics::GetBase();
+	IDirect3DDevice9* device = graphics->GetDevice();
+
+	if (graphics->IsAllowRenderTargetChange())
+		graphics->SetRenderTarget(nullptr);
+
+	if (pBatchTexture_ != pLastTexture_) {
+		device->SetTexture(0, pBatchTexture_);
+		pLastTexture_ = pBatchTexture_;
+	}
 
-		auto& [count, listItem] = listRenderQueue_[obj->GetRenderPriorityI()];
+	streamInstance_.Render(effectInstance_, semanticInstance_, matProj_);
+}
+void StgItemManager::LoadRenderQueue() {
+	listRenderObj_.resize(listObj_.size());
+	{
+		size_t i = 0;
+		for (ref_unsync_ptr<StgItemObject>& obj : listObj_)
+			listRenderObj_[i++] = obj.get();
+	}
 
-		while (count >= listItem.size())
-			listItem.resize(listItem.size() * 2);
-		listItem[count++] = obj.get();
+	{
+		//The 2D camera is only enabled for priorities within the STG frame,
+		//	and is reset to the default focus after the camera priority
+		StgStageInformation* stageInfo = stageController_->GetStageInformation().get();
+		int priMinFrame = stageInfo->GetStgFrameMinPriority();
+		int priMaxFrame = std::min(stageInfo->GetStgFrameMaxPriority(), 
+			stageInfo->GetCameraFocusPermitPriority());
+
+		cullRender_.Reset(listRenderObj_.size());
+		for (size_t i = 0; i < listRenderObj_.size(); ++i) {
+			StgItemObject* obj = listRenderObj_[i];
+			if (obj->IsDeleted() || !obj->IsActive() || !obj->IsVisible()) continue;
+
+			int pri = obj->GetRenderPriorityI();
+			if (pri < priMinFrame || pri > priMaxFrame) continue;
+
+			D3DXVECTOR2 pos;
+			float radius = obj->GetRenderBound(&pos);
+			if (radius != StgRenderCuller::RADIUS_NO_CULL)
+				cullRender_.SetCircle(i, pos, radius);
+		}
+		countRenderCulled_ = cullRender_.Cull(DirectGraphics::GetBase()->GetCamera2D()->GetVisibleRect());
 	}
+
+	listRenderIndex_.Build(listRenderObj_.size(), countRenderPriority_, [&](size_t i) -> uint32_t {
+		StgItemObject* obj = listRenderObj_[i];
+		if (obj->IsDeleted() || !obj->IsActive() || !obj->IsVisible() || !cullRender_.IsVisible(i)) 
+			return BucketIndexList::KEY_SKIP;
+		return std::clamp<int>(obj->GetRenderPriorityI(), 0, (int)countRenderPriority_ - 1);
+	});
 }
 
 bool StgItemManager::LoadItemData(const std::wstring& path, bool bReload) {
@@ -292,26 +396,50 @@ void StgItemManager::CancelCollectItems() {
 }
 
 std::vector<int> StgItemManager::GetItemIdInCircle(int cx, int cy, optional<int> radius, optional<int> itemType) {
-	int r = radius.has_value() ? *radius : 0;
+	std::vector<int> res;
+
+	if (!radius.has_value()) {
+		for (ref_unsync_ptr<StgItemObject>& obj : listObj_) {
+			if (obj->IsDeleted()) continue;
+			if (itemType.has_value() && (*itemType != obj->GetItemType())) continue;
+			res.push_back(obj->GetObjectID());
+		}
+		return res;
+	}
+
+	int r = *radius;
 	int rr = r * r;
 
-	std::vector<int> res;
-	for (ref_unsync_ptr<StgItemObject>& obj : listObj_) {
+	DxRect<LONG> rcBox(cx - r - 1, cy - r - 1, cx + r + 1, cy + r + 1);
+	for (uint32_t index : _QuerySpatialIndex(rcBox)) {
+		StgItemObject* obj = listSpatialIndexObj_[index];
 		if (obj->IsDeleted()) continue;
 		if (itemType.has_value() && (*itemType != obj->GetItemType())) continue;
 
-		bool bInRadius = Math::HypotSq<int>(cx - obj->GetPositionX(), cy - obj->GetPositionY()) <= rr;
-		if (!radius.has_value() || bInRadius)
+		if (Math::HypotSq<int>(cx - obj->GetPositionX(), cy - obj->GetPositionY()) <= rr)
 			res.push_back(obj->GetObjectID());
 	}
 
 	return res;
 }
+std::vector<int> StgItemManager::GetItemIdInArea(const StgIntersectionArea& area, optional<int> itemType) {
+	std::vector<int> res;
+	for (uint32_t index : _QuerySpatialIndex(area.GetBounds())) {
+		StgItemObject* obj = listSpatialIndexObj_[index];
+		if (obj->IsDeleted()) continue;
+		if (itemType.has_value() && (*itemType != obj->GetItemType())) continue;
+
+		if (area.IsPointInside(obj->GetPositionX(), obj->GetPositionY()))
+			res.push_back(obj->GetObjectID());
+	}
+	return res;
+}
 
 //*******************************************************************
 //StgItemDataList
 //*******************************************************************
 StgItemDataList::StgItemDataList() {
+	atlas_.Initialize(EPathProperty::GetCacheDirectory() + L"atlas/");
 }
 StgItemDataList::~StgItemDataList() {
 }
@@ -321,13 +449,37 @@ void StgItemDataList::_LoadVertexBuffers(std::map<std::wstring, VBContainerList>
 	DirectGraphics* graphics = DirectGraphics::GetBase();
 	IDirect3DDevice9* device = graphics->GetDevice();
 
-	float texW = texture->GetWidth();
-	float texH = texture->GetHeight();
-
 	size_t countFrame = 0;
 	for (StgItemData* iData : listAddData)
 		countFrame += iData->GetFrameCount();
 
+	//Pack the frames into the atlas, the ones that don't fit stay on the item sheet
+	{
+		std::vector<TextureAtlas::Region> listRegion;
+		listRegion.reserve(countFrame);
+		for (StgItemData* iData : listAddData) {
+			for (StgItemDataFrame& iFrame : iData->listFrame_)
+				listRegion.push_back({ iFrame.rcSrc_ });
+		}
+
+		atlas_.AddSource(placement->first, texture, listRegion);
+
+		auto itrRegion = listRegion.begin();
+		for (StgItemData* iData : listAddData) {
+			for (StgItemDataFrame& iFrame : iData->listFrame_) {
+				TextureAtlas::Region& region = *(itrRegion++);
+				if (region.page != TextureAtlas::PAGE_NONE) {
+					iFrame.texture_ = atlas_.GetPage(region.page);
+					iFrame.rcTexture_ = region.rcAtlas;
+				}
+				else {
+					iFrame.texture_ = texture;
+					iFrame.rcTexture_ = iFrame.rcSrc_;
+				}
+			}
+		}
+	}
+
 	size_t iBuffer = 0;
 	while (countFrame > 0) {
 		size_t thisCountFrame = std::min<size_t>(countFrame, StgShotVertexBufferContainer::MAX_DATA);
@@ -347,7 +499,10 @@ void StgItemDataList::_LoadVertexBuffers(std::map<std::wstring, VBContainerList>
 				StgItemDataFrame* pFrame = &data->listFrame_[iAnim];
 				pFrame->listItemData_ = this;
 
-				LONG* ptrSrc = reinterpret_cast<LONG*>(&pFrame->rcSrc_);
+				float texW = pFrame->texture_->GetWidth();
+				float texH = pFrame->texture_->GetHeight();
+
+				LONG* ptrSrc = reinterpret_cast<LONG*>(&pFrame->rcTexture_);
 				float* ptrDst = reinterpret_cast<float*>(&pFrame->rcDst_);
 
 				for (size_t iVert = 0; iVert < 4; ++iVert) {
@@ -375,6 +530,7 @@ void StgItemDataList::_LoadVertexBuffers(std::map<std::wstring, VBContainerList>
 
 				for (size_t j = 0; j < 4; ++j)
 					bufferVertex[iVertex + j] = verts[j];
+				pFrame->quad_.Load(verts);
 				iVertex += 4;
 			}
 		}
@@ -747,7 +903,7 @@ void StgItemObject::Work() {
 		bool bNullMovePattern = dynamic_cast<StgMovePattern_Item*>(GetPattern().get()) == nullptr;
 		if (bNullMovePattern && bDefaultCollectionMove_ && IsMoveToPlayer()) {
 			float speed = 8;
-			ref_unsync_ptr<StgPlayerObject> objPlayer = stageController_->GetPlayerObject();
+			StgPlayerObject* objPlayer = stageController_->GetPlayerObjectPointer();
 			if (objPlayer) {
 				float angle = atan2f(objPlayer->GetY() - GetPositionY(), objPlayer->GetX() - GetPositionX());
 				float angDirection = angle;
@@ -764,6 +920,14 @@ void StgItemObject::Work() {
 
 	++frameWork_;
 }
+float StgItemObject::GetRenderBound(D3DXVECTOR2* pos) {
+	//Score digits grow with the score
+	if (typeItem_ == ITEM_SCORE_TEXT) return StgRenderCuller::RADIUS_NO_CULL;
+
+	//Same placement as in RenderOnItemManager, items above the frame show a marker at the top
+	*pos = D3DXVECTOR2((float)posX_, posY_ <= 0 ? 6.0f : (float)posY_);
+	return 16.0f;
+}
 void StgItemObject::RenderOnItemManager() {
 	StgItemManager* itemManager = stageController_->GetItemManager();
 	SpriteList2D* renderer = typeItem_ == ITEM_SCORE_TEXT ?
@@ -929,6 +1093,16 @@ void StgItemObject::SetColor(int r, int g, int b) {
 	__m128i c = Vectorize::Set(color_ >> 24, r, g, b);
 	color_ = ColorAccess::ToD3DCOLOR(ColorAccess::ClampColorPacked(c));
 }
+void StgItemObject::SetX(float x) {
+	posX_ = x;
+	DxScriptRenderObject::SetX(x);
+	stageController_->GetItemManager()->InvalidateSpatialIndex();
+}
+void StgItemObject::SetY(float y) {
+	posY_ = y;
+	DxScriptRenderObject::SetY(y);
+	stageController_->GetItemManager()->InvalidateSpatialIndex();
+}
 void StgItemObject::SetToPosition(D3DXVECTOR2& pos) {
 	if (auto move = ref_unsync_ptr<StgMovePattern_Item>::Cast(pattern_))
 		move->SetToPosition(pos);
@@ -1149,6 +1323,27 @@ void StgItemObject_User::Work() {
 	StgItemObject::Work();
 	++frameWork_;
 }
+float StgItemObject_User::GetRenderBound(D3DXVECTOR2* pos) {
+	if (shader_ != nullptr || !renderTarget_.expired()) return StgRenderCuller::RADIUS_NO_CULL;
+
+	StgItemData* itemData = _GetItemData();
+	if (itemData == nullptr) return StgRenderCuller::RADIUS_NO_CULL;
+
+	//Same frame and placement as in Render
+	StgItemDataFrame* itemFrame = itemData->GetFrame(frameWork_);
+	DxRect<LONG>* rcSrc = itemFrame->GetSourceRect();
+	if (position_.y + rcSrc->GetHeight() / 2 <= 0) {
+		StgItemData* outData = itemData->GetOutData();
+		StgItemDataFrame* outFrame = outData ? outData->GetFrame(0) : nullptr;
+		if (outFrame == nullptr) return StgRenderCuller::RADIUS_NO_CULL;
+
+		*pos = D3DXVECTOR2(position_.x, (rcSrc->bottom - rcSrc->top) / 2);
+		return outFrame->GetRadius();
+	}
+
+	*pos = D3DXVECTOR2(position_.x, position_.y);
+	return itemFrame->GetRadius() * std::max(fabsf(scale_.x), fabsf(scale_.y));
+}
 void StgItemObject_User::Render(BlendMode targetBlend) {
 	//if (!IsVisible()) return;
 	StgItemManager* itemManager = stageController_->GetItemManager();
@@ -1201,6 +1396,19 @@ void StgItemObject_User::Render(BlendMode targetBlend) {
 			DWORD vertexOffset = targetFrame->vertexOffset_;
 
 			if (pVB) {
+				//Custom shaders and render targets still need their own draw
+				if (itemManager->IsRenderInstancingEnable() && shader_ == nullptr && renderTarget_.expired()) {
+					D3DXMATRIX matTransform(
+						rScale.x * rAngle.x, rScale.x * rAngle.y, 0, 0,
+						rScale.y * -rAngle.y, rScale.y * rAngle.x, 0, 0,
+						0, 0, 1, 0,
+						rPos.x, rPos.y, 0, 1
+					);
+					itemManager->AddRenderBatch(targetFrame->GetD3DTexture(), targetFrame->GetQuadVertex(), matTransform, rColor);
+					return;
+				}
+				itemManager->FlushRenderBatch();
+
 				DirectGraphics* graphics = DirectGraphics::GetBase();
 				IDirect3DDevice9* device = graphics->GetDevice();
 
@@ -1210,7 +1418,7 @@ void StgItemObject_User::Render(BlendMode targetBlend) {
 					else graphics->SetRenderTarget(nullptr);
 				}
 
-				IDirect3DTexture9* pTexture = pVB->GetD3DTexture();
+				IDirect3DTexture9* pTexture = targetFrame->GetD3DTexture();
 				if (pTexture != itemManager->pLastTexture_) {
 					device->SetTexture(0, pTexture);
 					itemManager->pLastTexture_ = pTexture;
@@ -1219,8 +1427,10 @@ void StgItemObject_User::Render(BlendMode targetBlend) {
 
 				{
 					ID3DXEffect* effect = itemManager->GetEffect();
+					const ShaderSemanticTable* semantic = itemManager->GetEffectSemantic();
 					if (shader_) {
 						effect = shader_->GetEffect();
+						semantic = shader_->GetSemanticTable();
 						if (shader_->LoadTechnique()) {
 							shader_->LoadParameter();
 						}
@@ -1228,7 +1438,7 @@ void StgItemObject_User::Render(BlendMode targetBlend) {
 
 					if (effect) {
 						D3DXHANDLE handle = nullptr;
-						if (handle = effect->GetParameterBySemantic(nullptr, "WORLD")) {
+						if (handle = semantic->Get(ShaderSemanticTable::WORLD)) {
 							D3DXMATRIX matTransform(
 								rScale.x * rAngle.x, rScale.x * rAngle.y, 0, 0,
 								rScale.y * -rAngle.y, rScale.y * rAngle.x, 0, 0,
@@ -1238,11 +1448,11 @@ void StgItemObject_User::Render(BlendMode targetBlend) {
 							effect->SetMatrix(handle, &matTransform);
 						}
 						if (shader_) {
-							if (handle = effect->GetParameterBySemantic(nullptr, "VIEWPROJECTION")) {
+							if (handle = semantic->Get(ShaderSemanticTable::VIEWPROJECTION)) {
 								effect->SetMatrix(handle, itemManager->GetProjectionMatrix());
 							}
 						}
-						if (handle = effect->GetParameterBySemantic(nullptr, "ICOLOR")) {
+						if (handle = semantic->Get(ShaderSemanticTable::ICOLOR)) {
 							//To normalized RGBA vector
 							D3DXVECTOR4 vColor = ColorAccess::ToVec4Normalized(rColor, ColorAccess::PERMUTE_RGBA);
 							effect->SetVector(handle, &vColor);
@@ -1252,7 +1462,7 @@ void StgItemObject_User::Render(BlendMode targetBlend) {
 						effect->Begin(&countPass, D3DXFX_DONOTSAVESHADERSTATE);
 						for (UINT iPass = 0; iPass < countPass; ++iPass) {
 							effect->BeginPass(iPass);
-							device->DrawPrimitive(D3DPT_TRIANGLESTRIP, 0, 2);
+							graphics->DrawPrimitive(D3DPT_TRIANGLESTRIP, 0, 2);
 							effect->EndPass();
 						}
 						effect->End();
@@ -1309,7 +1519,7 @@ void StgMovePattern_Item::Move() {
 	if (typeMove_ == MOVE_TOPLAYER || (itemObject->IsDefaultCollectionMovement() && itemObject->IsMoveToPlayer())) {
 		if (frame_ == 0) speed_ = 6;
 		speed_ += 0.075;
-		ref_unsync_ptr<StgPlayerObject> objPlayer = stageController->GetPlayerObject();
+		StgPlayerObject* objPlayer = stageController->GetPlayerObjectPointer();
 		if (objPlayer) {
 			double angle = atan2(objPlayer->GetY() - py, objPlayer->GetX() - px);
 			angDirection_ = angle;
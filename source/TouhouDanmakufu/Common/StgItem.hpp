@@ -24,10 +24,6 @@ public:
 	};
 protected:
 	static std::array<BlendMode, BLEND_COUNT> blendTypeRenderOrder;
-	struct RenderQueue {
-		size_t count;
-		std::vector<StgItemObject*> listItem;
-	};
 protected:
 	StgStageController* stageController_;
 
@@ -37,9 +33,18 @@ protected:
 	unique_ptr<StgItemDataList> listItemData_;
 
 	std::list<ref_unsync_ptr<StgItemObject>> listObj_;
-	std::vector<RenderQueue> listRenderQueue_;		//one for each render pri
+
+	//Items snapshotted once per frame, visible ones bucketed by render pri as indices into listRenderObj_
+	size_t countRenderPriority_;
+	std::vector<StgItemObject*> listRenderObj_;
+	BucketIndexList listRenderIndex_;
+
+	//Items outside the camera's view are left out of the render queue
+	StgRenderCuller cullRender_;
+	size_t countRenderCulled_;
 
 	std::list<DxCircle> listCircleToPlayer_;
+	std::unordered_map<StgItemObject*, const DxCircle*> mapCircleHit_;		//Kept across frames to reuse its buckets
 
 	DxRect<LONG> rcDeleteClip_;
 
@@ -51,7 +56,24 @@ protected:
 	bool bDefaultBonusItemEnable_;
 
 	ID3DXEffect* effectItem_;
+	const ShaderSemanticTable* semanticItem_;
 	D3DXMATRIX matProj_;
+
+	//Opt-in, consecutive default-rendered items that share a texture are drawn as one instanced call
+	bool bRenderInstancing_;
+	StgInstanceStream streamInstance_;
+	IDirect3DTexture9* pBatchTexture_;
+	ID3DXEffect* effectInstance_;
+	const ShaderSemanticTable* semanticInstance_;
+
+	//Spatial index for the script area queries, rebuilt lazily whenever an item moves or is added
+	std::atomic_bool bSpatialIndexValid_;		//Items can move on worker threads
+	StgIntersectionGrid gridSpatialIndex_;
+	std::vector<StgItemObject*> listSpatialIndexObj_;
+	std::vector<uint32_t> listSpatialQueryResult_;
+
+	void _UpdateSpatialIndex();
+	std::vector<uint32_t>& _QuerySpatialIndex(const DxRect<LONG>& rect);
 public:
 	IDirect3DTexture9* pLastTexture_;
 public:
@@ -61,13 +83,25 @@ public:
 	void Work();
 	void Render(int targetPriority);
 	void LoadRenderQueue();
+	const BucketIndexList& GetRenderQueue() { return listRenderIndex_; }
+	StgItemObject* GetRenderQueueObject(uint32_t index) { return listRenderObj_[index]; }
+	size_t GetRenderVisibleCount() { return listRenderIndex_.GetSize(); }
+	size_t GetRenderCulledCount() { return countRenderCulled_; }
 
 	void AddItem(ref_unsync_ptr<StgItemObject> obj) {
 		listObj_.push_back(obj); 
+		bSpatialIndexValid_ = false;
 	}
 	size_t GetItemCount() { return listObj_.size(); }
 
+	void AddRenderBatch(IDirect3DTexture9* texture, const VERTEX_TLX* quad, const D3DXMATRIX& matWorld, D3DCOLOR color);
+	void FlushRenderBatch();
+
+	void SetRenderInstancingEnable(bool bEnable) { bRenderInstancing_ = bEnable; }
+	bool IsRenderInstancingEnable() { return bRenderInstancing_; }
+
 	ID3DXEffect* GetEffect() { return effectItem_; }
+	const ShaderSemanticTable* GetEffectSemantic() { return semanticItem_; }
 	D3DXMATRIX* GetProjectionMatrix() { return &matProj_; }
 
 	SpriteList2D* GetItemRenderer() { return listSpriteItem_.get(); }
@@ -91,7 +125,10 @@ public:
 	void CollectItemsInCircle(const DxCircle& circle);
 	void CancelCollectItems();
 
+	void InvalidateSpatialIndex() { bSpatialIndexValid_ = false; }
+
 	std::vector<int> GetItemIdInCircle(int cx, int cy, optional<int> radius, optional<int> itemType);
+	std::vector<int> GetItemIdInArea(const StgIntersectionArea& area, optional<int> itemType);
 
 	bool IsDefaultBonusItemEnable() { return bDefaultBonusItemEnable_; }
 	void SetDefaultBonusItemEnable(bool bEnable) { bDefaultBonusItemEnable_ = bEnable; }
@@ -108,6 +145,8 @@ private:
 	std::map<std::wstring, VBContainerList> mapVertexBuffer_;	//<shot data file, vb list>
 	std::vector<unique_ptr<StgItemData>> listData_;
 
+	TextureAtlas atlas_;
+
 	void _ScanItem(std::map<int, unique_ptr<StgItemData>>& mapData, Scanner& scanner);
 	static void _ScanAnimation(StgItemData* itemData, Scanner& scanner);
 
@@ -162,16 +201,32 @@ struct StgItemDataFrame {
 	DxRect<LONG> rcSrc_;
 	DxRect<float> rcDst_;
 
+	shared_ptr<Texture> texture_;	//Atlas page the frame was packed into, or the item sheet
+	DxRect<LONG> rcTexture_;		//rcSrc_ on texture_
+
+	StgRenderQuad quad_;
+
 	size_t frame_;
 public:
 	StgItemDataFrame();
 
 	DxRect<LONG>* GetSourceRect() { return &rcSrc_; }
 	DxRect<float>* GetDestRect() { return &rcDst_; }
+	//Distance from the frame's origin to its farthest corner
+	float GetRadius() {
+		float dx = std::max(fabsf(rcDst_.left), fabsf(rcDst_.right));
+		float dy = std::max(fabsf(rcDst_.top), fabsf(rcDst_.bottom));
+		return sqrtf(dx * dx + dy * dy);
+	}
 	StgShotVertexBufferContainer* GetVertexBufferContainer() {
 		return pVertexBuffer_;
 	}
 
+	shared_ptr<Texture> GetTexture() { return texture_; }
+	IDirect3DTexture9* GetD3DTexture() { return texture_ ? texture_->GetD3DTexture() : nullptr; }
+	const DxRect<LONG>* GetTextureRect() { return &rcTexture_; }
+	const VERTEX_TLX* GetQuadVertex() { return quad_.Get(); }
+
 	static DxRect<float> LoadDestRect(DxRect<LONG>* src);
 };
 
@@ -180,6 +235,10 @@ public:
 //*******************************************************************
 class StgItemObject : public DxScriptShaderObject, public StgMoveObject, public StgIntersectionObject {
 	friend StgItemManager;
+public:
+	//Storage is recycled through StgObjectPool
+	static void* operator new(size_t size) { return StgObjectPool::Allocate(size); }
+	static void operator delete(void* ptr, size_t size) { StgObjectPool::Release(ptr, size); }
 public:
 	enum {
 		//Default item IDs
@@ -248,6 +307,7 @@ public:
 	virtual void Clone(DxScriptObjectBase* src);
 
 	virtual bool HasNormalRendering() { return false; }
+	virtual bool IsWorkThreadSafe() { return IsMoveIsolated(); }
 
 	virtual void Work();
 	virtual void Activate() {}
@@ -256,11 +316,13 @@ public:
 	virtual void Render() {};
 	virtual void Render(BlendMode targetBlend) {};
 	virtual void RenderOnItemManager();
+	//Bounding circle of what the render functions draw, returns StgRenderCuller::RADIUS_NO_CULL if it can't be bounded
+	virtual float GetRenderBound(D3DXVECTOR2* pos);
 
 	virtual void Intersect(StgIntersectionTarget* ownTarget, StgIntersectionTarget* otherTarget) = 0;
 
-	virtual void SetX(float x) { posX_ = x; DxScriptRenderObject::SetX(x); }
-	virtual void SetY(float y) { posY_ = y; DxScriptRenderObject::SetY(y); }
+	virtual void SetX(float x);
+	virtual void SetY(float y);
 	virtual void SetColor(int r, int g, int b);
 	virtual void SetAlpha(int alpha);
 	void SetToPosition(D3DXVECTOR2& pos);
@@ -332,6 +394,7 @@ class StgItemObject_Bonus : public StgItemObject {
 public:
 	StgItemObject_Bonus(StgStageController* stageController);
 	
+	virtual bool IsWorkThreadSafe() { return false; }
 	virtual void Work();
 	virtual void Intersect(StgIntersectionTarget* ownTarget, StgIntersectionTarget* otherTarget);
 };
@@ -341,6 +404,7 @@ class StgItemObject_ScoreText : public StgItemObject {
 public:
 	StgItemObject_ScoreText(StgStageController* stageController);
 	
+	virtual bool IsWorkThreadSafe() { return false; }
 	virtual void Work();
 	virtual void Intersect(StgIntersectionTarget* ownTarget, StgIntersectionTarget* otherTarget);
 };
@@ -360,6 +424,7 @@ public:
 
 	virtual void Render(BlendMode targetBlend);
 	virtual void RenderOnItemManager() {};
+	virtual float GetRenderBound(D3DXVECTOR2* pos);
 
 	virtual void SetRenderTarget(shared_ptr<Texture> texture) { renderTarget_ = texture; }
 
@@ -15,4 +15,69 @@ protected:
 	}
 public:
 	StgStageController* GetStageController() { return stageController_; }
-};
\ No newline at end of file
+};
+//*******************************************************************
+//StgObjectPool
+//*******************************************************************
+//Free lists for the storage of short-lived stage objects (shots, items, intersection targets), bucketed by size.
+//	Only accessed from the main thread.
+class StgObjectPool {
+public:
+	enum : size_t {
+		SIZE_ALIGN = 16,
+		SIZE_POOL_MAX = 4096,
+	};
+private:
+	struct Block {
+		Block* next;
+	};
+
+	static Block* listFree_[SIZE_POOL_MAX / SIZE_ALIGN + 1];
+	static size_t listFreeCount_[SIZE_POOL_MAX / SIZE_ALIGN + 1];
+	static size_t countFree_;
+
+	static size_t countCreate_;
+	static size_t countHeapAlloc_;
+public:
+	static void* Allocate(size_t size);
+	static void Release(void* ptr, size_t size);
+	//Makes sure [count] blocks of [size] are free, carving any shortfall out of one allocation
+	static void Reserve(size_t size, size_t count);
+
+	//Object creations and heap allocations since the last ResetFrameCount
+	static size_t GetCreateCount() { return countCreate_; }
+	static size_t GetHeapAllocCount() { return countHeapAlloc_; }
+	static size_t GetFreeCount() { return countFree_; }
+	static void ResetFrameCount() {
+		countCreate_ = 0;
+		countHeapAlloc_ = 0;
+	}
+};
+
+//*******************************************************************
+//StgContainerPool
+//*******************************************************************
+//Spare buffers of the vectors owned by pooled objects, a recycled object takes one over instead of regrowing it.
+//	Only accessed from the main thread.
+template<typename T>
+class StgContainerPool {
+public:
+	enum : size_t {
+		SPARE_MAX = 4096,
+	};
+private:
+	static inline std::vector<std::vector<T>> listSpare_;
+public:
+	//Takes over a cleared spare buffer, if there is one
+	static void Acquire(std::vector<T>& dst) {
+		if (listSpare_.empty()) return;
+		dst.swap(listSpare_.back());
+		listSpare_.pop_back();
+	}
+	//Clears [src], keeping its capacity for the next Acquire
+	static void Recycle(std::vector<T>& src) {
+		if (src.capacity() == 0 || listSpare_.size() >= SPARE_MAX) return;
+		src.clear();
+		listSpare_.push_back(std::move(src));
+	}
+};
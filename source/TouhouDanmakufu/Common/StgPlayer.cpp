@@ -257,6 +257,8 @@ void StgPlayerObject::SendGrazeEvent() {
 
 	std::vector<value> listValPos;
 	std::vector<int> listShotID;
+	listValPos.reserve(listGrazedShot_.size());
+	listShotID.reserve(listGrazedShot_.size());
 
 	stageController_->GetStageInformation()->AddGraze(listGrazedShot_.size());
 
@@ -61,7 +61,7 @@ protected:
 	int frameRebirthDiff_;	//Deathbomb frame reduction per hit
 	int frameStateDown_;
 
-	std::list<ref_unsync_weak_ptr<StgIntersectionObject>> listGrazedShot_;
+	std::vector<ref_unsync_weak_ptr<StgIntersectionObject>> listGrazedShot_;
 	int hitObjectID_;
 
 	double itemCircle_;
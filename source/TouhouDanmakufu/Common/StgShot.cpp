@@ -6,6 +6,53 @@
 #include "StgItem.hpp"
 #include "../../GcLib/directx/HLSL.hpp"
 
+//****************************************************************************
+//StgShotQuadStream
+//****************************************************************************
+StgShotQuadStream::StgShotQuadStream() {
+	countQuad_ = 0;
+}
+
+void StgShotQuadStream::BuildQuad(VERTEX_TLX* dst, const VERTEX_TLX* src, const D3DXMATRIX& matWorld, D3DCOLOR color) {
+	//Same as the WORLD multiply in the shot shader
+	for (size_t iVert = 0; iVert < 4; ++iVert) {
+		const D3DXVECTOR4& pos = src[iVert].position;
+		D3DXVECTOR4* pDst = &dst[iVert].position;
+		pDst->x = pos.x * matWorld._11 + pos.y * matWorld._21 + pos.z * matWorld._31 + pos.w * matWorld._41;
+		pDst->y = pos.x * matWorld._12 + pos.y * matWorld._22 + pos.z * matWorld._32 + pos.w * matWorld._42;
+		pDst->z = pos.x * matWorld._13 + pos.y * matWorld._23 + pos.z * matWorld._33 + pos.w * matWorld._43;
+		pDst->w = pos.x * matWorld._14 + pos.y * matWorld._24 + pos.z * matWorld._34 + pos.w * matWorld._44;
+
+		//Source vertices are white, ICOLOR would have been multiplied into them
+		dst[iVert].diffuse_color = color;
+		dst[iVert].texcoord = src[iVert].texcoord;
+	}
+}
+void StgShotQuadStream::BuildIndex(uint16_t* dst, size_t countQuad) {
+	for (size_t iQuad = 0; iQuad < countQuad; ++iQuad) {
+		uint16_t base = (uint16_t)(iQuad * 4U);
+		uint16_t* pIndex = &dst[iQuad * 6U];
+		pIndex[0] = base + 0;
+		pIndex[1] = base + 1;
+		pIndex[2] = base + 2;
+		pIndex[3] = base + 2;
+		pIndex[4] = base + 1;
+		pIndex[5] = base + 3;
+	}
+}
+
+bool StgShotQuadStream::AddQuad(const VERTEX_TLX* src, const D3DXMATRIX& matWorld, D3DCOLOR color) {
+	if (countQuad_ >= QUAD_MAX) return false;
+
+	size_t countVertex = (countQuad_ + 1U) * 4U;
+	if (listVertex_.size() < countVertex)
+		listVertex_.resize(std::min<size_t>(std::max<size_t>(listVertex_.size() * 2U, 1024U), QUAD_MAX * 4U));
+
+	BuildQuad(&listVertex_[countQuad_ * 4U], src, matWorld, color);
+	++countQuad_;
+	return true;
+}
+
 //****************************************************************************
 //StgShotManager
 //****************************************************************************
@@ -15,6 +62,15 @@ StgShotManager::StgShotManager(StgStageController* stageController) {
 	listPlayerShotData_ = std::make_unique<StgShotDataList>();
 	listEnemyShotData_ = std::make_unique<StgShotDataList>();
 
+	listObj_.reserve(SHOT_MAX);
+
+	pBatchTexture_ = nullptr;
+	listBatchIndex_.resize(StgShotQuadStream::QUAD_MAX * 6U);
+	StgShotQuadStream::BuildIndex(listBatchIndex_.data(), StgShotQuadStream::QUAD_MAX);
+
+	bRenderInstancing_ = false;
+	countRenderCulled_ = 0;
+
 	rcDeleteClip_ = DxRect<LONG>(-64, -64, 64, 64);
 
 	filterMin_ = D3DTEXF_LINEAR;
@@ -23,22 +79,25 @@ StgShotManager::StgShotManager(StgStageController* stageController) {
 	{
 		RenderShaderLibrary* shaderManager_ = ShaderManager::GetBase()->GetRenderLib();
 		effectShot_ = shaderManager_->GetRender2DShader();
+		semanticShot_ = shaderManager_->GetRender2DSemantic();
+		effectInstance_ = shaderManager_->GetInstancingSpriteShader();
+		semanticInstance_ = shaderManager_->GetInstancingSpriteSemantic();
 	}
-	{
-		size_t renderPriMax = stageController_->GetMainObjectManager()->GetRenderBucketCapacity();
+	countRenderPriority_ = stageController_->GetMainObjectManager()->GetRenderBucketCapacity();
+	pLastTexture_ = nullptr;
 
-		listRenderQueuePlayer_.resize(renderPriMax);
-		listRenderQueueEnemy_.resize(renderPriMax);
-		for (size_t i = 0; i < renderPriMax; ++i) {
-			listRenderQueuePlayer_[i].listShot.resize(32);
-			listRenderQueueEnemy_[i].listShot.resize(32);
-		}
+	{
+		DirectGraphics* graphics = DirectGraphics::GetBase();
+		LONG screenWidth = graphics->GetScreenWidth();
+		LONG screenHeight = graphics->GetScreenHeight();
+		gridSpatialIndex_.Initialize(DxRect<LONG>(-64, -64, screenWidth + 64, screenHeight + 64));
+		bSpatialIndexValid_ = false;
 	}
-	pLastTexture_ = nullptr;
 
 	SetDeleteEventEnableByType(StgStageItemScript::EV_DELETE_SHOT_IMMEDIATE, true);
 	SetDeleteEventEnableByType(StgStageItemScript::EV_DELETE_SHOT_FADE, true);
 	SetDeleteEventEnableByType(StgStageItemScript::EV_DELETE_SHOT_TO_ITEM, true);
+	bDeleteEventBatch_ = false;
 }
 StgShotManager::~StgShotManager() {
 	for (ref_unsync_ptr<StgShotObject>& obj : listObj_) {
@@ -47,16 +106,31 @@ StgShotManager::~StgShotManager() {
 	}
 }
 void StgShotManager::Work() {
-	for (auto itr = listObj_.begin(); itr != listObj_.end(); ) {
-		ref_unsync_ptr<StgShotObject>& obj = *itr;
-		if (obj->IsDeleted()) {
-			obj->ClearShotObject();
-			itr = listObj_.erase(itr);
+	//Compact in place, the surviving shots keep their relative order
+	size_t iAlive = 0;
+	for (size_t i = 0; i < listObj_.size(); ++i) {
+		ref_unsync_ptr<StgShotObject>& obj = listObj_[i];
+		if (obj->IsDeleted() || !obj->IsActive()) {
+			if (obj->IsDeleted())
+				obj->ClearShotObject();
+			if (obj->IsEnemyHitCooldownSpilled())
+				ReleaseEnemyHitCooldown(obj.get());
+			continue;
 		}
-		else if (!obj->IsActive()) {
-			itr = listObj_.erase(itr);
+		if (iAlive != i)
+			listObj_[iAlive] = obj;
+		++iAlive;
+	}
+	listObj_.resize(iAlive);
+	bSpatialIndexValid_ = false;
+
+	if (mapEnemyHitCooldown_.size() > 0) {
+		DWORD frame = stageController_->GetStageInformation()->GetCurrentFrame();
+		for (auto itr = mapEnemyHitCooldown_.begin(); itr != mapEnemyHitCooldown_.end(); ) {
+			if (itr->second.frameExpire <= frame)
+				itr = mapEnemyHitCooldown_.erase(itr);
+			else ++itr;
 		}
-		else ++itr;
 	}
 }
 
@@ -70,12 +144,24 @@ std::array<BlendMode, StgShotManager::BLEND_COUNT> StgShotManager::blendTypeRend
 	MODE_BLEND_ALPHA,
 	MODE_BLEND_ALPHA_INV,
 };
+size_t StgShotManager::_GetRenderPass(BlendMode blend) {
+	if (blend == MODE_BLEND_NONE) return RENDER_PASS_ALL;
+	for (size_t iBlend = 0; iBlend < blendTypeRenderOrder.size(); ++iBlend) {
+		if (blendTypeRenderOrder[iBlend] == blend)
+			return iBlend;
+	}
+	return RENDER_PASS_COUNT;	//Not rendered
+}
 void StgShotManager::Render(int targetPriority) {
-	if (targetPriority < 0 || targetPriority >= listRenderQueueEnemy_.size()) return;
+	if (targetPriority < 0 || targetPriority >= countRenderPriority_) return;
+	if (listRenderIndex_.GetBucketCount() == 0) return;
 
-	const RenderQueue& renderQueuePlayer = listRenderQueuePlayer_[targetPriority];
-	const RenderQueue& renderQueueEnemy = listRenderQueueEnemy_[targetPriority];
-	if (renderQueuePlayer.count == 0 && renderQueueEnemy.count == 0) return;
+	size_t countPlayer = 0, countEnemy = 0;
+	for (size_t iPass = 0; iPass < RENDER_PASS_COUNT; ++iPass) {
+		countPlayer += listRenderIndex_.GetBucketSize(_GetRenderBucket(targetPriority, true, iPass));
+		countEnemy += listRenderIndex_.GetBucketSize(_GetRenderBucket(targetPriority, false, iPass));
+	}
+	if (countPlayer == 0 && countEnemy == 0) return;
 
 	DirectGraphics* graphics = DirectGraphics::GetBase();
 	IDirect3DDevice9* device = graphics->GetDevice();
@@ -87,8 +173,7 @@ void StgShotManager::Render(int targetPriority) {
 	graphics->SetLightingEnable(false);
 	graphics->SetTextureFilter(filterMin_, filterMag_, D3DTEXF_NONE);
 
-	DWORD bEnableFog = FALSE;
-	device->GetRenderState(D3DRS_FOGENABLE, &bEnableFog);
+	bool bEnableFog = graphics->IsFogEnable();
 	if (bEnableFog)
 		graphics->SetFogEnable(false);
 
@@ -101,29 +186,45 @@ void StgShotManager::Render(int targetPriority) {
 	device->SetVertexDeclaration(shaderManager->GetVertexDeclarationTLX());
 	pLastTexture_ = nullptr;
 
-	if (D3DXHANDLE handle = effectShot_->GetParameterBySemantic(nullptr, "VIEWPROJECTION")) {
+	if (D3DXHANDLE handle = semanticShot_->Get(ShaderSemanticTable::VIEWPROJECTION)) {
 		effectShot_->SetMatrix(handle, &matProj_);
 	}
 
-	auto _RenderQueue = [&](const RenderQueue& renderQueue) {
-		if (renderQueue.count == 0) return;
+	auto _RenderQueue = [&](bool bPlayer) {
+		size_t bucketAll = _GetRenderBucket(targetPriority, bPlayer, RENDER_PASS_ALL);
+		const uint32_t* pAllBegin = listRenderIndex_.GetBucketBegin(bucketAll);
+		const uint32_t* pAllEnd = listRenderIndex_.GetBucketEnd(bucketAll);
 
 		for (size_t iBlend = 0; iBlend < blendTypeRenderOrder.size(); ++iBlend) {
+			size_t bucket = _GetRenderBucket(targetPriority, bPlayer, iBlend);
+			const uint32_t* pItr = listRenderIndex_.GetBucketBegin(bucket);
+			const uint32_t* pEnd = listRenderIndex_.GetBucketEnd(bucket);
+			const uint32_t* pAllItr = pAllBegin;
+			if (pItr == pEnd && pAllItr == pAllEnd) continue;
+
 			BlendMode blend = blendTypeRenderOrder[iBlend];
 
 			graphics->SetBlendMode(blend);
 			effectShot_->SetTechnique(blend == MODE_BLEND_ALPHA_INV ? "RenderInv" : "Render");
-
-			for (size_t i = 0; i < renderQueue.count; ++i) {
-				StgShotObject* pShot = renderQueue.listShot[i];
-				pShot->Render(blend);
+			if (bRenderInstancing_)
+				effectInstance_->SetTechnique(blend == MODE_BLEND_ALPHA_INV ? "RenderInv" : "Render");
+
+			//Both buckets are in creation order, merge them to keep the draw order
+			while (pItr != pEnd || pAllItr != pAllEnd) {
+				uint32_t index;
+				if (pAllItr == pAllEnd || (pItr != pEnd && *pItr < *pAllItr))
+					index = *(pItr++);
+				else
+					index = *(pAllItr++);
+				listObj_[index]->Render(blend);
 			}
+			FlushRenderBatch();
 		}
 	};
 
 	//Always renders enemy shots above player shots, completely obliterates TAΣ's wet dream.
-	_RenderQueue(renderQueuePlayer);
-	_RenderQueue(renderQueueEnemy);
+	if (countPlayer > 0) _RenderQueue(true);
+	if (countEnemy > 0) _RenderQueue(false);
 
 	device->SetVertexShader(nullptr);
 	device->SetPixelShader(nullptr);
@@ -133,22 +234,123 @@ void StgShotManager::Render(int targetPriority) {
 	if (bEnableFog)
 		graphics->SetFogEnable(true);
 }
-void StgShotManager::LoadRenderQueue() {
-	for (size_t i = 0; i < listRenderQueuePlayer_.size(); ++i) {
-		listRenderQueuePlayer_[i].count = 0;
-		listRenderQueueEnemy_[i].count = 0;
+void StgShotManager::AddRenderBatch(IDirect3DTexture9* texture, const VERTEX_TLX* quad, const D3DXMATRIX& matWorld, D3DCOLOR color) {
+	if (texture != pBatchTexture_) {
+		FlushRenderBatch();
+		pBatchTexture_ = texture;
+	}
+	if (bRenderInstancing_) {
+		if (!streamInstance_.AddInstance(quad, matWorld, color)) {
+			FlushRenderBatch();
+			streamInstance_.AddInstance(quad, matWorld, color);
+		}
 	}
+	else if (!streamBatch_.AddQuad(quad, matWorld, color)) {
+		FlushRenderBatch();
+		streamBatch_.AddQuad(quad, matWorld, color);
+	}
+}
+void StgShotManager::FlushRenderBatch() {
+	size_t countQuad = streamBatch_.GetQuadCount();
+	size_t countInstance = streamInstance_.GetInstanceCount();
+	if (countQuad == 0 && countInstance == 0) return;
 
-	for (ref_unsync_ptr<StgShotObject>& obj : listObj_) {
-		if (obj->IsDeleted() || !obj->IsActive() || !obj->IsVisible()) continue;
+	DirectGraphics* graphics = DirectGraphics::GetBase();
+	IDirect3DDevice9* device = graphics->GetDevice();
+
+	if (graphics->IsAllowRenderTargetChange())
+		graphics->SetRenderTarget(nullptr);
+
+	if (pBatchTexture_ != pLastTexture_) {
+		device->SetTexture(0, pBatchTexture_);
+		pLastTexture_ = pBatchTexture_;
+	}
+
+	if (countInstance > 0) {
+		streamInstance_.Render(effectInstance_, semanticInstance_, matProj_);
+		return;
+	}
+
+	VertexBufferManager* vbManager = VertexBufferManager::GetBase();
+	FixedVertexBuffer* vertexBuffer = vbManager->GetVertexBufferTLX();
+	FixedIndexBuffer* indexBuffer = vbManager->GetIndexBuffer();
+
+	size_t countVertex = streamBatch_.GetVertexCount();
+	size_t countIndex = countQuad * 6U;
+	{
+		BufferLockParameter lockParam = BufferLockParameter(D3DLOCK_DISCARD);
+
+		lockParam.SetSource(streamBatch_.GetVertexList(), countVertex, sizeof(VERTEX_TLX));
+		vertexBuffer->UpdateBuffer(&lockParam);
+
+		lockParam.SetSource(listBatchIndex_, countIndex, sizeof(uint16_t));
+		indexBuffer->UpdateBuffer(&lockParam);
+	}
 
-		auto& [count, listShot] = (obj->GetOwnerType() == StgShotObject::OWNER_PLAYER ?
-			listRenderQueuePlayer_ : listRenderQueueEnemy_)[obj->GetRenderPriorityI()];
+	device->SetStreamSource(0, vertexBuffer->GetBuffer(), 0, sizeof(VERTEX_TLX));
+	device->SetIndices(indexBuffer->GetBuffer());
 
-		while (count >= listShot.size())
-			listShot.resize(listShot.size() * 2);
-		listShot[count++] = obj.get();
+	{
+		//World transforms and colors are already in the vertices
+		D3DXHANDLE handle = nullptr;
+		if (handle = semanticShot_->Get(ShaderSemanticTable::WORLD)) {
+			effectShot_->SetMatrix(handle, &graphics->GetCamera()->GetIdentity());
+		}
+		if (handle = semanticShot_->Get(ShaderSemanticTable::ICOLOR)) {
+			D3DXVECTOR4 vColor(1, 1, 1, 1);
+			effectShot_->SetVector(handle, &vColor);
+		}
+
+		UINT countPass = 1;
+		effectShot_->Begin(&countPass, D3DXFX_DONOTSAVESHADERSTATE);
+		for (UINT iPass = 0; iPass < countPass; ++iPass) {
+			effectShot_->BeginPass(iPass);
+			graphics->DrawIndexedPrimitive(D3DPT_TRIANGLELIST, 0, 0, countVertex, 0, countQuad * 2U);
+			effectShot_->EndPass();
+		}
+		effectShot_->End();
+	}
+
+	streamBatch_.Clear();
+}
+void StgShotManager::LoadRenderQueue() {
+	{
+		//The 2D camera is only enabled for priorities within the STG frame,
+		//	and is reset to the default focus after the camera priority
+		StgStageInformation* stageInfo = stageController_->GetStageInformation().get();
+		int priMinFrame = stageInfo->GetStgFrameMinPriority();
+		int priMaxFrame = std::min(stageInfo->GetStgFrameMaxPriority(), 
+			stageInfo->GetCameraFocusPermitPriority());
+
+		cullRender_.Reset(listObj_.size());
+		for (size_t i = 0; i < listObj_.size(); ++i) {
+			StgShotObject* obj = listObj_[i].get();
+			if (obj->IsDeleted() || !obj->IsActive() || !obj->IsVisible()) continue;
+
+			int pri = obj->GetRenderPriorityI();
+			if (pri < priMinFrame || pri > priMaxFrame) continue;
+
+			D3DXVECTOR2 pos;
+			float radius = obj->GetRenderBound(&pos);
+			if (radius != StgRenderCuller::RADIUS_NO_CULL)
+				cullRender_.SetCircle(i, pos, radius);
+		}
+		countRenderCulled_ = cullRender_.Cull(DirectGraphics::GetBase()->GetCamera2D()->GetVisibleRect());
 	}
+
+	size_t countBucket = countRenderPriority_ * 2U * RENDER_PASS_COUNT;
+	listRenderIndex_.Build(listObj_.size(), countBucket, [&](size_t i) -> uint32_t {
+		StgShotObject* obj = listObj_[i].get();
+		if (obj->IsDeleted() || !obj->IsActive() || !obj->IsVisible() || !cullRender_.IsVisible(i)) 
+			return BucketIndexList::KEY_SKIP;
+
+		size_t pass = _GetRenderPass(obj->GetRenderPassBlend());
+		if (pass >= RENDER_PASS_COUNT) 
+			return BucketIndexList::KEY_SKIP;
+
+		size_t pri = std::clamp<int>(obj->GetRenderPriorityI(), 0, (int)countRenderPriority_ - 1);
+		return _GetRenderBucket(pri, obj->GetOwnerType() == StgShotObject::OWNER_PLAYER, pass);
+	});
 }
 
 void StgShotManager::RegistIntersectionTarget() {
@@ -162,56 +364,142 @@ void StgShotManager::RegistIntersectionTarget() {
 void StgShotManager::AddShot(ref_unsync_ptr<StgShotObject> obj) {
 	obj->SetOwnObjectReference();
 	listObj_.push_back(obj);
+	bSpatialIndexValid_ = false;
+}
+
+void StgShotManager::_UpdateSpatialIndex() {
+	if (bSpatialIndexValid_) return;
+
+	listSpatialIndexObj_.clear();
+	for (ref_unsync_ptr<StgShotObject>& obj : listObj_) {
+		if (!obj->IsDeleted())
+			listSpatialIndexObj_.push_back(obj.get());
+	}
+
+	gridSpatialIndex_.Build(listSpatialIndexObj_.size(), [&](size_t i) {
+		StgShotObject* obj = listSpatialIndexObj_[i];
+		LONG sx = obj->GetPositionX();
+		LONG sy = obj->GetPositionY();
+		return DxRect<LONG>(sx, sy, sx, sy);
+	});
+	bSpatialIndexValid_ = true;
+}
+std::vector<uint32_t>& StgShotManager::_QuerySpatialIndex(const DxRect<LONG>& rect) {
+	_UpdateSpatialIndex();
+
+	listSpatialQueryResult_.clear();
+	gridSpatialIndex_.Query(rect, [&](uint32_t index) {
+		listSpatialQueryResult_.push_back(index);
+	});
+
+	//Keep the results in creation order, same as a linear scan of listObj_
+	std::sort(listSpatialQueryResult_.begin(), listSpatialQueryResult_.end());
+	return listSpatialQueryResult_;
 }
 
 void StgShotManager::DeleteInCircle(int typeDelete, int typeTo, int typeOwner, int cx, int cy, optional<int> radius) {
-	int r = radius ? *radius : 0;
+	auto _Delete = [&](StgShotObject* obj) {
+		if (obj->IsDeleted()) return;
+		if ((typeOwner != StgShotObject::OWNER_NULL) && (obj->GetOwnerType() != typeOwner)) return;
+		if (typeDelete == DEL_TYPE_SHOT && obj->IsSpellResist()) return;
+
+		if (typeTo == TO_TYPE_IMMEDIATE)
+			obj->DeleteImmediate();
+		else if (typeTo == TO_TYPE_FADE)
+			obj->SetFadeDelete();
+		else if (typeTo == TO_TYPE_ITEM)
+			obj->ConvertToItem();
+	};
+
+	if (!radius.has_value()) {
+		//Deletion can spawn items and send events, index instead of iterating in case shots get added
+		for (size_t i = 0, count = listObj_.size(); i < count; ++i)
+			_Delete(listObj_[i].get());
+		return;
+	}
+
+	int r = *radius;
 	int rr = r * r;
 
 	DxRect<int> rcBox(cx - r, cy - r, cx + r, cy + r);
 
-	for (ref_unsync_ptr<StgShotObject>& obj : listObj_) {
+	//Deletion can spawn items and send events, collect first
+	std::vector<StgShotObject*> listHit;
+	for (uint32_t index : _QuerySpatialIndex(DxRect<LONG>(rcBox.left, rcBox.top, rcBox.right, rcBox.bottom))) {
+		StgShotObject* obj = listSpatialIndexObj_[index];
+
+		int sx = obj->GetPositionX();
+		int sy = obj->GetPositionY();
+		if (rcBox.IsPointIntersected(sx, sy) && Math::HypotSq<int64_t>(cx - sx, cy - sy) <= rr)
+			listHit.push_back(obj);
+	}
+	for (StgShotObject* obj : listHit)
+		_Delete(obj);
+}
+void StgShotManager::DeleteInArea(int typeDelete, int typeTo, int typeOwner, const StgIntersectionArea& area) {
+	std::vector<StgShotObject*> listHit;
+	for (uint32_t index : _QuerySpatialIndex(area.GetBounds())) {
+		StgShotObject* obj = listSpatialIndexObj_[index];
 		if (obj->IsDeleted()) continue;
 		if ((typeOwner != StgShotObject::OWNER_NULL) && (obj->GetOwnerType() != typeOwner)) continue;
 		if (typeDelete == DEL_TYPE_SHOT && obj->IsSpellResist()) continue;
 
-		int sx = obj->GetPositionX();
-		int sy = obj->GetPositionY();
+		if (area.IsPointInside(obj->GetPositionX(), obj->GetPositionY()))
+			listHit.push_back(obj);
+	}
 
-		bool bInRadius = rcBox.IsPointIntersected(sx, sy) && Math::HypotSq<int64_t>(cx - sx, cy - sy) <= rr;
-		if (!radius.has_value() || bInRadius) {
-			if (typeTo == TO_TYPE_IMMEDIATE)
-				obj->DeleteImmediate();
-			else if (typeTo == TO_TYPE_FADE)
-				obj->SetFadeDelete();
-			else if (typeTo == TO_TYPE_ITEM)
-				obj->ConvertToItem();
-		}
+	for (StgShotObject* obj : listHit) {
+		if (typeTo == TO_TYPE_IMMEDIATE)
+			obj->DeleteImmediate();
+		else if (typeTo == TO_TYPE_FADE)
+			obj->SetFadeDelete();
+		else if (typeTo == TO_TYPE_ITEM)
+			obj->ConvertToItem();
 	}
 }
 
 std::vector<int> StgShotManager::GetShotIdInCircle(int typeOwner, int cx, int cy, optional<int> radius) {
-	int r = radius ? *radius : 0;
+	std::vector<int> res;
+
+	if (!radius.has_value()) {
+		for (ref_unsync_ptr<StgShotObject>& obj : listObj_) {
+			if (obj->IsDeleted()) continue;
+			if ((typeOwner != StgShotObject::OWNER_NULL) && (obj->GetOwnerType() != typeOwner)) continue;
+			res.push_back(obj->GetObjectID());
+		}
+		return res;
+	}
+
+	int r = *radius;
 	int rr = r * r;
 
 	DxRect<int> rcBox(cx - r, cy - r, cx + r, cy + r);
 
-	std::vector<int> res;
-	for (ref_unsync_ptr<StgShotObject>& obj : listObj_) {
+	for (uint32_t index : _QuerySpatialIndex(DxRect<LONG>(rcBox.left, rcBox.top, rcBox.right, rcBox.bottom))) {
+		StgShotObject* obj = listSpatialIndexObj_[index];
 		if (obj->IsDeleted()) continue;
 		if ((typeOwner != StgShotObject::OWNER_NULL) && (obj->GetOwnerType() != typeOwner)) continue;
 
 		int sx = obj->GetPositionX();
 		int sy = obj->GetPositionY();
-
-		bool bInRadius = rcBox.IsPointIntersected(sx, sy) && Math::HypotSq<int64_t>(cx - sx, cy - sy) <= rr;
-		if (!radius.has_value() || bInRadius) {
+		if (rcBox.IsPointIntersected(sx, sy) && Math::HypotSq<int64_t>(cx - sx, cy - sy) <= rr)
 			res.push_back(obj->GetObjectID());
-		}
 	}
 
 	return res;
 }
+std::vector<int> StgShotManager::GetShotIdInArea(int typeOwner, const StgIntersectionArea& area) {
+	std::vector<int> res;
+	for (uint32_t index : _QuerySpatialIndex(area.GetBounds())) {
+		StgShotObject* obj = listSpatialIndexObj_[index];
+		if (obj->IsDeleted()) continue;
+		if ((typeOwner != StgShotObject::OWNER_NULL) && (obj->GetOwnerType() != typeOwner)) continue;
+
+		if (area.IsPointInside(obj->GetPositionX(), obj->GetPositionY()))
+			res.push_back(obj->GetObjectID());
+	}
+	return res;
+}
 size_t StgShotManager::GetShotCount(int typeOwner) {
 	size_t res = 0;
 
@@ -247,10 +535,69 @@ StgShotManager::TypeDelete StgShotManager::_EventTypeToTypeDelete(int type) {
 	return TypeDelete::Immediate;
 }
 
+StgEnemyHitCooldown* StgShotManager::FindEnemyHitCooldown(StgShotObject* shot, int idEnemy) {
+	auto range = mapEnemyHitCooldown_.equal_range(shot);
+	for (auto itr = range.first; itr != range.second; ++itr) {
+		if (itr->second.idEnemy == idEnemy)
+			return &itr->second;
+	}
+	return nullptr;
+}
+void StgShotManager::AddEnemyHitCooldown(StgShotObject* shot, const StgEnemyHitCooldown& cooldown) {
+	if (StgEnemyHitCooldown* pCooldown = FindEnemyHitCooldown(shot, cooldown.idEnemy))
+		*pCooldown = cooldown;
+	else
+		mapEnemyHitCooldown_.insert(std::make_pair(shot, cooldown));
+}
+void StgShotManager::CopyEnemyHitCooldown(StgShotObject* dest, StgShotObject* src) {
+	ReleaseEnemyHitCooldown(dest);
+
+	auto range = mapEnemyHitCooldown_.equal_range(src);
+	std::vector<StgEnemyHitCooldown> listCopy;
+	for (auto itr = range.first; itr != range.second; ++itr)
+		listCopy.push_back(itr->second);
+	for (auto& cooldown : listCopy)
+		mapEnemyHitCooldown_.insert(std::make_pair(dest, cooldown));
+}
+
 void StgShotManager::SetDeleteEventEnableByType(int type, bool bEnable) {
 	int bit = (int)_EventTypeToTypeDelete(type);
 	listDeleteEventEnable_.set(bit, bEnable);
 }
+void StgShotManager::SetDeleteEventBatchEnable(bool bEnable) {
+	//Don't strand what was already collected
+	if (bDeleteEventBatch_ && !bEnable)
+		SendDeleteEventBatch();
+	bDeleteEventBatch_ = bEnable;
+}
+void StgShotManager::AddDeleteEventBatch(TypeDelete type, int id, double x, double y, int graphic) {
+	DeleteEventBatch& batch = listDeleteEventBatch_[(size_t)type];
+	batch.listId.push_back(id);
+	batch.listPos.push_back(x);
+	batch.listPos.push_back(y);
+	batch.listGraphic.push_back(graphic);
+}
+void StgShotManager::SendDeleteEventBatch() {
+	auto itemScript = stageController_->GetScriptManager()->GetItemScript().lock();
+
+	for (size_t iType = 0; iType < listDeleteEventBatch_.size(); ++iType) {
+		DeleteEventBatch& batch = listDeleteEventBatch_[iType];
+		if (batch.listId.size() == 0) continue;
+
+		if (itemScript) {
+			gstd::value listScriptValue[3];
+			listScriptValue[0] = DxScript::CreateIntArrayValue(batch.listId);
+			listScriptValue[1] = DxScript::CreateFloatArrayValue(batch.listPos);
+			listScriptValue[2] = DxScript::CreateIntArrayValue(batch.listGraphic);
+			itemScript->RequestEvent(_TypeDeleteToEventType((TypeDelete)iType), listScriptValue, 3);
+		}
+
+		//Keeps the capacity for the next frame
+		batch.listId.clear();
+		batch.listPos.clear();
+		batch.listGraphic.clear();
+	}
+}
 bool StgShotManager::LoadPlayerShotData(const std::wstring& path, bool bReload) {
 	return listPlayerShotData_->AddShotDataList(path, bReload);
 }
@@ -262,6 +609,8 @@ bool StgShotManager::LoadEnemyShotData(const std::wstring& path, bool bReload) {
 //StgShotDataList
 //****************************************************************************
 StgShotDataList::StgShotDataList() {
+	atlas_.Initialize(EPathProperty::GetCacheDirectory() + L"atlas/");
+
 	defaultDelayData_ = -1;
 	defaultDelayColor_ = 0xffffffff;	//Solid white
 }
@@ -273,13 +622,37 @@ void StgShotDataList::_LoadVertexBuffers(std::map<std::wstring, VBContainerList>
 	DirectGraphics* graphics = DirectGraphics::GetBase();
 	IDirect3DDevice9* device = graphics->GetDevice();
 
-	float texW = texture->GetWidth();
-	float texH = texture->GetHeight();
-
 	size_t countFrame = 0;
 	for (StgShotData* iData : listAddData)
 		countFrame += iData->GetFrameCount();
 
+	//Pack the frames into the atlas, the ones that don't fit stay on the shot sheet
+	{
+		std::vector<TextureAtlas::Region> listRegion;
+		listRegion.reserve(countFrame);
+		for (StgShotData* iData : listAddData) {
+			for (StgShotDataFrame& iFrame : iData->listFrame_)
+				listRegion.push_back({ iFrame.rcSrc_ });
+		}
+
+		atlas_.AddSource(placement->first, texture, listRegion);
+
+		auto itrRegion = listRegion.begin();
+		for (StgShotData* iData : listAddData) {
+			for (StgShotDataFrame& iFrame : iData->listFrame_) {
+				TextureAtlas::Region& region = *(itrRegion++);
+				if (region.page != TextureAtlas::PAGE_NONE) {
+					iFrame.texture_ = atlas_.GetPage(region.page);
+					iFrame.rcTexture_ = region.rcAtlas;
+				}
+				else {
+					iFrame.texture_ = texture;
+					iFrame.rcTexture_ = iFrame.rcSrc_;
+				}
+			}
+		}
+	}
+
 	size_t iBuffer = 0;
 	while (countFrame > 0) {
 		size_t thisCountFrame = std::min<size_t>(countFrame, StgShotVertexBufferContainer::MAX_DATA);
@@ -299,7 +672,10 @@ void StgShotDataList::_LoadVertexBuffers(std::map<std::wstring, VBContainerList>
 				StgShotDataFrame* pFrame = &data->listFrame_[iAnim];
 				pFrame->listShotData_ = this;
 
-				LONG* ptrSrc = reinterpret_cast<LONG*>(&pFrame->rcSrc_);
+				float texW = pFrame->texture_->GetWidth();
+				float texH = pFrame->texture_->GetHeight();
+
+				LONG* ptrSrc = reinterpret_cast<LONG*>(&pFrame->rcTexture_);
 				float* ptrDst = reinterpret_cast<float*>(&pFrame->rcDst_);
 
 				for (size_t iVert = 0; iVert < 4; ++iVert) {
@@ -327,6 +703,7 @@ void StgShotDataList::_LoadVertexBuffers(std::map<std::wstring, VBContainerList>
 
 				for (size_t j = 0; j < 4; ++j)
 					bufferVertex[iVertex + j] = verts[j];
+				pFrame->quad_.Load(verts);
 				iVertex += 4;
 			}
 		}
@@ -759,6 +1136,8 @@ StgShotObject::StgShotObject(StgStageController* stageController) : StgMoveObjec
 
 	bPenetrateShot_ = true;
 	frameEnemyHitInvalid_ = 0;
+	countEnemyHitCooldown_ = 0;
+	bEnemyHitCooldownSpill_ = false;
 
 	frameFadeDelete_ = -1;
 	frameAutoDelete_ = INT_MAX;
@@ -776,13 +1155,17 @@ StgShotObject::StgShotObject(StgStageController* stageController) : StgMoveObjec
 
 	hitboxScale_ = D3DXVECTOR2(1.0f, 1.0f);
 
+	pcTransform_ = 0;
 	timerTransform_ = 0;
 	timerTransformNext_ = 0;
 
+	StgContainerPool<IntersectionPairType>::Acquire(listIntersectionTarget_);
+
 	int priShotI = stageController_->GetStageInformation()->GetShotObjectPriority();
 	SetRenderPriorityI(priShotI);
 }
 StgShotObject::~StgShotObject() {
+	StgContainerPool<IntersectionPairType>::Recycle(listIntersectionTarget_);
 }
 
 void StgShotObject::Clone(DxScriptObjectBase* _src) {
@@ -810,7 +1193,12 @@ void StgShotObject::Clone(DxScriptObjectBase* _src) {
 	renderTarget_ = src->renderTarget_;
 
 	frameEnemyHitInvalid_ = src->frameEnemyHitInvalid_;
-	mapEnemyHitCooldown_ = src->mapEnemyHitCooldown_;
+	countEnemyHitCooldown_ = src->countEnemyHitCooldown_;
+	for (size_t i = 0; i < countEnemyHitCooldown_; ++i)
+		listEnemyHitCooldown_[i] = src->listEnemyHitCooldown_[i];
+	bEnemyHitCooldownSpill_ = src->bEnemyHitCooldownSpill_;
+	if (bEnemyHitCooldownSpill_)
+		stageController_->GetShotManager()->CopyEnemyHitCooldown(this, src);
 
 	bRequestedPlayerDeleteEvent_ = src->bRequestedPlayerDeleteEvent_;
 	damage_ = src->damage_;
@@ -832,7 +1220,8 @@ void StgShotObject::Clone(DxScriptObjectBase* _src) {
 	bRoundingPosition_ = src->bRoundingPosition_;
 	roundingAngle_ = src->roundingAngle_;
 
-	listTransformationShotAct_ = src->listTransformationShotAct_;
+	transformProgram_ = src->transformProgram_;
+	pcTransform_ = src->pcTransform_;
 	timerTransform_ = src->timerTransform_;
 	timerTransformNext_ = src->timerTransformNext_;
 }
@@ -935,21 +1324,57 @@ void StgShotObject::_CommonWorkTask() {
 
 	//----------------------------------------------------------
 
-	for (auto itr = mapEnemyHitCooldown_.begin(); itr != mapEnemyHitCooldown_.end();) {
-		if (itr->first.expired() || itr->first->IsDeleted() || (--(itr->second) == 0))
-			itr = mapEnemyHitCooldown_.erase(itr);
-		else ++itr;
+	if (countEnemyHitCooldown_ > 0) {
+		DWORD frame = stageController_->GetStageInformation()->GetCurrentFrame();
+		size_t iDst = 0;
+		for (size_t i = 0; i < countEnemyHitCooldown_; ++i) {
+			if (listEnemyHitCooldown_[i].frameExpire > frame)
+				listEnemyHitCooldown_[iDst++] = listEnemyHitCooldown_[i];
+		}
+		countEnemyHitCooldown_ = iDst;
 	}
 }
 
-bool StgShotObject::CheckEnemyHitCooldownExists(ref_unsync_weak_ptr<StgEnemyObject> obj) {
-	if (mapEnemyHitCooldown_.empty()) return false;
-	return mapEnemyHitCooldown_.find(obj) != mapEnemyHitCooldown_.end();
+bool StgShotObject::CheckEnemyHitCooldownExists(StgEnemyObject* obj) {
+	if (obj == nullptr) return false;
+	if (countEnemyHitCooldown_ == 0 && !bEnemyHitCooldownSpill_) return false;
+
+	int idEnemy = obj->GetObjectID();
+	DWORD frame = stageController_->GetStageInformation()->GetCurrentFrame();
+
+	StgEnemyHitCooldown* pCooldown = nullptr;
+	for (size_t i = 0; i < countEnemyHitCooldown_; ++i) {
+		if (listEnemyHitCooldown_[i].idEnemy == idEnemy) {
+			pCooldown = &listEnemyHitCooldown_[i];
+			break;
+		}
+	}
+	if (pCooldown == nullptr && bEnemyHitCooldownSpill_)
+		pCooldown = stageController_->GetShotManager()->FindEnemyHitCooldown(this, idEnemy);
+
+	return pCooldown && pCooldown->pEnemy.get() == obj && pCooldown->frameExpire > frame;
 }
-void StgShotObject::AddEnemyHitCooldown(ref_unsync_weak_ptr<StgEnemyObject> obj, uint32_t time) {
-	if (obj) {
-		mapEnemyHitCooldown_[obj] = time;
+void StgShotObject::AddEnemyHitCooldown(StgEnemyObject* obj, uint32_t time) {
+	if (obj == nullptr) return;
+
+	StgEnemyHitCooldown cooldown;
+	cooldown.idEnemy = obj->GetObjectID();
+	cooldown.pEnemy = ref_unsync_ptr<StgEnemyObject>::Cast(stageController_->GetMainRenderObject(cooldown.idEnemy));
+	cooldown.frameExpire = stageController_->GetStageInformation()->GetCurrentFrame() + time;
+
+	for (size_t i = 0; i < countEnemyHitCooldown_; ++i) {
+		if (listEnemyHitCooldown_[i].idEnemy == cooldown.idEnemy) {
+			listEnemyHitCooldown_[i] = cooldown;
+			return;
+		}
+	}
+	if (countEnemyHitCooldown_ < ENEMY_HIT_COOLDOWN_INLINE) {
+		listEnemyHitCooldown_[countEnemyHitCooldown_++] = cooldown;
+		return;
 	}
+
+	bEnemyHitCooldownSpill_ = true;
+	stageController_->GetShotManager()->AddEnemyHitCooldown(this, cooldown);
 }
 
 void StgShotObject::Intersect(StgIntersectionTarget* ownTarget, StgIntersectionTarget* otherTarget) {
@@ -990,7 +1415,7 @@ void StgShotObject::Intersect(StgIntersectionTarget* ownTarget, StgIntersectionT
 	{
 		if (!bSpellResist_) {
 			//Register intersection only if the enemy is off hit cooldown
-			if (!CheckEnemyHitCooldownExists(ref_unsync_weak_ptr<StgEnemyObject>::Cast(obj)))
+			if (!CheckEnemyHitCooldownExists(dynamic_cast<StgEnemyObject*>(obj.get())))
 				--life_;
 		}
 		break;
@@ -1039,6 +1464,16 @@ void StgShotObject::SetColor(int r, int g, int b) {
 	__m128i c = Vectorize::Set(color_ >> 24, r, g, b);
 	color_ = ColorAccess::ToD3DCOLOR(ColorAccess::ClampColorPacked(c));
 }
+void StgShotObject::SetX(float x) {
+	posX_ = x;
+	DxScriptRenderObject::SetX(x);
+	stageController_->GetShotManager()->InvalidateSpatialIndex();
+}
+void StgShotObject::SetY(float y) {
+	posY_ = y;
+	DxScriptRenderObject::SetY(y);
+	stageController_->GetShotManager()->InvalidateSpatialIndex();
+}
 
 void StgShotObject::ConvertToItem() {
 	if (IsDeleted()) return;
@@ -1057,16 +1492,26 @@ void StgShotObject::DeleteImmediate() {
 	objectManager->DeleteObject(this);
 }
 
+void StgShotObject::SetTransformProgram(ref_unsync_ptr<StgShotTransformProgram> program) {
+	transformProgram_ = program;
+	pcTransform_ = 0;
+}
 void StgShotObject::_ProcessTransformAct() {
-	if (listTransformationShotAct_.size() == 0) return;
+	if (transformProgram_ == nullptr) return;
+
+	const StgShotTransformProgram* program = transformProgram_.get();
+	size_t countOp = program->GetSize();
+	if (pcTransform_ >= countOp) return;
 
 	if (timerTransform_ == 0) timerTransform_ = delay_.time;
-	while (timerTransform_ == frameWork_ && listTransformationShotAct_.size() > 0) {
-		StgShotPatternTransform& transform = listTransformationShotAct_.front();
+	while (timerTransform_ == frameWork_ && pcTransform_ < countOp) {
+		const StgShotTransformProgram::Op& op = program->GetOp(pcTransform_);
+		const StgShotPatternTransform& transform = op.transform;
+
+		timerTransform_ += op.frameAdvance;
 
 		switch (transform.act) {
 		case StgShotPatternTransform::TRANSFORM_WAIT:
-			timerTransform_ += std::max((int)transform.param[0], 0);
 			break;
 		case StgShotPatternTransform::TRANSFORM_ADD_SPEED_ANGLE:
 		{
@@ -1122,8 +1567,6 @@ void StgShotObject::_ProcessTransformAct() {
 			double changeSpeed = transform.param[3];
 			double changeAngle = transform.param[4];
 
-			timerTransform_ += timer * countRep;
-
 			for (int framePattern = 0; countRep > 0; --countRep, framePattern += timer) {
 				double nowSpeed = GetSpeed();
 
@@ -1383,7 +1826,7 @@ void StgShotObject::_ProcessTransformAct() {
 			break;
 		}
 
-		listTransformationShotAct_.pop_front();
+		++pcTransform_;
 	}
 }
 
@@ -1542,6 +1985,13 @@ void StgShotObject::_DefaultShotRender(StgShotData* shotData, StgShotDataFrame*
 	DWORD vertexOffset = shotFrame->vertexOffset_;
 
 	if (pVB) {
+		//Custom shaders and render targets still need their own draw
+		if (shader_ == nullptr && renderTarget_.expired()) {
+			shotManager->AddRenderBatch(shotFrame->GetD3DTexture(), shotFrame->GetQuadVertex(), matWorld, color);
+			return;
+		}
+		shotManager->FlushRenderBatch();
+
 		DirectGraphics* graphics = DirectGraphics::GetBase();
 		IDirect3DDevice9* device = graphics->GetDevice();
 
@@ -1551,7 +2001,7 @@ void StgShotObject::_DefaultShotRender(StgShotData* shotData, StgShotDataFrame*
 			else graphics->SetRenderTarget(nullptr);
 		}
 
-		IDirect3DTexture9* pTexture = pVB->GetD3DTexture();
+		IDirect3DTexture9* pTexture = shotFrame->GetD3DTexture();
 		if (pTexture != shotManager->pLastTexture_) {
 			device->SetTexture(0, pTexture);
 			shotManager->pLastTexture_ = pTexture;
@@ -1560,8 +2010,10 @@ void StgShotObject::_DefaultShotRender(StgShotData* shotData, StgShotDataFrame*
 
 		{
 			ID3DXEffect* effect = shotManager->GetEffect();
+			const ShaderSemanticTable* semantic = shotManager->GetEffectSemantic();
 			if (shader_) {
 				effect = shader_->GetEffect();
+				semantic = shader_->GetSemanticTable();
 				if (shader_->LoadTechnique()) {
 					shader_->LoadParameter();
 				}
@@ -1569,15 +2021,15 @@ void StgShotObject::_DefaultShotRender(StgShotData* shotData, StgShotDataFrame*
 
 			if (effect) {
 				D3DXHANDLE handle = nullptr;
-				if (handle = effect->GetParameterBySemantic(nullptr, "WORLD")) {
+				if (handle = semantic->Get(ShaderSemanticTable::WORLD)) {
 					effect->SetMatrix(handle, &matWorld);
 				}
 				if (shader_) {
-					if (handle = effect->GetParameterBySemantic(nullptr, "VIEWPROJECTION")) {
+					if (handle = semantic->Get(ShaderSemanticTable::VIEWPROJECTION)) {
 						effect->SetMatrix(handle, shotManager->GetProjectionMatrix());
 					}
 				}
-				if (handle = effect->GetParameterBySemantic(nullptr, "ICOLOR")) {
+				if (handle = semantic->Get(ShaderSemanticTable::ICOLOR)) {
 					//To normalized RGBA vector
 					D3DXVECTOR4 vColor = ColorAccess::ToVec4Normalized(color, ColorAccess::PERMUTE_RGBA);
 					effect->SetVector(handle, &vColor);
@@ -1587,7 +2039,7 @@ void StgShotObject::_DefaultShotRender(StgShotData* shotData, StgShotDataFrame*
 				effect->Begin(&countPass, D3DXFX_DONOTSAVESHADERSTATE);
 				for (UINT iPass = 0; iPass < countPass; ++iPass) {
 					effect->BeginPass(iPass);
-					device->DrawPrimitive(D3DPT_TRIANGLESTRIP, 0, 2);
+					graphics->DrawPrimitive(D3DPT_TRIANGLESTRIP, 0, 2);
 					effect->EndPass();
 				}
 				effect->End();
@@ -1675,6 +2127,50 @@ void StgNormalShotObject::Render(BlendMode targetBlend) {
 	//if (bIntersected_) color = D3DCOLOR_ARGB(255, 255, 0, 0);
 }
 
+BlendMode StgNormalShotObject::GetRenderPassBlend() {
+	StgShotData* shotData = _GetShotData();
+	if (shotData == nullptr) return MODE_BLEND_NONE;
+
+	//Same choice as in Render
+	BlendMode res = MODE_BLEND_NONE;
+	if (delay_.time > 0) {
+		res = GetDelayBlendType();
+		res = res == MODE_BLEND_NONE ? shotData->GetDelayRenderType() : res;
+	}
+	else {
+		res = GetBlendType();
+		res = res == MODE_BLEND_NONE ? shotData->GetRenderType() : res;
+	}
+	return res;
+}
+float StgNormalShotObject::GetRenderBound(D3DXVECTOR2* pos) {
+	//Custom shaders may move the vertices anywhere, render targets have their own view
+	if (shader_ != nullptr || !renderTarget_.expired()) return StgRenderCuller::RADIUS_NO_CULL;
+
+	StgShotData* shotData = _GetShotData();
+	if (shotData == nullptr) return StgRenderCuller::RADIUS_NO_CULL;
+
+	//Same frame and scale as in Render
+	StgShotDataFrame* frame = nullptr;
+	float scale = 1.0f;
+	if (delay_.time > 0) {
+		StgShotData* delayData = _GetShotData(delay_.id >= 0 ? delay_.id : shotData->GetDefaultDelayID());
+		if (delayData == nullptr) return StgRenderCuller::RADIUS_NO_CULL;
+		frame = delayData->GetFrame(frameWork_);
+		scale = fabsf(delay_.GetScale());
+		if (delay_.scaleMix)
+			scale *= std::max(fabsf(scale_.x), fabsf(scale_.y));
+	}
+	else {
+		frame = shotData->GetFrame(frameWork_);
+		scale = std::max(fabsf(scale_.x), fabsf(scale_.y));
+	}
+	if (frame == nullptr) return StgRenderCuller::RADIUS_NO_CULL;
+
+	*pos = D3DXVECTOR2(position_.x, position_.y);
+	return frame->GetRadius() * scale;
+}
+
 void StgNormalShotObject::_SendDeleteEvent(TypeDelete type) {
 	if (typeOwner_ != OWNER_ENEMY) return;
 
@@ -1692,7 +2188,10 @@ void StgNormalShotObject::_SendDeleteEvent(TypeDelete type) {
 		{
 			Math::DVec2 pos{ GetPositionX(), GetPositionY() };
 
-			LOCK_WEAK(itemScript, stageScriptManager->GetItemScript()) {
+			if (shotManager->IsDeleteEventBatchEnable()) {
+				shotManager->AddDeleteEventBatch(type, idObject_, pos[0], pos[1], GetShotDataID());
+			}
+			else LOCK_WEAK(itemScript, stageScriptManager->GetItemScript()) {
 				gstd::value listScriptValue[3];
 				listScriptValue[0] = DxScript::CreateIntValue(idObject_);
 				listScriptValue[1] = DxScript::CreateFloatArrayValue(pos);
@@ -2038,6 +2537,7 @@ void StgLooseLaserObject::_SendDeleteEvent(TypeDelete type) {
 	if (!shotManager->IsDeleteEventEnable(type)) return;
 
 	auto itemScript = stageScriptManager->GetItemScript().lock();
+	bool bBatch = shotManager->IsDeleteEventBatchEnable();
 
 	{
 		int typeEvent = StgShotManager::_TypeDeleteToEventType(type);
@@ -2051,7 +2551,10 @@ void StgLooseLaserObject::_SendDeleteEvent(TypeDelete type) {
 		for (double itemPos = 0; itemPos < currentLength_; itemPos += itemDistance_) {
 			pos = { ex - itemPos * move_.x, ey - itemPos * move_.y };
 
-			if (itemScript) {
+			if (bBatch) {
+				shotManager->AddDeleteEventBatch(type, idObject_, pos[0], pos[1], GetShotDataID());
+			}
+			else if (itemScript) {
 				gstd::value listScriptValue[3];
 				listScriptValue[0] = DxScript::CreateIntValue(idObject_);
 				listScriptValue[1] = DxScript::CreateFloatArrayValue(pos);
@@ -2313,6 +2816,7 @@ void StgStraightLaserObject::_SendDeleteEvent(TypeDelete type) {
 	if (!shotManager->IsDeleteEventEnable(type)) return;
 
 	auto itemScript = stageScriptManager->GetItemScript().lock();
+	bool bBatch = shotManager->IsDeleteEventBatchEnable();
 
 	{
 		int typeEvent = StgShotManager::_TypeDeleteToEventType(type);
@@ -2323,7 +2827,10 @@ void StgStraightLaserObject::_SendDeleteEvent(TypeDelete type) {
 		for (double itemPos = 0; itemPos < length_; itemPos += itemDistance_) {
 			pos = { posX_ + itemPos * move_.x, posY_ + itemPos * move_.y };
 
-			if (itemScript) {
+			if (bBatch) {
+				shotManager->AddDeleteEventBatch(type, idObject_, pos[0], pos[1], GetShotDataID());
+			}
+			else if (itemScript) {
 				gstd::value listScriptValue[3];
 				listScriptValue[0] = DxScript::CreateIntValue(idObject_);
 				listScriptValue[1] = DxScript::CreateFloatArrayValue(pos);
@@ -2364,6 +2871,19 @@ StgCurveLaserObject::StgCurveLaserObject(StgStageController* stageController) :
 
 	bCap_ = false;
 	posOrigin_ = D3DXVECTOR2(0, 0);
+
+	posNodeHead_ = 0;
+	countNode_ = 0;
+	serialNodeHead_ = 0;
+
+	StgContainerPool<LaserNode>::Acquire(listNode_);
+	StgContainerPool<VERTEX_TLX>::Acquire(vertexData_);
+	StgContainerPool<float>::Acquire(listRectIncrement_);
+}
+StgCurveLaserObject::~StgCurveLaserObject() {
+	StgContainerPool<LaserNode>::Recycle(listNode_);
+	StgContainerPool<VERTEX_TLX>::Recycle(vertexData_);
+	StgContainerPool<float>::Recycle(listRectIncrement_);
 }
 
 void StgCurveLaserObject::Clone(DxScriptObjectBase* _src) {
@@ -2371,7 +2891,10 @@ void StgCurveLaserObject::Clone(DxScriptObjectBase* _src) {
 
 	auto src = (StgCurveLaserObject*)_src;
 
-	listPosition_ = src->listPosition_;
+	listNode_ = src->listNode_;
+	posNodeHead_ = src->posNodeHead_;
+	countNode_ = src->countNode_;
+	serialNodeHead_ = src->serialNodeHead_;
 	vertexData_ = src->vertexData_;
 	listRectIncrement_ = src->listRectIncrement_;
 
@@ -2422,7 +2945,6 @@ void StgCurveLaserObject::_Move() {
 
 StgCurveLaserObject::LaserNode StgCurveLaserObject::CreateNode(const D3DXVECTOR2& pos, const D3DXVECTOR2& rFac, float widthMul, D3DCOLOR col) {
 	LaserNode node;
-	node.parent = this;
 	node.pos = pos;
 	{
 		float nx = rFac.x;
@@ -2434,28 +2956,62 @@ StgCurveLaserObject::LaserNode StgCurveLaserObject::CreateNode(const D3DXVECTOR2
 	node.color = col;
 	return node;
 }
-bool StgCurveLaserObject::GetNode(size_t indexNode, std::list<LaserNode>::iterator& res) {
-	//Search from whichever end is closer to the target node index
-	size_t listSizeMax = listPosition_.size();
-	if (indexNode >= listSizeMax) res = listPosition_.end();
-	if (indexNode < listSizeMax / 2U)
-		res = std::next(listPosition_.begin(), indexNode);
-	else
-		res = std::next(listPosition_.rbegin(), listSizeMax - indexNode).base();
-	return res != listPosition_.end();
-}
-void StgCurveLaserObject::GetNodePointerList(std::vector<LaserNode*>* listRes) {
-	listRes->resize(listPosition_.size(), nullptr);
-	size_t i = 0;
-	for (LaserNode& iNode : listPosition_) {
-		(*listRes)[i++] = &iNode;
+StgCurveLaserObject::LaserNode* StgCurveLaserObject::GetNode(size_t indexNode) {
+	if (indexNode >= countNode_) return nullptr;
+	return &_GetNodeAt(indexNode);
+}
+int64_t StgCurveLaserObject::GetNodeHandle(size_t indexNode) {
+	if (indexNode >= countNode_) return 0;
+	uint32_t serial = serialNodeHead_ - (uint32_t)indexNode;
+	return ((int64_t)idObject_ << 32) | serial;
+}
+void StgCurveLaserObject::GetNodeHandleList(std::vector<int64_t>* listRes) {
+	listRes->resize(countNode_);
+	for (size_t i = 0; i < countNode_; ++i)
+		(*listRes)[i] = GetNodeHandle(i);
+}
+StgCurveLaserObject::LaserNode* StgCurveLaserObject::GetNodeFromHandle(int64_t handle) {
+	if ((int)(handle >> 32) != idObject_) return nullptr;
+	uint32_t serial = (uint32_t)handle;
+	return GetNode(serialNodeHead_ - serial);
+}
+StgCurveLaserObject::LaserNode* StgCurveLaserObject::PushNode(const LaserNode& node) {
+	if (length_ == 0) {
+		countNode_ = 0;
+		return nullptr;
+	}
+
+	//A negative length never trimmed the trail, grow the buffer for those instead
+	size_t capacity = listNode_.size();
+	if (length_ > 0 && capacity != (size_t)length_)
+		_ResizeNodeBuffer(length_);
+	else if (length_ < 0 && countNode_ == capacity)
+		_ResizeNodeBuffer(std::max<size_t>(capacity * 2U, 64U));
+
+	posNodeHead_ = (posNodeHead_ == 0 ? listNode_.size() : posNodeHead_) - 1U;
+	listNode_[posNodeHead_] = node;
+	++serialNodeHead_;
+	if (countNode_ < listNode_.size())
+		++countNode_;
+	return &listNode_[posNodeHead_];
+}
+void StgCurveLaserObject::_ResizeNodeBuffer(size_t capacity) {
+	if (countNode_ == 0) {
+		//Nothing to keep, reuses the buffer's capacity
+		listNode_.resize(capacity);
+		posNodeHead_ = 0;
+		return;
 	}
-}
-std::list<StgCurveLaserObject::LaserNode>::iterator StgCurveLaserObject::PushNode(const LaserNode& node) {
-	listPosition_.push_front(node);
-	while (listPosition_.size() > length_)
-		listPosition_.pop_back();
-	return listPosition_.begin();
+
+	//Keeps the newest nodes
+	std::vector<LaserNode> listNew(capacity);
+	size_t count = std::min(countNode_, capacity);
+	for (size_t i = 0; i < count; ++i)
+		listNew[i] = _GetNodeAt(i);
+
+	listNode_.swap(listNew);
+	posNodeHead_ = 0;
+	countNode_ = count;
 }
 
 void StgCurveLaserObject::_DeleteInAutoClip() {
@@ -2468,15 +3024,13 @@ void StgCurveLaserObject::_DeleteInAutoClip() {
 		rcStgFrame->GetWidth() + rcClipBase->right,
 		rcStgFrame->GetHeight() + rcClipBase->bottom);
 
-	//Checks if the node is within the bounding rect
-	auto PredicateNodeInRect = [&](LaserNode& node) {
-		return rcDeleteClip.IsPointIntersected((float*)&node.pos);
-	};
-	std::list<LaserNode>::iterator itrFind = std::find_if(listPosition_.begin(), listPosition_.end(),
-		PredicateNodeInRect);
+	//Checks if any node is within the bounding rect
+	bool bFound = false;
+	for (size_t i = 0; i < countNode_ && !bFound; ++i)
+		bFound = rcDeleteClip.IsPointIntersected((float*)&_GetNodeAt(i).pos);
 
 	//Can't find any node within the bounding rect
-	if (itrFind == listPosition_.end()) {
+	if (!bFound) {
 		auto objectManager = stageController_->GetMainObjectManager();
 		objectManager->DeleteObject(this);
 	}
@@ -2487,7 +3041,7 @@ bool StgCurveLaserObject::GetIntersectionTargetList_NoVector(StgShotData* shotDa
 
 	StgIntersectionManager* intersectionManager = stageController_->GetIntersectionManager();
 
-	size_t countPos = listPosition_.size();
+	size_t countPos = countNode_;
 	size_t countIntersection = countPos > 0U ? countPos - 1U : 0U;
 
 	if (countIntersection == 0)
@@ -2503,8 +3057,7 @@ bool StgCurveLaserObject::GetIntersectionTargetList_NoVector(StgShotData* shotDa
 	int posInvalidE = (int)(countPos * iLengthE);
 	float iWidth = widthIntersection_ * hitboxScale_.x;
 
-	std::list<LaserNode>::iterator itr = listPosition_.begin();
-	for (size_t iPos = 0; iPos < countIntersection; ++iPos, ++itr) {
+	for (size_t iPos = 0; iPos < countIntersection; ++iPos) {
 		IntersectionPairType* pPair = &listIntersectionTarget_[iPos];
 
 		if ((int)iPos < posInvalidS || (int)iPos > posInvalidE) {
@@ -2519,9 +3072,8 @@ bool StgCurveLaserObject::GetIntersectionTargetList_NoVector(StgShotData* shotDa
 		}
 		pPair->first = true;
 
-		std::list<LaserNode>::iterator itrNext = std::next(itr);
-		D3DXVECTOR2* nodeS = &itr->pos;
-		D3DXVECTOR2* nodeE = &itrNext->pos;
+		D3DXVECTOR2* nodeS = &_GetNodeAt(iPos).pos;
+		D3DXVECTOR2* nodeE = &_GetNodeAt(iPos + 1U).pos;
 
 		DxWidthLine* pDstLine = &pTarget->GetLine();
 		*pDstLine = DxWidthLine(nodeS->x, nodeS->y, nodeE->x, nodeE->y, iWidth);
@@ -2583,21 +3135,21 @@ void StgCurveLaserObject::Render(BlendMode targetBlend) {
 	}
 
 	//Render laser
-	if (listPosition_.size() > 1U) {
+	if (countNode_ > 1U) {
 		BlendMode objBlendType = GetBlendType();
 		objBlendType = objBlendType == MODE_BLEND_NONE ? MODE_BLEND_ADD_ARGB : objBlendType;
 
 		if (objBlendType == targetBlend) {
 			StgShotDataFrame* shotFrame = shotData->GetFrame(frameWork_);
 
-			size_t countPos = listPosition_.size();
+			size_t countPos = countNode_;
 			size_t countRect = countPos - 1U;
 			size_t halfPos = countRect / 2U;
 
-			shared_ptr<Texture> texture = shotFrame->GetVertexBufferContainer()->GetTexture();
+			shared_ptr<Texture> texture = shotFrame->GetTexture();
 			D3DXVECTOR2 texSizeInv = D3DXVECTOR2(1.0f / texture->GetWidth(), 1.0f / texture->GetHeight());
 
-			const DxRect<LONG>* rcSrcOrg = shotFrame->GetSourceRect();
+			const DxRect<LONG>* rcSrcOrg = shotFrame->GetTextureRect();
 			const LONG* ptrSrc = reinterpret_cast<const LONG*>(rcSrcOrg);
 
 			float alphaRateShot = shotData->GetAlpha() / 255.0f;
@@ -2627,13 +3179,12 @@ void StgCurveLaserObject::Render(BlendMode targetBlend) {
 					size_t iPos = 0;
 					float remLen = rcMidPt;
 
-					auto tryCap = [&](auto itr) -> bool {
+					auto tryCap = [&](size_t iNode, size_t iNodeNext) -> bool {
 						if (i > halfPos) // Auto-fails if cap crosses the half-way point
 							return false;
 
-						auto itrNext = std::next(itr);
-						D3DXVECTOR2* pos = &itr->pos;
-						D3DXVECTOR2* posNext = &itrNext->pos;
+						D3DXVECTOR2* pos = &_GetNodeAt(iNode).pos;
+						D3DXVECTOR2* posNext = &_GetNodeAt(iNodeNext).pos;
 						// D3DXVECTOR2* off = &itr->vertOff[0];
 						// float wid = std::max(hypotf(off->x, off->y) * 2, 1.0f);
 						float incDist = hypotf(posNext->x - pos->x, posNext->y - pos->y) * incDistFactor;
@@ -2647,20 +3198,17 @@ void StgCurveLaserObject::Render(BlendMode targetBlend) {
 						return true;
 					};
 
-					auto itrHead = listPosition_.begin();
-					auto itrTail = listPosition_.rbegin();
-					auto itrHeadEnd = listPosition_.rend();
-					auto itrTailEnd = listPosition_.end();
-
+					//From the head towards the tail
 					bCappable = true;
-					for (auto itr = itrHead; bCappable && remLen > 0 && itr != itrTailEnd; ++itr, ++i, ++iPos)
-						bCappable = tryCap(itr);
+					for (size_t iNode = 0; bCappable && remLen > 0 && iNode < countPos; ++iNode, ++i, ++iPos)
+						bCappable = tryCap(iNode, iNode + 1U);
 
+					//From the tail towards the head
 					i = 0;
 					iPos = countPos - 2; // Ends straight up do not work otherwise?
 					remLen = rcMidPt;
-					for (auto itr = itrTail; bCappable && remLen > 0 && itr != itrHeadEnd; ++itr, ++i, --iPos)
-						bCappable = tryCap(itr);
+					for (size_t iNode = countPos; bCappable && remLen > 0 && iNode > 0; --iNode, ++i, --iPos)
+						bCappable = tryCap(iNode - 1U, iNode - 2U);
 				}
 				if (!bCappable) // If capping fails (or is disabled), just use the regular increment
 					std::fill(listRectIncrement_.begin(), listRectIncrement_.end(), rcInc);
@@ -2671,8 +3219,9 @@ void StgCurveLaserObject::Render(BlendMode targetBlend) {
 			float inv_halfPos = 1.0f / halfPos, inv_halfPosDec = 1.0f / (halfPos - 1);
 			float halfWidthRender = widthRender_ / 2.0f;
 
-			size_t iPos = 0U;
-			for (auto itr = listPosition_.begin(); itr != listPosition_.end(); ++itr, ++iPos) {
+			for (size_t iPos = 0U; iPos < countPos; ++iPos) {
+				LaserNode* node = &_GetNodeAt(iPos);
+
 				float nodeAlpha = baseAlpha;
 				if (iPos > halfPos)
 					nodeAlpha = Math::Lerp::Linear(baseAlpha, tipAlpha, (iPos - halfPos + 1) * inv_halfPos);
@@ -2680,21 +3229,21 @@ void StgCurveLaserObject::Render(BlendMode targetBlend) {
 					nodeAlpha = Math::Lerp::Linear(tipAlpha, baseAlpha, iPos * inv_halfPosDec);
 				nodeAlpha = std::max(0.0f, nodeAlpha);
 
-				float renderWd = std::max(halfWidthRender * itr->widthMul, 1.0f) * scale_.x;
+				float renderWd = std::max(halfWidthRender * node->widthMul, 1.0f) * scale_.x;
 
 				D3DCOLOR thisColor = 0xffffffff;
 				{
 					byte alpha = ColorAccess::ClampColorRet(nodeAlpha * alphaRateShot);
 					thisColor = (thisColor & 0x00ffffff) | (alpha << 24);
 				}
-				if (itr->color != 0xffffffff) ColorAccess::MultiplyColor(thisColor, itr->color);
+				if (node->color != 0xffffffff) ColorAccess::MultiplyColor(thisColor, node->color);
 
 				for (size_t iVert = 0U; iVert < 2U; ++iVert) {
 					VERTEX_TLX* pv = &vertexData_[iPos * 2 + iVert];
 
 					_SetVertexUV(pv, ptrSrc[(iVert & 1) << 1] * texSizeInv.x, rectV);
-					_SetVertexPosition(pv, itr->pos.x + itr->vertOff[iVert].x * renderWd,
-						itr->pos.y + itr->vertOff[iVert].y * renderWd, position_.z);
+					_SetVertexPosition(pv, node->pos.x + node->vertOff[iVert].x * renderWd,
+						node->pos.y + node->vertOff[iVert].y * renderWd, position_.z);
 					_SetVertexColorARGB(pv, thisColor);
 				}
 
@@ -2702,6 +3251,8 @@ void StgCurveLaserObject::Render(BlendMode targetBlend) {
 			}
 
 			{
+				shotManager->FlushRenderBatch();
+
 				DirectGraphics* graphics = DirectGraphics::GetBase();
 				IDirect3DDevice9* device = graphics->GetDevice();
 
@@ -2734,8 +3285,10 @@ void StgCurveLaserObject::Render(BlendMode targetBlend) {
 
 				{
 					ID3DXEffect* effect = shotManager->GetEffect();
+					const ShaderSemanticTable* semantic = shotManager->GetEffectSemantic();
 					if (shader_) {
 						effect = shader_->GetEffect();
+						semantic = shader_->GetSemanticTable();
 						if (shader_->LoadTechnique()) {
 							shader_->LoadParameter();
 						}
@@ -2743,15 +3296,15 @@ void StgCurveLaserObject::Render(BlendMode targetBlend) {
 
 					if (effect) {
 						D3DXHANDLE handle = nullptr;
-						if (handle = effect->GetParameterBySemantic(nullptr, "WORLD")) {
+						if (handle = semantic->Get(ShaderSemanticTable::WORLD)) {
 							effect->SetMatrix(handle, &graphics->GetCamera()->GetIdentity());
 						}
 						if (shader_) {
-							if (handle = effect->GetParameterBySemantic(nullptr, "VIEWPROJECTION")) {
+							if (handle = semantic->Get(ShaderSemanticTable::VIEWPROJECTION)) {
 								effect->SetMatrix(handle, shotManager->GetProjectionMatrix());
 							}
 						}
-						if (handle = effect->GetParameterBySemantic(nullptr, "ICOLOR")) {
+						if (handle = semantic->Get(ShaderSemanticTable::ICOLOR)) {
 							//To normalized RGBA vector
 							D3DXVECTOR4 vColor = ColorAccess::ToVec4Normalized(color_, ColorAccess::PERMUTE_RGBA);
 							effect->SetVector(handle, &vColor);
@@ -2761,7 +3314,7 @@ void StgCurveLaserObject::Render(BlendMode targetBlend) {
 						effect->Begin(&countPass, D3DXFX_DONOTSAVESHADERSTATE);
 						for (UINT iPass = 0; iPass < countPass; ++iPass) {
 							effect->BeginPass(iPass);
-							device->DrawPrimitive(D3DPT_TRIANGLESTRIP, 0, countPrim);
+							graphics->DrawPrimitive(D3DPT_TRIANGLESTRIP, 0, countPrim);
 							effect->EndPass();
 						}
 						effect->End();
@@ -2784,6 +3337,7 @@ void StgCurveLaserObject::_SendDeleteEvent(TypeDelete type) {
 	if (!shotManager->IsDeleteEventEnable(type)) return;
 
 	auto itemScript = stageScriptManager->GetItemScript().lock();
+	bool bBatch = shotManager->IsDeleteEventBatchEnable();
 
 	{
 		int typeEvent = StgShotManager::_TypeDeleteToEventType(type);
@@ -2794,7 +3348,10 @@ void StgCurveLaserObject::_SendDeleteEvent(TypeDelete type) {
 
 		size_t countToItem = 0U;
 		auto _RequestItem = [&](double ix, double iy) {
-			if (itemScript) {
+			if (bBatch) {
+				shotManager->AddDeleteEventBatch(type, idObject_, ix, iy, GetShotDataID());
+			}
+			else if (itemScript) {
 				listScriptValue[1] = itemScript->CreateFloatArrayValue(Math::DVec2{ ix, iy });
 				itemScript->RequestEvent(typeEvent, listScriptValue, 3);
 			}
@@ -2818,12 +3375,9 @@ void StgCurveLaserObject::_SendDeleteEvent(TypeDelete type) {
 		};
 
 		float lengthAcc = 0.0;
-		for (std::list<LaserNode>::iterator itr = listPosition_.begin(); itr != listPosition_.end(); itr++) {
-			std::list<LaserNode>::iterator itrNext = std::next(itr);
-			if (itrNext == listPosition_.end()) break;
-
-			D3DXVECTOR2* pos = &itr->pos;
-			D3DXVECTOR2* posNext = &itrNext->pos;
+		for (size_t iNode = 0; iNode + 1U < countNode_; ++iNode) {
+			D3DXVECTOR2* pos = &_GetNodeAt(iNode).pos;
+			D3DXVECTOR2* posNext = &_GetNodeAt(iNode + 1U).pos;
 			float nodeDist = hypotf(posNext->x - pos->x, posNext->y - pos->y);
 			lengthAcc += nodeDist;
 
@@ -2906,11 +3460,21 @@ void StgShotPatternGeneratorObject::Clone(DxScriptObjectBase* _src) {
 	laserLength_ = src->laserLength_;
 
 	listTransformation_ = src->listTransformation_;
+	transformProgram_ = src->transformProgram_;
 }
 
+void StgShotPatternGeneratorObject::AddTransformation(StgShotPatternTransform& entry) {
+	listTransformation_.push_back(entry);
+	transformProgram_ = nullptr;
+}
 void StgShotPatternGeneratorObject::SetTransformation(size_t off, StgShotPatternTransform& entry) {
 	if (off >= listTransformation_.size()) listTransformation_.resize(off + 1);
 	listTransformation_[off] = entry;
+	transformProgram_ = nullptr;
+}
+void StgShotPatternGeneratorObject::ClearTransformation() {
+	listTransformation_.clear();
+	transformProgram_ = nullptr;
 }
 
 void StgShotPatternGeneratorObject::FireSet(void* scriptData, StgStageController* controller, std::vector<int>* idVector) {
@@ -2938,69 +3502,18 @@ void StgShotPatternGeneratorObject::FireSet(void* scriptData, StgStageController
 	basePosX += basePointOffsetX_;
 	basePosY += basePointOffsetY_;
 
-	std::list<StgShotPatternTransform> transformAsList;
-	for (StgShotPatternTransform& iTransform : listTransformation_)
-		transformAsList.push_back(iTransform);
-
-	auto __CreateShot = [&](float _x, float _y, double _ss, double _sa) -> bool {
-		if (shotManager->GetShotCountAll() >= StgShotManager::SHOT_MAX) return false;
-
-		ref_unsync_ptr<StgShotObject> objShot;
-		switch (typeShot_) {
-		case TypeObject::Shot:
-		{
-			ref_unsync_ptr<StgNormalShotObject> ptrShot(new StgNormalShotObject(controller));
-			objShot = ptrShot;
-			break;
-		}
-		case TypeObject::LooseLaser:
-		{
-			ref_unsync_ptr<StgLooseLaserObject> ptrShot(new StgLooseLaserObject(controller));
-			ptrShot->SetLength(laserLength_);
-			ptrShot->SetRenderWidth(laserWidth_);
-			objShot = ptrShot;
-			break;
-		}
-		case TypeObject::StraightLaser:
-		{
-			ref_unsync_ptr<StgStraightLaserObject> ptrShot(new StgStraightLaserObject(controller));
-			ptrShot->SetLength(laserLength_);
-			ptrShot->SetRenderWidth(laserWidth_);
-			objShot = ptrShot;
-			break;
-		}
-		case TypeObject::CurveLaser:
-		{
-			ref_unsync_ptr<StgCurveLaserObject> ptrShot(new StgCurveLaserObject(controller));
-			ptrShot->SetLength(laserLength_);
-			ptrShot->SetRenderWidth(laserWidth_);
-			objShot = ptrShot;
-			break;
-		}
-		}
-
-		if (objShot == nullptr) return false;
-
-		objShot->SetX(_x);
-		objShot->SetY(_y);
-		objShot->SetSpeed(_ss);
-		objShot->SetDirectionAngle(_sa);
-		objShot->SetShotDataID(idShotData_);
-		objShot->SetDelay(delay_);
-		objShot->SetOwnerType(typeOwner_);
-
-		objShot->SetTransformList(transformAsList);
-
-		objShot->SetBlendType(iniBlendType_);
-		//objShot->SetEnableDelayMotion(delayMove_);
-
-		int idRes = script->AddObject(objShot);
-		if (idRes == DxScript::ID_INVALID) return false;
-
-		shotManager->AddShot(objShot);
+	//Positions and motion are computed first, then all the shots are created in one pass
+	struct FireParam {
+		float x;
+		float y;
+		double speed;
+		double angle;
+	};
+	std::vector<FireParam> listFire;
+	listFire.reserve(shotWay_ * shotStack_);
 
-		if (idVector) idVector->push_back(idRes);
-		return true;
+	auto __CreateShot = [&](float _x, float _y, double _ss, double _sa) {
+		listFire.push_back({ _x, _y, _ss, _sa });
 	};
 
 	{
@@ -3240,4 +3753,102 @@ void StgShotPatternGeneratorObject::FireSet(void* scriptData, StgStageController
 		}
 		}
 	}
-}
\ No newline at end of file
+
+	size_t countShot = shotManager->GetShotCountAll();
+	size_t countFire = countShot < StgShotManager::SHOT_MAX ?
+		std::min(listFire.size(), StgShotManager::SHOT_MAX - countShot) : 0U;
+	if (countFire == 0U) return;
+
+	size_t sizeObject = 0;
+	switch (typeShot_) {
+	case TypeObject::Shot:
+		sizeObject = sizeof(StgNormalShotObject);
+		break;
+	case TypeObject::LooseLaser:
+		sizeObject = sizeof(StgLooseLaserObject);
+		break;
+	case TypeObject::StraightLaser:
+		sizeObject = sizeof(StgStraightLaserObject);
+		break;
+	case TypeObject::CurveLaser:
+		sizeObject = sizeof(StgCurveLaserObject);
+		break;
+	default:
+		return;
+	}
+	StgObjectPool::Reserve(sizeObject, countFire);
+	objManager->ReserveObject(countFire);
+	if (idVector) idVector->reserve(countFire);
+
+	if (transformProgram_ == nullptr && listTransformation_.size() > 0)
+		transformProgram_.reset(new StgShotTransformProgram(listTransformation_));
+
+	for (size_t iFire = 0; iFire < countFire; ++iFire) {
+		const FireParam& param = listFire[iFire];
+
+		ref_unsync_ptr<StgShotObject> objShot;
+		switch (typeShot_) {
+		case TypeObject::Shot:
+			objShot.reset(new StgNormalShotObject(controller));
+			break;
+		case TypeObject::LooseLaser:
+			objShot.reset(new StgLooseLaserObject(controller));
+			break;
+		case TypeObject::StraightLaser:
+			objShot.reset(new StgStraightLaserObject(controller));
+			break;
+		case TypeObject::CurveLaser:
+			objShot.reset(new StgCurveLaserObject(controller));
+			break;
+		}
+
+		if (typeShot_ != TypeObject::Shot) {
+			StgLaserObject* objLaser = (StgLaserObject*)objShot.get();
+			objLaser->SetLength(laserLength_);
+			objLaser->SetRenderWidth(laserWidth_);
+		}
+
+		objShot->SetX(param.x);
+		objShot->SetY(param.y);
+		objShot->SetSpeed(param.speed);
+		objShot->SetDirectionAngle(param.angle);
+		objShot->SetShotDataID(idShotData_);
+		objShot->SetDelay(delay_);
+		objShot->SetOwnerType(typeOwner_);
+
+		if (transformProgram_ != nullptr)
+			objShot->SetTransformProgram(transformProgram_);
+
+		objShot->SetBlendType(iniBlendType_);
+		//objShot->SetEnableDelayMotion(delayMove_);
+
+		int idRes = script->AddObject(objShot);
+		if (idRes == DxScript::ID_INVALID) continue;
+
+		shotManager->AddShot(objShot);
+
+		if (idVector) idVector->push_back(idRes);
+	}
+}
+
+//****************************************************************************
+//StgShotTransformProgram
+//****************************************************************************
+StgShotTransformProgram::StgShotTransformProgram(const std::vector<StgShotPatternTransform>& listTransform) {
+	listOp_.resize(listTransform.size());
+	for (size_t i = 0; i < listTransform.size(); ++i) {
+		Op& op = listOp_[i];
+		op.transform = listTransform[i];
+		op.frameAdvance = 0;
+
+		const double* param = op.transform.param;
+		switch (op.transform.act) {
+		case StgShotPatternTransform::TRANSFORM_WAIT:
+			op.frameAdvance = std::max((int)param[0], 0);
+			break;
+		case StgShotPatternTransform::TRANSFORM_N_DECEL_CHANGE:
+			op.frameAdvance = (int)param[0] * (int)param[1];
+			break;
+		}
+	}
+}
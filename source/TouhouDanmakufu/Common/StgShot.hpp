@@ -10,6 +10,43 @@ class StgShotData;
 struct StgShotDataFrame;
 class StgShotVertexBufferContainer;
 class StgShotObject;
+class StgEnemyObject;
+
+//Enemy hit cooldown of a player shot, keyed by the enemy's object ID
+struct StgEnemyHitCooldown {
+	int idEnemy;
+	ref_unsync_weak_ptr<StgEnemyObject> pEnemy;		//Expires with the enemy, guards against reused object IDs
+	DWORD frameExpire;
+};
+//*******************************************************************
+//StgShotQuadStream
+//*******************************************************************
+//CPU-built quads for batched shot rendering. Doesn't touch the device, so it works without one.
+class StgShotQuadStream {
+public:
+	enum : size_t {
+		QUAD_MAX = 8192,	//Keeps the indices within the shared 16-bit index buffer
+	};
+private:
+	std::vector<VERTEX_TLX> listVertex_;
+	size_t countQuad_;
+public:
+	StgShotQuadStream();
+
+	//Transforms a quad in strip order (TL, TR, BL, BR) by [matWorld] and bakes in [color]
+	static void BuildQuad(VERTEX_TLX* dst, const VERTEX_TLX* src, const D3DXMATRIX& matWorld, D3DCOLOR color);
+	//Triangle list indices for [countQuad] consecutive quads
+	static void BuildIndex(uint16_t* dst, size_t countQuad);
+
+	//Returns false when the stream is full
+	bool AddQuad(const VERTEX_TLX* src, const D3DXMATRIX& matWorld, D3DCOLOR color);
+	void Clear() { countQuad_ = 0; }
+
+	size_t GetQuadCount() const { return countQuad_; }
+	size_t GetVertexCount() const { return countQuad_ * 4U; }
+	std::vector<VERTEX_TLX>& GetVertexList() { return listVertex_; }
+};
+
 //*******************************************************************
 //StgShotManager
 //*******************************************************************
@@ -39,32 +76,74 @@ public:
 		SHOT_MAX = 10000,
 
 		BLEND_COUNT = 8,
+
+		RENDER_PASS_ALL = BLEND_COUNT,		//Shots that take part in every blend pass
+		RENDER_PASS_COUNT,
 	};
 protected:
 	static std::array<BlendMode, BLEND_COUNT> blendTypeRenderOrder;
-	struct RenderQueue {
-		size_t count;
-		std::vector<StgShotObject*> listShot;
-	};
 protected:
 	StgStageController* stageController_;
 
 	unique_ptr<StgShotDataList> listPlayerShotData_;
 	unique_ptr<StgShotDataList> listEnemyShotData_;
 
-	std::list<ref_unsync_ptr<StgShotObject>> listObj_;
-	std::vector<RenderQueue> listRenderQueuePlayer_;		//one for each render pri
-	std::vector<RenderQueue> listRenderQueueEnemy_;			//one for each render pri
+	std::vector<ref_unsync_ptr<StgShotObject>> listObj_;		//Contiguous, in creation order
+
+	//Visible shots as indices into listObj_, bucketed by (render pri, owner, blend pass) once per frame
+	size_t countRenderPriority_;
+	BucketIndexList listRenderIndex_;
+	size_t _GetRenderBucket(size_t pri, bool bPlayer, size_t pass) {
+		return (pri * 2U + (bPlayer ? 0U : 1U)) * RENDER_PASS_COUNT + pass;
+	}
+	static size_t _GetRenderPass(BlendMode blend);
+
+	//Consecutive default-rendered shots that share a texture are drawn in one call
+	StgShotQuadStream streamBatch_;
+	IDirect3DTexture9* pBatchTexture_;
+	std::vector<uint16_t> listBatchIndex_;
+
+	//Opt-in, the batches are drawn as one hardware instance per shot instead
+	bool bRenderInstancing_;
+	StgInstanceStream streamInstance_;
+	ID3DXEffect* effectInstance_;
+	const ShaderSemanticTable* semanticInstance_;
+
+	//Shots outside the camera's view are left out of the render queue
+	StgRenderCuller cullRender_;
+	size_t countRenderCulled_;
 
 	std::bitset<(int)TypeDelete::_Max> listDeleteEventEnable_;
 
+	//Opt-in, delete events are collected over the frame and sent as one event per type
+	struct DeleteEventBatch {
+		std::vector<int> listId;
+		std::vector<double> listPos;	//Packed as [x0, y0, x1, y1, ...]
+		std::vector<int> listGraphic;
+	};
+	bool bDeleteEventBatch_;
+	std::array<DeleteEventBatch, (size_t)TypeDelete::_Max> listDeleteEventBatch_;
+
 	DxRect<LONG> rcDeleteClip_;
 
 	D3DTEXTUREFILTERTYPE filterMin_;
 	D3DTEXTUREFILTERTYPE filterMag_;
 
 	ID3DXEffect* effectShot_;
+	const ShaderSemanticTable* semanticShot_;
 	D3DXMATRIX matProj_;
+
+	//Spatial index for the script area queries, rebuilt lazily whenever a shot moves or is added
+	bool bSpatialIndexValid_;
+	StgIntersectionGrid gridSpatialIndex_;
+	std::vector<StgShotObject*> listSpatialIndexObj_;
+	std::vector<uint32_t> listSpatialQueryResult_;
+
+	void _UpdateSpatialIndex();
+	std::vector<uint32_t>& _QuerySpatialIndex(const DxRect<LONG>& rect);
+
+	//Cooldowns of penetrating shots that outgrew their inline slots
+	std::unordered_multimap<StgShotObject*, StgEnemyHitCooldown> mapEnemyHitCooldown_;
 public:
 	IDirect3DTexture9* pLastTexture_;
 public:
@@ -74,12 +153,22 @@ public:
 	void Work();
 	void Render(int targetPriority);
 	void LoadRenderQueue();
+	const BucketIndexList& GetRenderQueue() { return listRenderIndex_; }
+	size_t GetRenderVisibleCount() { return listRenderIndex_.GetSize(); }
+	size_t GetRenderCulledCount() { return countRenderCulled_; }
 
 	void RegistIntersectionTarget();
 
 	void AddShot(ref_unsync_ptr<StgShotObject> obj);
 
+	void AddRenderBatch(IDirect3DTexture9* texture, const VERTEX_TLX* quad, const D3DXMATRIX& matWorld, D3DCOLOR color);
+	void FlushRenderBatch();
+
+	void SetRenderInstancingEnable(bool bEnable) { bRenderInstancing_ = bEnable; }
+	bool IsRenderInstancingEnable() { return bRenderInstancing_; }
+
 	ID3DXEffect* GetEffect() { return effectShot_; }
+	const ShaderSemanticTable* GetEffectSemantic() { return semanticShot_; }
 	D3DXMATRIX* GetProjectionMatrix() { return &matProj_; }
 
 	StgShotDataList* GetPlayerShotDataList() { return listPlayerShotData_.get(); }
@@ -96,13 +185,27 @@ public:
 		filterMag_ = mag;
 	}
 
+	void InvalidateSpatialIndex() { bSpatialIndexValid_ = false; }
+
 	void DeleteInCircle(int typeDelete, int typeTo, int typeOwner, int cx, int cy, optional<int> radius);
+	void DeleteInArea(int typeDelete, int typeTo, int typeOwner, const StgIntersectionArea& area);
 	std::vector<int> GetShotIdInCircle(int typeOwner, int cx, int cy, optional<int> radius);
+	std::vector<int> GetShotIdInArea(int typeOwner, const StgIntersectionArea& area);
 	size_t GetShotCount(int typeOwner);
 	size_t GetShotCountAll() { return listObj_.size(); }
 
 	void SetDeleteEventEnableByType(int type, bool bEnable);
 	bool IsDeleteEventEnable(TypeDelete bit) { return listDeleteEventEnable_[(int)bit]; }
+
+	void SetDeleteEventBatchEnable(bool bEnable);
+	bool IsDeleteEventBatchEnable() { return bDeleteEventBatch_; }
+	void AddDeleteEventBatch(TypeDelete type, int id, double x, double y, int graphic);
+	void SendDeleteEventBatch();
+
+	StgEnemyHitCooldown* FindEnemyHitCooldown(StgShotObject* shot, int idEnemy);
+	void AddEnemyHitCooldown(StgShotObject* shot, const StgEnemyHitCooldown& cooldown);
+	void CopyEnemyHitCooldown(StgShotObject* dest, StgShotObject* src);
+	void ReleaseEnemyHitCooldown(StgShotObject* shot) { mapEnemyHitCooldown_.erase(shot); }
 };
 
 //*******************************************************************
@@ -115,6 +218,8 @@ protected:
 	std::map<std::wstring, VBContainerList> mapVertexBuffer_;	//<shot data file, vb list>
 	std::vector<unique_ptr<StgShotData>> listData_;
 
+	TextureAtlas atlas_;
+
 	int defaultDelayData_;
 	D3DCOLOR defaultDelayColor_;
 
@@ -188,15 +293,31 @@ struct StgShotDataFrame {
 	DxRect<LONG> rcSrc_;
 	DxRect<float> rcDst_;
 
+	shared_ptr<Texture> texture_;	//Atlas page the frame was packed into, or the shot sheet
+	DxRect<LONG> rcTexture_;		//rcSrc_ on texture_
+
+	StgRenderQuad quad_;
+
 	size_t frame_;
 public:
 	StgShotDataFrame();
 
 	DxRect<LONG>* GetSourceRect() { return &rcSrc_; }
 	DxRect<float>* GetDestRect() { return &rcDst_; }
+	//Distance from the frame's origin to its farthest corner
+	float GetRadius() {
+		float dx = std::max(fabsf(rcDst_.left), fabsf(rcDst_.right));
+		float dy = std::max(fabsf(rcDst_.top), fabsf(rcDst_.bottom));
+		return sqrtf(dx * dx + dy * dy);
+	}
 	StgShotVertexBufferContainer* GetVertexBufferContainer() {
 		return pVertexBuffer_;
 	}
+	const VERTEX_TLX* GetQuadVertex() { return quad_.Get(); }
+
+	shared_ptr<Texture> GetTexture() { return texture_; }
+	IDirect3DTexture9* GetD3DTexture() { return texture_ ? texture_->GetD3DTexture() : nullptr; }
+	const DxRect<LONG>* GetTextureRect() { return &rcTexture_; }
 
 	static DxRect<float> LoadDestRect(DxRect<LONG>* src);
 };
@@ -235,9 +356,14 @@ public:
 //StgShotObject
 //*******************************************************************
 struct StgShotPatternTransform;
+class StgShotTransformProgram;
 class StgShotObject : public DxScriptShaderObject, public StgMoveObject, public StgIntersectionObject {
 protected:
 	using TypeDelete = StgShotManager::TypeDelete;
+public:
+	//Storage is recycled through StgObjectPool
+	static void* operator new(size_t size) { return StgObjectPool::Allocate(size); }
+	static void operator delete(void* ptr, size_t size) { StgObjectPool::Release(ptr, size); }
 public:
 	enum {
 		OWNER_PLAYER = 0,
@@ -313,15 +439,16 @@ protected:
 	bool bPenetrateShot_; // Translation: Does The Shot Lose Penetration Points Upon Colliding With Another Shot And Not An Enemy
 
 	weak_ptr<Texture> renderTarget_;
-private:
-	struct _WeakPtrHasher {
-		std::size_t operator()(const ref_unsync_weak_ptr<StgEnemyObject>& k) const {
-			return std::hash<StgEnemyObject*>{}(k.get());
-		}
-	};
 public:
+	enum {
+		ENEMY_HIT_COOLDOWN_INLINE = 4,
+	};
+
 	uint32_t frameEnemyHitInvalid_;
-	std::unordered_map<ref_unsync_weak_ptr<StgEnemyObject>, uint32_t, _WeakPtrHasher> mapEnemyHitCooldown_;
+	//Most shots only ever cool down against a few enemies at once, the rest spill into the manager
+	StgEnemyHitCooldown listEnemyHitCooldown_[ENEMY_HIT_COOLDOWN_INLINE];
+	uint8_t countEnemyHitCooldown_;
+	bool bEnemyHitCooldownSpill_;
 	
 	bool bRequestedPlayerDeleteEvent_;
 	double damage_;
@@ -363,7 +490,8 @@ protected:
 
 	inline void _DefaultShotRender(StgShotData* shotData, StgShotDataFrame* shotFrame, const D3DXMATRIX& matWorld, D3DCOLOR color);
 protected:
-	std::list<StgShotPatternTransform> listTransformationShotAct_;
+	ref_unsync_ptr<StgShotTransformProgram> transformProgram_;
+	size_t pcTransform_;
 	int timerTransform_;
 	int timerTransformNext_;
 
@@ -381,6 +509,10 @@ public:
 
 	virtual void Render() {};
 	virtual void Render(BlendMode targetBlend) = 0;
+	//The only blend pass this shot renders in, or MODE_BLEND_NONE if it may render in several
+	virtual BlendMode GetRenderPassBlend() { return MODE_BLEND_NONE; }
+	//Bounding circle of what Render draws, returns StgRenderCuller::RADIUS_NO_CULL if it can't be bounded
+	virtual float GetRenderBound(D3DXVECTOR2* pos) { return StgRenderCuller::RADIUS_NO_CULL; }
 
 	virtual void SetRenderTarget(shared_ptr<Texture> texture) { renderTarget_ = texture; }
 
@@ -391,15 +523,13 @@ public:
 	virtual void ClearShotObject() { ClearIntersectionRelativeTarget(); }
 	virtual void RegistIntersectionTarget() = 0;
 
-	virtual void SetX(float x) { posX_ = x; DxScriptRenderObject::SetX(x); }
-	virtual void SetY(float y) { posY_ = y; DxScriptRenderObject::SetY(y); }
+	virtual void SetX(float x);
+	virtual void SetY(float y);
 	virtual void SetColor(int r, int g, int b);
 	virtual void SetAlpha(int alpha);
 	virtual void SetRenderState() {}
 
-	void SetTransformList(const std::list<StgShotPatternTransform>& listTransform) {
-		listTransformationShotAct_ = listTransform;
-	}
+	void SetTransformProgram(ref_unsync_ptr<StgShotTransformProgram> program);
 
 	void SetOwnObjectReference();
 
@@ -420,8 +550,9 @@ public:
 	uint32_t GetEnemyIntersectionInvalidFrame() { return frameEnemyHitInvalid_;  }
 
 	//Returns true if obj is on hit cooldown
-	bool CheckEnemyHitCooldownExists(ref_unsync_weak_ptr<StgEnemyObject> obj);
-	void AddEnemyHitCooldown(ref_unsync_weak_ptr<StgEnemyObject> obj, uint32_t time);
+	bool CheckEnemyHitCooldownExists(StgEnemyObject* obj);
+	void AddEnemyHitCooldown(StgEnemyObject* obj, uint32_t time);
+	bool IsEnemyHitCooldownSpilled() { return bEnemyHitCooldownSpill_; }
 
 	int GetDelay() { return delay_.time; }
 	void SetDelay(int delay) { delay_.time = delay; }
@@ -484,6 +615,8 @@ public:
 
 	virtual void Work();
 	virtual void Render(BlendMode targetBlend);
+	virtual BlendMode GetRenderPassBlend();
+	virtual float GetRenderBound(D3DXVECTOR2* pos);
 
 	virtual void ClearShotObject() {
 		ClearIntersectionRelativeTarget();
@@ -626,7 +759,6 @@ public:
 class StgCurveLaserObject : public StgLaserObject {
 public:
 	struct LaserNode {
-		StgCurveLaserObject* parent;
 		D3DXVECTOR2 pos;
 		D3DXVECTOR2 vertOff[2];
 		D3DCOLOR color;
@@ -637,7 +769,13 @@ public:
 		MAP_CAPPED
 	};
 protected:
-	std::list<LaserNode> listPosition_;
+	//Ring buffer sized from the laser length, index 0 is the newest node
+	std::vector<LaserNode> listNode_;
+	size_t posNodeHead_;
+	size_t countNode_;
+	//Push count, the node at index i was pushed as serialNodeHead_ - i
+	uint32_t serialNodeHead_;
+
 	std::vector<VERTEX_TLX> vertexData_;
 	std::vector<float> listRectIncrement_;
 
@@ -652,8 +790,16 @@ protected:
 	virtual void _DeleteInAutoClip();
 	virtual void _Move();
 	virtual void _SendDeleteEvent(TypeDelete type);
+
+	inline LaserNode& _GetNodeAt(size_t index) {
+		size_t pos = posNodeHead_ + index;
+		if (pos >= listNode_.size()) pos -= listNode_.size();
+		return listNode_[pos];
+	}
+	void _ResizeNodeBuffer(size_t capacity);
 public:
 	StgCurveLaserObject(StgStageController* stageController);
+	virtual ~StgCurveLaserObject();
 
 	virtual void Clone(DxScriptObjectBase* src);
 
@@ -666,9 +812,15 @@ public:
 	void SetTipCapping(bool enable) { bCap_ = enable; }
 
 	LaserNode CreateNode(const D3DXVECTOR2& pos, const D3DXVECTOR2& rFac, float widthMul, D3DCOLOR col = 0xffffffff);
-	bool GetNode(size_t indexNode, std::list<LaserNode>::iterator& res);
-	void GetNodePointerList(std::vector<LaserNode*>* listRes);
-	std::list<LaserNode>::iterator PushNode(const LaserNode& node);
+	size_t GetNodeCount() { return countNode_; }
+	LaserNode* GetNode(size_t indexNode);
+	LaserNode* PushNode(const LaserNode& node);
+
+	//Scripts refer to nodes by handle, (object ID << 32 | push serial).
+	//	The ring buffer moves nodes around, a handle stays valid until its node is trimmed off.
+	int64_t GetNodeHandle(size_t indexNode);
+	void GetNodeHandleList(std::vector<int64_t>* listRes);
+	LaserNode* GetNodeFromHandle(int64_t handle);
 };
 
 
@@ -733,6 +885,7 @@ private:
 	int laserLength_;
 
 	std::vector<StgShotPatternTransform> listTransformation_;
+	ref_unsync_ptr<StgShotTransformProgram> transformProgram_;	//Compiled from listTransformation_ on the next fire
 public:
 	StgShotPatternGeneratorObject(StgStageController* stageController);
 
@@ -741,9 +894,9 @@ public:
 	virtual void Render() {}
 	virtual void SetRenderState() {}
 
-	void AddTransformation(StgShotPatternTransform& entry) { listTransformation_.push_back(entry); }
+	void AddTransformation(StgShotPatternTransform& entry);
 	void SetTransformation(size_t off, StgShotPatternTransform& entry);
-	void ClearTransformation() { listTransformation_.clear(); }
+	void ClearTransformation();
 
 	void SetParent(ref_unsync_ptr<StgMoveObject> obj) { parent_ = obj; }
 
@@ -805,4 +958,23 @@ struct StgShotPatternTransform {
 	};
 	uint8_t act = 0xff;
 	double param[8];
-};
\ No newline at end of file
+};
+
+//*******************************************************************
+//StgShotTransformProgram
+//*******************************************************************
+//Immutable, shared by every shot fired with the same transformations. Shots only keep a program counter into it.
+class StgShotTransformProgram {
+public:
+	struct Op {
+		StgShotPatternTransform transform;
+		int frameAdvance;	//Frames until the next op runs, resolved at compile time
+	};
+private:
+	std::vector<Op> listOp_;
+public:
+	StgShotTransformProgram(const std::vector<StgShotPatternTransform>& listTransform);
+
+	size_t GetSize() const { return listOp_.size(); }
+	const Op& GetOp(size_t pc) const { return listOp_[pc]; }
+};
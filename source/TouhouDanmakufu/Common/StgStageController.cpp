@@ -360,6 +360,9 @@ void StgStageController::Work() {
 			if (objPlayer)
 				objPlayer->SendGrazeEvent();
 
+			//Process batched shot delete events
+			shotManager_->SendDeleteEventBatch();
+
 			if (!infoStage_->IsReplay()) {
 				//Add FPS entry to the replay data
 				DWORD stageFrame = infoStage_->GetCurrentFrame();
@@ -383,6 +386,10 @@ void StgStageController::Work() {
 	infoLog->SetInfo(6, "Shot count", std::to_string(shotManager_->GetShotCountAll()));
 	infoLog->SetInfo(7, "Enemy count", std::to_string(enemyManager_->GetEnemyCount()));
 	infoLog->SetInfo(8, "Item count", std::to_string(itemManager_->GetItemCount()));
+	//Without the pool, every creation would have been a heap allocation
+	infoLog->SetInfo(10, "Object alloc", StringUtility::Format("Create=%4d, Heap=%4d, Pooled=%5d",
+		(int)StgObjectPool::GetCreateCount(), (int)StgObjectPool::GetHeapAllocCount(), (int)StgObjectPool::GetFreeCount()));
+	StgObjectPool::ResetFrameCount();
 }
 void StgStageController::Render() {
 	bool bPause = infoStage_->IsPause();
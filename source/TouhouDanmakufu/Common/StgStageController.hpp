@@ -66,6 +66,8 @@ public:
 
 	ref_unsync_ptr<DxScriptObjectBase> GetMainRenderObject(int idObject) { return objectManagerMain_->GetObject(idObject); }
 	ref_unsync_ptr<StgPlayerObject> GetPlayerObject() { return objectManagerMain_->GetPlayerObject(); }
+	//Doesn't touch the refcount, for object updates running on worker threads
+	StgPlayerObject* GetPlayerObjectPointer() { return objectManagerMain_->GetPlayerObjectPointer(); }
 };
 
 
@@ -311,6 +311,10 @@ static const std::vector<function> stgStageFunction = {
 	//STG共通関数：弾
 	{ "DeleteShotAll", StgStageScript::Func_DeleteShotAll, 2 },
 	{ "DeleteShotInCircle", StgStageScript::Func_DeleteShotInCircle, 5 },
+	{ "DeleteShotInRect", StgStageScript::Func_DeleteShotInArea<StgIntersectionArea::AREA_RECT>, 6 },
+	{ "DeleteShotInRotatedRect", StgStageScript::Func_DeleteShotInArea<StgIntersectionArea::AREA_ROTATED_RECT>, 7 },
+	{ "DeleteShotInLine", StgStageScript::Func_DeleteShotInArea<StgIntersectionArea::AREA_LINE>, 7 },
+	{ "DeleteShotInSector", StgStageScript::Func_DeleteShotInArea<StgIntersectionArea::AREA_SECTOR>, 7 },
 	{ "CreateShotA1", StgStageScript::Func_CreateShotA1, 6 },
 	{ "CreateShotA2", StgStageScript::Func_CreateShotA2, 8 }, //Deprecated, exists for compatibility
 	{ "CreateShotA2", StgStageScript::Func_CreateShotA2, 9 },
@@ -329,11 +333,21 @@ static const std::vector<function> stgStageFunction = {
 	{ "GetAllShotID", StgStageScript::Func_GetAllShotID, 1 },
 	{ "GetShotIdInCircleA1", StgStageScript::Func_GetShotIdInCircleA1, 3 },
 	{ "GetShotIdInCircleA2", StgStageScript::Func_GetShotIdInCircleA2, 4 },
+	{ "GetShotIdInRectA1", StgStageScript::Func_GetShotIdInAreaA1<StgIntersectionArea::AREA_RECT>, 4 },
+	{ "GetShotIdInRectA2", StgStageScript::Func_GetShotIdInAreaA2<StgIntersectionArea::AREA_RECT>, 5 },
+	{ "GetShotIdInRotatedRectA1", StgStageScript::Func_GetShotIdInAreaA1<StgIntersectionArea::AREA_ROTATED_RECT>, 5 },
+	{ "GetShotIdInRotatedRectA2", StgStageScript::Func_GetShotIdInAreaA2<StgIntersectionArea::AREA_ROTATED_RECT>, 6 },
+	{ "GetShotIdInLineA1", StgStageScript::Func_GetShotIdInAreaA1<StgIntersectionArea::AREA_LINE>, 5 },
+	{ "GetShotIdInLineA2", StgStageScript::Func_GetShotIdInAreaA2<StgIntersectionArea::AREA_LINE>, 6 },
+	{ "GetShotIdInSectorA1", StgStageScript::Func_GetShotIdInAreaA1<StgIntersectionArea::AREA_SECTOR>, 5 },
+	{ "GetShotIdInSectorA2", StgStageScript::Func_GetShotIdInAreaA2<StgIntersectionArea::AREA_SECTOR>, 6 },
 	{ "GetShotCount", StgStageScript::Func_GetShotCount, 1 },
 	{ "SetShotAutoDeleteClip", StgStageScript::Func_SetShotAutoDeleteClip, 4 },
 	{ "GetShotDataInfoA1", StgStageScript::Func_GetShotDataInfoA1, 3 },
 	{ "SetShotDeleteEventEnable", StgStageScript::Func_SetShotDeleteEventEnable, 2 },
+	{ "SetShotDeleteEventBatchEnable", StgStageScript::Func_SetShotDeleteEventBatchEnable, 1 },
 	{ "SetShotTextureFilter", StgStageScript::Func_SetShotTextureFilter, 2 },
+	{ "SetShotRenderInstancingEnable", StgStageScript::Func_SetShotRenderInstancingEnable, 1 },
 
 	//STG共通関数：アイテム
 	{ "CreateItemA1", StgStageScript::Func_CreateItemA1, 4 },
@@ -351,8 +365,17 @@ static const std::vector<function> stgStageFunction = {
 	{ "GetAllItemID", StgStageScript::Func_GetAllItemID, 0 },
 	{ "GetItemIdInCircleA1", StgStageScript::Func_GetItemIdInCircleA1, 3 },
 	{ "GetItemIdInCircleA2", StgStageScript::Func_GetItemIdInCircleA2, 4 },
+	{ "GetItemIdInRectA1", StgStageScript::Func_GetItemIdInAreaA1<StgIntersectionArea::AREA_RECT>, 4 },
+	{ "GetItemIdInRectA2", StgStageScript::Func_GetItemIdInAreaA2<StgIntersectionArea::AREA_RECT>, 5 },
+	{ "GetItemIdInRotatedRectA1", StgStageScript::Func_GetItemIdInAreaA1<StgIntersectionArea::AREA_ROTATED_RECT>, 5 },
+	{ "GetItemIdInRotatedRectA2", StgStageScript::Func_GetItemIdInAreaA2<StgIntersectionArea::AREA_ROTATED_RECT>, 6 },
+	{ "GetItemIdInLineA1", StgStageScript::Func_GetItemIdInAreaA1<StgIntersectionArea::AREA_LINE>, 5 },
+	{ "GetItemIdInLineA2", StgStageScript::Func_GetItemIdInAreaA2<StgIntersectionArea::AREA_LINE>, 6 },
+	{ "GetItemIdInSectorA1", StgStageScript::Func_GetItemIdInAreaA1<StgIntersectionArea::AREA_SECTOR>, 5 },
+	{ "GetItemIdInSectorA2", StgStageScript::Func_GetItemIdInAreaA2<StgIntersectionArea::AREA_SECTOR>, 6 },
 	{ "SetItemAutoDeleteClip", StgStageScript::Func_SetItemAutoDeleteClip, 4 },
 	{ "SetItemTextureFilter", StgStageScript::Func_SetItemTextureFilter, 2 },
+	{ "SetItemRenderInstancingEnable", StgStageScript::Func_SetItemRenderInstancingEnable, 1 },
 
 	//STG共通関数：その他
 	{ "StartSlow", StgStageScript::Func_StartSlow, 2 },
@@ -1478,6 +1501,25 @@ gstd::value StgStageScript::Func_ReloadEnemyShotData(gstd::script_machine* machi
 }
 
 //STG共通関数：弾
+StgIntersectionArea StgStageScript::_ScriptValueToArea(StgIntersectionArea::Type type, const gstd::value* argv) {
+	switch (type) {
+	case StgIntersectionArea::AREA_ROTATED_RECT:
+		//x, y, width, height, angle
+		return StgIntersectionArea::CreateRotatedRect(argv[0].as_float(), argv[1].as_float(),
+			argv[2].as_float(), argv[3].as_float(), argv[4].as_float());
+	case StgIntersectionArea::AREA_LINE:
+		//x1, y1, x2, y2, width
+		return StgIntersectionArea::CreateLine(argv[0].as_float(), argv[1].as_float(),
+			argv[2].as_float(), argv[3].as_float(), argv[4].as_float());
+	case StgIntersectionArea::AREA_SECTOR:
+		//x, y, radius, angle, spread
+		return StgIntersectionArea::CreateSector(argv[0].as_float(), argv[1].as_float(),
+			argv[2].as_float(), argv[3].as_float(), argv[4].as_float());
+	}
+	//left, top, right, bottom
+	return StgIntersectionArea::CreateRect(argv[0].as_float(), argv[1].as_float(),
+		argv[2].as_float(), argv[3].as_float());
+}
 gstd::value StgStageScript::Func_DeleteShotAll(gstd::script_machine* machine, int argc, const gstd::value* argv) {
 	StgStageScript* script = (StgStageScript*)machine->data;
 	StgStageController* stageController = script->stageController_;
@@ -1529,6 +1571,31 @@ gstd::value StgStageScript::Func_DeleteShotInCircle(gstd::script_machine* machin
 
 	return value();
 }
+template<StgIntersectionArea::Type AREA>
+gstd::value StgStageScript::Func_DeleteShotInArea(gstd::script_machine* machine, int argc, const gstd::value* argv) {
+	StgStageScript* script = (StgStageScript*)machine->data;
+	StgStageController* stageController = script->stageController_;
+
+	int typeDel = argv[0].as_int();
+	int typeTo = argv[1].as_int();
+	StgIntersectionArea area = _ScriptValueToArea(AREA, &argv[2]);
+
+	switch (typeDel) {
+	case TYPE_ALL:typeDel = StgShotManager::DEL_TYPE_ALL; break;
+	case TYPE_SHOT:typeDel = StgShotManager::DEL_TYPE_SHOT; break;
+	case TYPE_CHILD:typeDel = StgShotManager::DEL_TYPE_CHILD; break;
+	}
+
+	switch (typeTo) {
+	case TYPE_IMMEDIATE:typeTo = StgShotManager::TO_TYPE_IMMEDIATE; break;
+	case TYPE_FADE:typeTo = StgShotManager::TO_TYPE_FADE; break;
+	case TYPE_ITEM:typeTo = StgShotManager::TO_TYPE_ITEM; break;
+	}
+
+	stageController->GetShotManager()->DeleteInArea(typeDel, typeTo, StgShotObject::OWNER_ENEMY, area);
+
+	return value();
+}
 gstd::value StgStageScript::Func_CreateShotA1(gstd::script_machine* machine, int argc, const gstd::value* argv) {
 	StgStageScript* script = (StgStageScript*)machine->data;
 	StgStageController* stageController = script->stageController_;
@@ -2090,6 +2157,37 @@ gstd::value StgStageScript::Func_GetShotIdInCircleA2(gstd::script_machine* machi
 	std::vector<int> listID = shotManager->GetShotIdInCircle(typeOwner, px, py, radius);
 	return script->CreateIntArrayValue(listID);
 }
+template<StgIntersectionArea::Type AREA>
+gstd::value StgStageScript::Func_GetShotIdInAreaA1(gstd::script_machine* machine, int argc, const gstd::value* argv) {
+	StgStageScript* script = (StgStageScript*)machine->data;
+	StgStageController* stageController = script->stageController_;
+
+	StgShotManager* shotManager = stageController->GetShotManager();
+	StgIntersectionArea area = _ScriptValueToArea(AREA, argv);
+	int typeOwner = script->GetScriptType() == TYPE_PLAYER ? StgShotObject::OWNER_PLAYER : StgShotObject::OWNER_ENEMY;
+
+	std::vector<int> listID = shotManager->GetShotIdInArea(typeOwner, area);
+	return script->CreateIntArrayValue(listID);
+}
+template<StgIntersectionArea::Type AREA>
+gstd::value StgStageScript::Func_GetShotIdInAreaA2(gstd::script_machine* machine, int argc, const gstd::value* argv) {
+	StgStageScript* script = (StgStageScript*)machine->data;
+	StgStageController* stageController = script->stageController_;
+
+	StgShotManager* shotManager = stageController->GetShotManager();
+	StgIntersectionArea area = _ScriptValueToArea(AREA, argv);
+	int target = argv[argc - 1].as_int();
+
+	int typeOwner = StgShotObject::OWNER_NULL;
+	switch (target) {
+	case TARGET_ALL:typeOwner = StgShotObject::OWNER_NULL; break;
+	case TARGET_PLAYER:typeOwner = StgShotObject::OWNER_PLAYER; break;
+	case TARGET_ENEMY:typeOwner = StgShotObject::OWNER_ENEMY; break;
+	}
+
+	std::vector<int> listID = shotManager->GetShotIdInArea(typeOwner, area);
+	return script->CreateIntArrayValue(listID);
+}
 gstd::value StgStageScript::Func_GetShotCount(gstd::script_machine* machine, int argc, const gstd::value* argv) {
 	StgStageScript* script = (StgStageScript*)machine->data;
 	StgStageController* stageController = script->stageController_;
@@ -2224,6 +2322,17 @@ gstd::value StgStageScript::Func_SetShotDeleteEventEnable(gstd::script_machine*
 
 	return value();
 }
+gstd::value StgStageScript::Func_SetShotDeleteEventBatchEnable(gstd::script_machine* machine, int argc, const gstd::value* argv) {
+	StgStageScript* script = (StgStageScript*)machine->data;
+
+	bool bEnable = argv[0].as_boolean();
+
+	StgStageController* stageController = script->stageController_;
+	StgShotManager* shotManager = stageController->GetShotManager();
+	shotManager->SetDeleteEventBatchEnable(bEnable);
+
+	return value();
+}
 gstd::value StgStageScript::Func_SetShotTextureFilter(gstd::script_machine* machine, int argc, const gstd::value* argv) {
 	StgStageScript* script = (StgStageScript*)machine->data;
 	StgStageController* stageController = script->stageController_;
@@ -2236,6 +2345,15 @@ gstd::value StgStageScript::Func_SetShotTextureFilter(gstd::script_machine* mach
 
 	return value();
 }
+gstd::value StgStageScript::Func_SetShotRenderInstancingEnable(gstd::script_machine* machine, int argc, const gstd::value* argv) {
+	StgStageScript* script = (StgStageScript*)machine->data;
+	StgStageController* stageController = script->stageController_;
+	StgShotManager* shotManager = stageController->GetShotManager();
+
+	shotManager->SetRenderInstancingEnable(argv[0].as_boolean());
+
+	return value();
+}
 
 //STG共通関数：アイテム
 gstd::value StgStageScript::Func_CreateItemA1(gstd::script_machine* machine, int argc, const gstd::value* argv) {
@@ -2475,6 +2593,27 @@ gstd::value StgStageScript::Func_GetItemIdInCircleA2(gstd::script_machine* machi
 	std::vector<int> listID = itemManager->GetItemIdInCircle(px, py, radius, type);
 	return script->CreateIntArrayValue(listID);
 }
+template<StgIntersectionArea::Type AREA>
+gstd::value StgStageScript::Func_GetItemIdInAreaA1(gstd::script_machine* machine, int argc, const gstd::value* argv) {
+	StgStageScript* script = (StgStageScript*)machine->data;
+	StgItemManager* itemManager = script->stageController_->GetItemManager();
+
+	StgIntersectionArea area = _ScriptValueToArea(AREA, argv);
+
+	std::vector<int> listID = itemManager->GetItemIdInArea(area, {});
+	return script->CreateIntArrayValue(listID);
+}
+template<StgIntersectionArea::Type AREA>
+gstd::value StgStageScript::Func_GetItemIdInAreaA2(gstd::script_machine* machine, int argc, const gstd::value* argv) {
+	StgStageScript* script = (StgStageScript*)machine->data;
+	StgItemManager* itemManager = script->stageController_->GetItemManager();
+
+	StgIntersectionArea area = _ScriptValueToArea(AREA, argv);
+	int type = argv[argc - 1].as_int();
+
+	std::vector<int> listID = itemManager->GetItemIdInArea(area, type);
+	return script->CreateIntArrayValue(listID);
+}
 gstd::value StgStageScript::Func_SetItemAutoDeleteClip(gstd::script_machine* machine, int argc, const gstd::value* argv) {
 	StgStageScript* script = (StgStageScript*)machine->data;
 	StgStageController* stageController = script->stageController_;
@@ -2497,6 +2636,15 @@ gstd::value StgStageScript::Func_SetItemTextureFilter(gstd::script_machine* mach
 
 	return value();
 }
+gstd::value StgStageScript::Func_SetItemRenderInstancingEnable(gstd::script_machine* machine, int argc, const gstd::value* argv) {
+	StgStageScript* script = (StgStageScript*)machine->data;
+	StgStageController* stageController = script->stageController_;
+	StgItemManager* itemManager = stageController->GetItemManager();
+
+	itemManager->SetRenderInstancingEnable(argv[0].as_boolean());
+
+	return value();
+}
 
 //STG共通関数：その他
 gstd::value StgStageScript::Func_StartSlow(gstd::script_machine* machine, int argc, const gstd::value* argv) {
@@ -4878,30 +5026,27 @@ gstd::value StgStageScript::Func_ObjCrLaser_SetTipCapping(gstd::script_machine*
 gstd::value StgStageScript::Func_ObjCrLaser_GetNodePointer(gstd::script_machine* machine, int argc, const gstd::value* argv) {
 	StgStageScript* script = (StgStageScript*)machine->data;
 
-	StgCurveLaserObject::LaserNode* res = nullptr;
+	int64_t res = 0;
 
 	int id = argv[0].as_int();
 	StgCurveLaserObject* obj = script->GetObjectPointerAs<StgCurveLaserObject>(id);
 	if (obj) {
 		int index = argv[1].as_int();
-		if (index >= 0) {
-			std::list<StgCurveLaserObject::LaserNode>::iterator itr;
-			bool bValidIndex = obj->GetNode(index, itr);
-			res = bValidIndex ? &*itr : nullptr;
-		}
+		if (index >= 0)
+			res = obj->GetNodeHandle(index);
 	}
 
-	return script->CreateIntValue((int64_t)res);
+	return script->CreateIntValue(res);
 }
 gstd::value StgStageScript::Func_ObjCrLaser_GetNodePointerList(gstd::script_machine* machine, int argc, const gstd::value* argv) {
 	StgStageScript* script = (StgStageScript*)machine->data;
 
-	std::vector<StgCurveLaserObject::LaserNode*> res;
+	std::vector<int64_t> res;
 
 	int id = argv[0].as_int();
 	StgCurveLaserObject* obj = script->GetObjectPointerAs<StgCurveLaserObject>(id);
 	if (obj) {
-		obj->GetNodePointerList(&res);
+		obj->GetNodeHandleList(&res);
 	}
 
 	return script->CreateIntArrayValue(res);
@@ -4913,8 +5058,8 @@ gstd::value StgStageScript::Func_ObjCrLaser_GetNodePosition(gstd::script_machine
 	int id = argv[0].as_int();
 	StgCurveLaserObject* obj = script->GetObjectPointerAs<StgCurveLaserObject>(id);
 	if (obj) {
-		StgCurveLaserObject::LaserNode* ptr = (StgCurveLaserObject::LaserNode*)argv[1].as_int();
-		if (ptr && ptr->parent == obj) {
+		StgCurveLaserObject::LaserNode* ptr = obj->GetNodeFromHandle(argv[1].as_int());
+		if (ptr) {
 			res[0] = ptr->pos.x;
 			res[1] = ptr->pos.y;
 		}
@@ -4928,8 +5073,8 @@ gstd::value StgStageScript::Func_ObjCrLaser_GetNodeAngle(gstd::script_machine* m
 	int id = argv[0].as_int();
 	StgCurveLaserObject* obj = script->GetObjectPointerAs<StgCurveLaserObject>(id);
 	if (obj) {
-		StgCurveLaserObject::LaserNode* ptr = (StgCurveLaserObject::LaserNode*)argv[1].as_int();
-		if (ptr && ptr->parent == obj) {
+		StgCurveLaserObject::LaserNode* ptr = obj->GetNodeFromHandle(argv[1].as_int());
+		if (ptr) {
 			D3DXVECTOR2& vec = ptr->vertOff[0];
 			angle = Math::RadianToDegree(atan2(vec.y, vec.x)) + 90.0;
 		}
@@ -4943,8 +5088,8 @@ gstd::value StgStageScript::Func_ObjCrLaser_GetNodeWidthScale(gstd::script_machi
 	int id = argv[0].as_int();
 	StgCurveLaserObject* obj = script->GetObjectPointerAs<StgCurveLaserObject>(id);
 	if (obj) {
-		StgCurveLaserObject::LaserNode* ptr = (StgCurveLaserObject::LaserNode*)argv[1].as_int();
-		if (ptr && ptr->parent == obj) {
+		StgCurveLaserObject::LaserNode* ptr = obj->GetNodeFromHandle(argv[1].as_int());
+		if (ptr) {
 			width = ptr->widthMul;
 		}
 	}
@@ -4957,8 +5102,8 @@ gstd::value StgStageScript::Func_ObjCrLaser_GetNodeColor(gstd::script_machine* m
 	int id = argv[0].as_int();
 	StgCurveLaserObject* obj = script->GetObjectPointerAs<StgCurveLaserObject>(id);
 	if (obj) {
-		StgCurveLaserObject::LaserNode* ptr = (StgCurveLaserObject::LaserNode*)argv[1].as_int();
-		if (ptr && ptr->parent == obj) {
+		StgCurveLaserObject::LaserNode* ptr = obj->GetNodeFromHandle(argv[1].as_int());
+		if (ptr) {
 			color = ptr->color;
 		}
 	}
@@ -4974,8 +5119,8 @@ gstd::value StgStageScript::Func_ObjCrLaser_GetNodeColorHex(gstd::script_machine
 	int id = argv[0].as_int();
 	StgCurveLaserObject* obj = script->GetObjectPointerAs<StgCurveLaserObject>(id);
 	if (obj) {
-		StgCurveLaserObject::LaserNode* ptr = (StgCurveLaserObject::LaserNode*)argv[1].as_int();
-		if (ptr && ptr->parent == obj) {
+		StgCurveLaserObject::LaserNode* ptr = obj->GetNodeFromHandle(argv[1].as_int());
+		if (ptr) {
 			color = ptr->color;
 		}
 	}
@@ -4987,8 +5132,8 @@ gstd::value StgStageScript::Func_ObjCrLaser_SetNode(gstd::script_machine* machin
 	int id = argv[0].as_int();
 	StgCurveLaserObject* obj = script->GetObjectPointerAs<StgCurveLaserObject>(id);
 	if (obj) {
-		StgCurveLaserObject::LaserNode* ptr = (StgCurveLaserObject::LaserNode*)argv[1].as_int();
-		if (ptr && ptr->parent == obj) {
+		StgCurveLaserObject::LaserNode* ptr = obj->GetNodeFromHandle(argv[1].as_int());
+		if (ptr) {
 			float x = argv[2].as_float();
 			float y = argv[3].as_float();
 			float angle = Math::DegreeToRadian(argv[4].as_float());
@@ -5009,8 +5154,8 @@ gstd::value StgStageScript::Func_ObjCrLaser_SetNodePosition(gstd::script_machine
 	int id = argv[0].as_int();
 	StgCurveLaserObject* obj = script->GetObjectPointerAs<StgCurveLaserObject>(id);
 	if (obj) {
-		StgCurveLaserObject::LaserNode* ptr = (StgCurveLaserObject::LaserNode*)argv[1].as_int();
-		if (ptr && ptr->parent == obj) {
+		StgCurveLaserObject::LaserNode* ptr = obj->GetNodeFromHandle(argv[1].as_int());
+		if (ptr) {
 			float x = argv[2].as_float();
 			float y = argv[3].as_float();
 			ptr->pos = D3DXVECTOR2(x, y);
@@ -5023,8 +5168,8 @@ gstd::value StgStageScript::Func_ObjCrLaser_SetNodeAngle(gstd::script_machine* m
 	int id = argv[0].as_int();
 	StgCurveLaserObject* obj = script->GetObjectPointerAs<StgCurveLaserObject>(id);
 	if (obj) {
-		StgCurveLaserObject::LaserNode* ptr = (StgCurveLaserObject::LaserNode*)argv[1].as_int();
-		if (ptr && ptr->parent == obj) {
+		StgCurveLaserObject::LaserNode* ptr = obj->GetNodeFromHandle(argv[1].as_int());
+		if (ptr) {
 			float angle = Math::DegreeToRadian(argv[2].as_float());
 			D3DXVECTOR2 rMove = D3DXVECTOR2(-sinf(angle), cosf(angle));
 
@@ -5039,8 +5184,8 @@ gstd::value StgStageScript::Func_ObjCrLaser_SetNodeWidthScale(gstd::script_machi
 	int id = argv[0].as_int();
 	StgCurveLaserObject* obj = script->GetObjectPointerAs<StgCurveLaserObject>(id);
 	if (obj) {
-		StgCurveLaserObject::LaserNode* ptr = (StgCurveLaserObject::LaserNode*)argv[1].as_int();
-		if (ptr && ptr->parent == obj) {
+		StgCurveLaserObject::LaserNode* ptr = obj->GetNodeFromHandle(argv[1].as_int());
+		if (ptr) {
 			float width = argv[2].as_float();
 			ptr->widthMul = width;
 		}
@@ -5052,8 +5197,8 @@ gstd::value StgStageScript::Func_ObjCrLaser_SetNodeColor(gstd::script_machine* m
 	int id = argv[0].as_int();
 	StgCurveLaserObject* obj = script->GetObjectPointerAs<StgCurveLaserObject>(id);
 	if (obj) {
-		StgCurveLaserObject::LaserNode* ptr = (StgCurveLaserObject::LaserNode*)argv[1].as_int();
-		if (ptr && ptr->parent == obj) {
+		StgCurveLaserObject::LaserNode* ptr = obj->GetNodeFromHandle(argv[1].as_int());
+		if (ptr) {
 			D3DCOLOR color = argv[2].as_int();
 			ptr->color = color;
 		}
@@ -59,6 +59,7 @@ public:
 
 	int GetPlayerObjectID() { return idObjPlayer_; }
 	ref_unsync_ptr<StgPlayerObject> GetPlayerObject() { return ptrObjPlayer_; }
+	StgPlayerObject* GetPlayerObjectPointer() { return ptrObjPlayer_.get(); }
 	int CreatePlayerObject();
 };
 
@@ -258,8 +259,11 @@ public:
 	static gstd::value Func_ReloadEnemyShotData(gstd::script_machine* machine, int argc, const gstd::value* argv);
 
 	//STG共通関数：弾
+	static StgIntersectionArea _ScriptValueToArea(StgIntersectionArea::Type type, const gstd::value* argv);
 	static gstd::value Func_DeleteShotAll(gstd::script_machine* machine, int argc, const gstd::value* argv);
 	static gstd::value Func_DeleteShotInCircle(gstd::script_machine* machine, int argc, const gstd::value* argv);
+	template<StgIntersectionArea::Type AREA>
+	static gstd::value Func_DeleteShotInArea(gstd::script_machine* machine, int argc, const gstd::value* argv);
 	static gstd::value Func_CreateShotA1(gstd::script_machine* machine, int argc, const gstd::value* argv);
 	static gstd::value Func_CreateShotA2(gstd::script_machine* machine, int argc, const gstd::value* argv);
 	static gstd::value Func_CreateShotOA1(gstd::script_machine* machine, int argc, const gstd::value* argv);
@@ -277,11 +281,17 @@ public:
 	DNH_FUNCAPI_DECL_(Func_GetAllShotID);
 	static gstd::value Func_GetShotIdInCircleA1(gstd::script_machine* machine, int argc, const gstd::value* argv);
 	static gstd::value Func_GetShotIdInCircleA2(gstd::script_machine* machine, int argc, const gstd::value* argv);
+	template<StgIntersectionArea::Type AREA>
+	static gstd::value Func_GetShotIdInAreaA1(gstd::script_machine* machine, int argc, const gstd::value* argv);
+	template<StgIntersectionArea::Type AREA>
+	static gstd::value Func_GetShotIdInAreaA2(gstd::script_machine* machine, int argc, const gstd::value* argv);
 	static gstd::value Func_GetShotCount(gstd::script_machine* machine, int argc, const gstd::value* argv);
 	static gstd::value Func_SetShotAutoDeleteClip(gstd::script_machine* machine, int argc, const gstd::value* argv);
 	static gstd::value Func_GetShotDataInfoA1(gstd::script_machine* machine, int argc, const gstd::value* argv);
 	DNH_FUNCAPI_DECL_(Func_SetShotDeleteEventEnable);
+	DNH_FUNCAPI_DECL_(Func_SetShotDeleteEventBatchEnable);
 	DNH_FUNCAPI_DECL_(Func_SetShotTextureFilter);
+	DNH_FUNCAPI_DECL_(Func_SetShotRenderInstancingEnable);
 
 	//STG共通関数：アイテム
 	static gstd::value Func_CreateItemA1(gstd::script_machine* machine, int argc, const gstd::value* argv);
@@ -299,8 +309,13 @@ public:
 	DNH_FUNCAPI_DECL_(Func_GetAllItemID);
 	DNH_FUNCAPI_DECL_(Func_GetItemIdInCircleA1);
 	DNH_FUNCAPI_DECL_(Func_GetItemIdInCircleA2);
+	template<StgIntersectionArea::Type AREA>
+	DNH_FUNCAPI_DECL_(Func_GetItemIdInAreaA1);
+	template<StgIntersectionArea::Type AREA>
+	DNH_FUNCAPI_DECL_(Func_GetItemIdInAreaA2);
 	DNH_FUNCAPI_DECL_(Func_SetItemAutoDeleteClip);
 	DNH_FUNCAPI_DECL_(Func_SetItemTextureFilter);
+	DNH_FUNCAPI_DECL_(Func_SetItemRenderInstancingEnable);
 
 	//STG共通関数：その他
 	static gstd::value Func_StartSlow(gstd::script_machine* machine, int argc, const gstd::value* argv);
@@ -282,16 +282,24 @@ void StgSystemController::RenderScriptObject(int priMin, int priMax) {
 
 	bool bValidStage = (scene == StgSystemInformation::SCENE_STG || !infoSystem_->IsPackageMode()) &&
 		stageController_ != nullptr && !bPause;
+
+	//Time spent building the render queues, shown in the info panel
+	auto timeQueueStart = SystemUtility::GetCpuTime();
+	size_t countQueueObject = 0;
+
 	if (bValidStage) {
 		objManagerStage = stageController_->GetMainObjectManager();
 		objManagerStage->PrepareRenderObject();
 		pRenderListStage = objManagerStage->GetRenderObjectListPointer();
+		countQueueObject += objManagerStage->GetAliveObjectCount();
 	}
 	if (infoSystem_->IsPackageMode()) {
 		objManagerPackage = packageController_->GetMainObjectManager();
 		objManagerPackage->PrepareRenderObject();
 		pRenderListPackage = objManagerPackage->GetRenderObjectListPointer();
+		countQueueObject += objManagerPackage->GetAliveObjectCount();
 	}
+	auto durationQueue = SystemUtility::GetCpuTime() - timeQueueStart;
 
 	DirectGraphics* graphics = DirectGraphics::GetBase();
 	auto& camera3D = graphics->GetCamera();
@@ -377,9 +385,24 @@ void StgSystemController::RenderScriptObject(int priMin, int priMax) {
 	bool bRunMinStgFrame = false;
 	bool bRunMaxStgFrame = false;
 
+	size_t countCullVisible = 0;
+	size_t countCulled = 0;
 	if (bValidStage) {
-		stageController_->GetItemManager()->LoadRenderQueue();
-		stageController_->GetShotManager()->LoadRenderQueue();
+		StgItemManager* itemManager = stageController_->GetItemManager();
+		StgShotManager* shotManager = stageController_->GetShotManager();
+
+		timeQueueStart = SystemUtility::GetCpuTime();
+		itemManager->LoadRenderQueue();
+		shotManager->LoadRenderQueue();
+		durationQueue += SystemUtility::GetCpuTime() - timeQueueStart;
+
+		countCullVisible = itemManager->GetRenderVisibleCount() + shotManager->GetRenderVisibleCount();
+		countCulled = itemManager->GetRenderCulledCount() + shotManager->GetRenderCulledCount();
+	}
+	if (auto infoLog = ELogger::GetInstance()->GetInfoPanel()) {
+		double timeQueue = stdch::duration_cast<stdch::microseconds>(durationQueue).count() / 1000.0;
+		infoLog->SetInfo(12, "Render queue", StringUtility::Format("Objects=%d, Build=%.3fms, Shots+Items=%u (culled %u)", 
+			countQueueObject, timeQueue, countCullVisible, countCulled));
 	}
 
 	for (int iPri = priMin; iPri <= priMax; iPri++) {
@@ -54,12 +54,20 @@ bool EApplication::_Initialize() {
 
 	ETextureManager* textureManager = ETextureManager::CreateInstance();
 	textureManager->Initialize();
+#ifdef _DEBUG
+	{
+		std::wstring err;
+		if (!RectPacker::SelfCheck(&err))
+			Logger::WriteTop(L"Self-check failed: " + err);
+	}
+#endif
 
 	EShaderManager* shaderManager = EShaderManager::CreateInstance();
 	shaderManager->Initialize();
 
 	EMeshManager* meshManager = EMeshManager::CreateInstance();
 	meshManager->Initialize();
+	meshManager->SetCacheDirectory(EPathProperty::GetCacheDirectory() + L"mesh/");
 
 	EDxTextRenderer* textRenderer = EDxTextRenderer::CreateInstance();
 	textRenderer->Initialize();
@@ -223,6 +231,21 @@ bool EApplication::_Loop() {
 
 					infoLog->SetInfo(2, "Font cache",
 						std::to_string(EDxTextRenderer::GetInstance()->GetCacheCount()));
+
+					{
+						const RenderRecorder::FrameCount& countRender = graphics->GetRecorder()->GetLastFrameCount();
+						std::string renderInfo = StringUtility::Format("Draw=%d, Prim=%d, Vert=%d, State=%d (skipped %d)",
+							countRender.countDraw, countRender.countPrimitive,
+							countRender.countVertex, countRender.countStateChange, countRender.countStateSkip);
+						infoLog->SetInfo(3, "Draw calls", renderInfo);
+
+						std::string matrixInfo = StringUtility::Format("Build=%d, Cached=%d",
+							countRender.countWorldMatrixBuild, countRender.countWorldMatrixCached);
+						infoLog->SetInfo(13, "World matrix", matrixInfo);
+
+						infoLog->SetInfo(14, "Shader params", StringUtility::Format("Lookups saved=%d",
+							countRender.countParamLookupSaved));
+					}
 				}
 			}
 
@@ -275,7 +298,7 @@ void EApplication::_RenderDisplay() {
 			device->SetFVF(VERTEX_TLX::fvf);
 
 			std::array<VERTEX_TLX, 4> verts;
-			auto _Render = [](IDirect3DDevice9* device, VERTEX_TLX* verts, const D3DXMATRIX* mat) {
+			auto _Render = [graphics](IDirect3DDevice9* device, VERTEX_TLX* verts, const D3DXMATRIX* mat) {
 				constexpr float bias = -0.5f;
 				for (size_t iVert = 0; iVert < 4; ++iVert) {
 					VERTEX_TLX* vertex = (VERTEX_TLX*)verts + iVert;
@@ -287,7 +310,7 @@ void EApplication::_RenderDisplay() {
 
 					D3DXVec3TransformCoord((D3DXVECTOR3*)vPos, (D3DXVECTOR3*)vPos, mat);
 				}
-				device->DrawPrimitiveUP(D3DPT_TRIANGLESTRIP, 2, (void*)verts, sizeof(VERTEX_TLX));
+				graphics->DrawPrimitiveUP(D3DPT_TRIANGLESTRIP, 2, (void*)verts, sizeof(VERTEX_TLX));
 			};
 
 			{
@@ -306,7 +329,7 @@ void EApplication::_RenderDisplay() {
 					D3DXVECTOR2(1, 1));
 
 				device->SetTexture(0, secondaryBackBuffer_->GetD3DTexture());
-				device->DrawPrimitiveUP(D3DPT_TRIANGLESTRIP, 2, (void*)verts.data(), sizeof(VERTEX_TLX));
+				graphics->DrawPrimitiveUP(D3DPT_TRIANGLESTRIP, 2, (void*)verts.data(), sizeof(VERTEX_TLX));
 			}
 			{
 				//Render the main scene
@@ -363,16 +386,17 @@ void EApplication::_RenderDisplay() {
 						ShaderManager::GetBase()->GetRenderLib()->GetVertexDeclarationTLX());
 
 					ID3DXEffect* effect = shader->GetEffect();
+					const ShaderSemanticTable* semantic = shader->GetSemanticTable();
 					if (effect) {
 						if (shader->LoadTechnique()) {
 							shader->LoadParameter();
 
 							D3DXHANDLE handle = nullptr;
-							if (handle = effect->GetParameterBySemantic(nullptr, "WORLD"))
+							if (handle = semantic->Get(ShaderSemanticTable::WORLD))
 								effect->SetMatrix(handle, &matDisplayTransform);
-							if (handle = effect->GetParameterBySemantic(nullptr, "VIEWPROJECTION"))
+							if (handle = semantic->Get(ShaderSemanticTable::VIEWPROJECTION))
 								effect->SetMatrix(handle, &graphics->GetViewPortMatrix());
-							if (handle = effect->GetParameterBySemantic(nullptr, "TEXTURE"))
+							if (handle = semantic->Get(ShaderSemanticTable::TEXTURE))
 								effect->SetTexture(handle, mainSceneTexture->GetD3DTexture());
 						}
 
@@ -380,7 +404,7 @@ void EApplication::_RenderDisplay() {
 						effect->Begin(&countPass, 0);
 						for (UINT iPass = 0; iPass < countPass; ++iPass) {
 							effect->BeginPass(iPass);
-							device->DrawPrimitive(D3DPT_TRIANGLESTRIP, 0, 2);
+							graphics->DrawPrimitive(D3DPT_TRIANGLESTRIP, 0, 2);
 							effect->EndPass();
 						}
 						effect->End();
@@ -392,7 +416,7 @@ void EApplication::_RenderDisplay() {
 						D3DXVec3TransformCoord((D3DXVECTOR3*)vPos, (D3DXVECTOR3*)vPos, &matDisplayTransform);
 					}
 
-					device->DrawPrimitiveUP(D3DPT_TRIANGLESTRIP, 2, (void*)verts.data(), sizeof(VERTEX_TLX));
+					graphics->DrawPrimitiveUP(D3DPT_TRIANGLESTRIP, 2, (void*)verts.data(), sizeof(VERTEX_TLX));
 				}
 			}
 		}
@@ -467,6 +491,8 @@ bool EDirectGraphics::Initialize(const std::wstring& windowTitle) {
 	dxConfig.colorMode = dnhConfig->modeColor_;
 	dxConfig.bVSync = dnhConfig->bVSync_;
 	dxConfig.bUseRef = dnhConfig->bUseRef_;
+	dxConfig.bUseNullDevice = dnhConfig->bUseNullDevice_;
+	dxConfig.pathRenderTrace = dnhConfig->pathRenderTrace_;
 	dxConfig.typeMultiSample = dnhConfig->multiSamples_;
 	dxConfig.bBorderlessFullscreen = dnhConfig->bPseudoFullscreen_;
 
@@ -2,6 +2,35 @@
 
 #include "GcLibImpl.hpp"
 
+//*******************************************************************
+//Tool commands
+//	th_dnh.exe -benchdecode <dir>	Times the texture decode of every image in dir
+//	th_dnh.exe -convertmqo <path>	Writes a prebuilt .mqc next to every .mqo under path
+//	th_dnh.exe -benchmqo <path>		Times the .mqo parse against the .mqc load
+//*******************************************************************
+static bool RunToolCommand() {
+	int argc = 0;
+	LPWSTR* argv = ::CommandLineToArgvW(::GetCommandLineW(), &argc);
+	if (argv == nullptr) return false;
+
+	std::vector<std::wstring> listArg(argv + 1, argv + argc);
+	::LocalFree(argv);
+	if (listArg.size() < 2) return false;
+
+	std::wstring res;
+	if (listArg[0] == L"-benchdecode")
+		res = directx::TextureDecoder::BenchmarkDirectory(listArg[1]);
+	else if (listArg[0] == L"-convertmqo")
+		res = directx::MetasequoiaMeshData::ConvertPath(listArg[1]);
+	else if (listArg[0] == L"-benchmqo")
+		res = directx::MetasequoiaMeshData::BenchmarkPath(listArg[1]);
+	else
+		return false;
+
+	MessageBox(nullptr, res.c_str(), listArg[0].c_str(), MB_ICONINFORMATION | MB_OK);
+	return true;
+}
+
 //*******************************************************************
 //WinMain
 //*******************************************************************
@@ -12,6 +41,11 @@ int APIENTRY wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmd
 		gstd::SystemUtility::InitializeCOM();
 		gstd::SystemUtility::TestCpuSupportSIMD();
 
+		if (RunToolCommand()) {
+			gstd::SystemUtility::UninitializeCOM();
+			return 0;
+		}
+
 		directx::EDirect3D9::CreateInstance();
 		DnhConfiguration* config = DnhConfiguration::CreateInstance();
 